@@ -0,0 +1,3 @@
+#include "main.hpp"
+
+bool autonomousLoad();
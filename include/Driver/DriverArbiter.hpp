@@ -0,0 +1,71 @@
+#ifndef _DRIVER_ARBITER_HPP_
+#define _DRIVER_ARBITER_HPP_
+
+#include <cstdint>
+#include "DriverCompensation.hpp"
+
+// One place that decides what each motor gets. The driver, the vision assists, autonomous and safety each
+// submit commands, and each command runs out after a timeout so a task that stops doesn't leave a motor running.
+// Per motor, going from the lowest priority source up, a normal command replaces what's below it and an
+// additive one (like the assist biases) gets added on. The result goes out once a tick, and only if it's
+// different from what the motor already has. Pure logic, so the simulator runs it too.
+
+#define ARBITER_TIMEOUT 50 // ms a command lasts if it isn't sent again
+#define ARBITER_REFRESH 500 // ms after which an unchanged command is written again anyway, in case one went missing
+
+enum ArbiterSource // Lowest priority first
+{
+  SOURCE_DRIVER,
+  SOURCE_ASSIST,
+  SOURCE_AUTONOMOUS,
+  SOURCE_SAFETY,
+  SOURCE_COUNT
+};
+
+enum ArbiterMotor
+{
+  MOTOR_BASE_LEFT,
+  MOTOR_BASE_RIGHT,
+  MOTOR_BASE_H,
+  MOTOR_ARM,
+  MOTOR_COUNT
+};
+
+enum ArbiterMode
+{
+  MODE_POWER, // Motor::move, -127 to 127
+  MODE_VELOCITY // Motor::move_velocity, rpm
+};
+
+struct ArbiterCommand
+{
+  bool active;
+  bool additive;
+  ArbiterMode mode;
+  float value;
+  uint32_t expires; // millis()
+};
+
+struct ArbiterOutput
+{
+  bool written; // False until the first write
+  ArbiterMode mode;
+  int32_t value;
+  uint32_t lastWrite;
+  float share[SOURCE_COUNT]; // How much of this tick's command each source made up, all 0 with nothing active. For DriverEnergy
+};
+
+struct Arbiter
+{
+  ArbiterCommand commands[MOTOR_COUNT][SOURCE_COUNT];
+  ArbiterOutput outputs[MOTOR_COUNT];
+  MotorCompensation* compensation[MOTOR_COUNT]; // Applied to the final power when set
+  uint32_t writes;
+  uint32_t skipped;
+};
+
+void arbiterSubmit(Arbiter& arbiter, ArbiterMotor motor, ArbiterSource source, ArbiterMode mode, float value, bool additive, uint32_t now, uint32_t timeout);
+void arbiterRelease(Arbiter& arbiter, ArbiterMotor motor, ArbiterSource source);
+bool arbiterResolve(Arbiter& arbiter, ArbiterMotor motor, uint32_t now, ArbiterMode* mode, int32_t* value);
+
+#endif // _DRIVER_ARBITER_HPP_
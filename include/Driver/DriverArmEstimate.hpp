@@ -0,0 +1,31 @@
+#ifndef _DRIVER_ARM_ESTIMATE_HPP_
+#define _DRIVER_ARM_ESTIMATE_HPP_
+
+// Where the arm is, from the pot and the motor 3 encoder together. The pot knows the real angle but is
+// noisy, the encoder is smooth and quick but only counts from where it started and slops around in the
+// gear backlash. Each loop the encoder moves the estimate and the pot slowly pulls it back to the truth.
+// Pure maths, so the simulator runs it too.
+
+#define ARM_POT_PORT 'A' // ADI port of the arm pot
+#define potRange 3036 //The pot value of the range of the arm
+#define potAngle 270 //The angle value of the range of the arm
+#define potOffset 0 //The offset for a certain pot value to be zero degrees. The pot is calibrated with the arm down, so that's 0
+#define ARM_GEAR_RATIO 1.0 // Motor 3 turns per arm turn
+
+#define ARM_POT_SAMPLES 10 // Pot reads averaged for each estimate, one a millisecond, so a control tick's worth
+#define ARM_RADIANS_PER_POT_COUNT (potAngle * M_PI / 180 / potRange)
+#define ARM_RADIANS_PER_MOTOR_DEGREE (M_PI / 180 / ARM_GEAR_RATIO)
+#define ARM_POT_BLEND 0.2 // How far each pot reading pulls the angle, per 10ms. Lower is smoother but slower to fix encoder slop
+#define ARM_VELOCITY_BLEND 0.3 // How far each encoder step pulls the velocity, per 10ms
+
+struct ArmEstimate
+{
+  bool valid;
+  float angle; // Radians up from the bottom hard stop
+  float velocity; // Radians/s
+  float lastEncoder; // Radians of arm the encoder had counted last loop
+};
+
+void armEstimateUpdate(ArmEstimate& estimate, float potRadians, float encoderRadians, float dt);
+
+#endif // _DRIVER_ARM_ESTIMATE_HPP_
@@ -0,0 +1,41 @@
+#ifndef _DRIVER_ARM_MASK_HPP_
+#define _DRIVER_ARM_MASK_HPP_
+
+#include "DriverGeometry.hpp"
+
+// Our own claw, and the ball in it, go through the camera's view as the arm comes up, and a held ball is the
+// biggest ball the sensor can see. Where the claw lands in the image only depends on the arm angle and the
+// camera, so a table of image boxes by arm angle is worked out once per camera model. Each frame the sensor's
+// few biggest ball detections are read in one go, and the biggest one outside the box for the current arm angle
+// is the ball. Pure maths, so the simulator runs it too.
+
+#define ARM_PIVOT_FORWARD 4.0 // Inches in front of the robot center
+#define ARM_MASK_RANGE (270 * M_PI / 180) // Radians, hard stop to hard stop, same as potAngle
+#define ARM_MASK_STEPS 64 // Boxes in the table
+#define ARM_MASK_SIZE BALL_DIAMETER // Inches, a detection with its middle within half this of where the held ball should be is ours
+#define ARM_MASK_MARGIN 6 // Pixels round the projected claw
+#define ARM_MASK_SLACK 0.08 // Radians either side of the arm angle, for the frame being a little older than it
+#define ARM_MASK_OBJECTS 4 // Ball detections read each frame, biggest first
+
+struct ArmMaskBox // Image pixels
+{
+  bool visible;
+  float left;
+  float top;
+  float right;
+  float bottom;
+};
+
+struct ArmMask
+{
+  CameraModel camera; // What the table was worked out for
+  ArmMaskBox boxes[ARM_MASK_STEPS]; // Arm angles 0 to ARM_MASK_RANGE, evenly spaced
+};
+
+void armMaskBuild(ArmMask& mask, const CameraModel& camera);
+bool armMaskCurrent(const ArmMask& mask, const CameraModel& camera);
+ArmMaskBox armMaskAt(const ArmMask& mask, float armAngle);
+bool armMaskCovers(const ArmMaskBox& box, const pros::c::vision_object_s_t& object);
+int armMaskPick(const ArmMask& mask, float armAngle, const pros::c::vision_object_s_t* objects, int count);
+
+#endif // _DRIVER_ARM_MASK_HPP_
@@ -1,3 +1,6 @@
 #include "main.hpp"
 
+float armAngle();
+float armVelocity();
 void armP(void*);
+void armPotTask(void*);
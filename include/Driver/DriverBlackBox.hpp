@@ -0,0 +1,18 @@
+#include "main.hpp"
+
+enum BlackBoxSource // flags on RECORD_CONTROL and RECORD_LATE entries
+{
+  BLACKBOX_MOTORS,
+  BLACKBOX_BASE,
+  BLACKBOX_ARM,
+  BLACKBOX_ODOMETRY,
+  BLACKBOX_AUTONOMOUS
+};
+
+void blackBoxVision(const c::vision_object_s_t& object, int32_t objectCount);
+void blackBoxControl(BlackBoxSource who, float a, float b, float c);
+void blackBoxMotor(uint8_t motor, int32_t command, float rpm, int32_t milliamps, float watts, uint32_t faults);
+void blackBoxDeadline(BlackBoxSource task, uint32_t wake, uint32_t period);
+bool blackBoxTrigger();
+uint32_t blackBoxDumps();
+void blackBoxTask(void*);
@@ -0,0 +1,7 @@
+#include "main.hpp"
+#include "DriverCameraFit.hpp"
+
+bool cameraModelLoad();
+bool cameraModelSave();
+void cameraCalibrationTask(void*);
+bool cameraCalibrationStart();
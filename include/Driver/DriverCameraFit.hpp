@@ -0,0 +1,29 @@
+#ifndef _DRIVER_CAMERA_FIT_HPP_
+#define _DRIVER_CAMERA_FIT_HPP_
+
+#include "DriverGeometry.hpp"
+
+// Works out how the vision sensor is really mounted. The robot looks at a ball in a known spot from a set of
+// distances and headings (the stations), and the camera model is adjusted until fieldToImage predicts what the
+// sensor actually saw at every one, by least squares. Pure maths, so the simulator runs it too.
+
+#define CALIBRATION_BALL_DISTANCE 48.0 // Inches in front of the robot centre the ball goes before starting
+#define CALIBRATION_WIDTH_WEIGHT 2.0 // A pixel of width error counts as much as this many pixels of position
+#define CALIBRATION_ITERATIONS 30
+#define CALIBRATION_PARAMETERS 6 // focalLength, mountForward, mountLeft, mountYaw, mountHeight, mountPitch
+
+struct CalibrationSample
+{
+  RobotPose pose; // From odometry
+  float ballX; // Where the ball is on the field
+  float ballY;
+  float imageX; // What the sensor saw, averaged over a few frames
+  float imageY;
+  float width;
+};
+
+int calibrationStationCount();
+RobotPose calibrationStation(int station);
+bool calibrationFit(CameraModel& camera, const CalibrationSample* samples, int count, float* rmsBefore, float* rmsAfter);
+
+#endif // _DRIVER_CAMERA_FIT_HPP_
@@ -0,0 +1,44 @@
+#ifndef _DRIVER_COMPENSATION_HPP_
+#define _DRIVER_COMPENSATION_HPP_
+
+// Makes small commands actually move things. Each motor learns two numbers as it runs:
+//  deadband - the power it takes to get the motor turning at all
+//  backlash - how far the motor turns before the thing on the other side of the gears does,
+//             worked out from how far the encoder and an absolute sensor (the arm pot) disagree
+//             when going up compared to going down
+// Commands get the deadband added on, and when the direction changes they get kicked through the backlash.
+// A motor that's stopped can be made to wait for a slightly bigger command before starting again (holdPower).
+// Pure maths, so the simulator runs it too.
+
+#define COMPENSATION_MIN_POWER 2 // Anything smaller is treated as the stick resting at 0, so we don't creep
+#define COMPENSATION_HOLD_POWER 3 // What the base takes to start again once it's stopped, see holdPower
+#define COMPENSATION_MAX_DEADBAND 30 // Never learn a deadband bigger than this
+#define COMPENSATION_LEARN_POWER 40 // Stalling at more power than this is a wall or a hard stop, not the deadband
+#define COMPENSATION_STALL_SPEED 0.05 // Output units/s (radians for the arm) slower than this is stalled
+#define COMPENSATION_STALL_TICKS 5 // Loops stalled before the deadband is raised
+#define COMPENSATION_DEADBAND_STEP 1.0 // Power the deadband goes up each time it stalls
+#define COMPENSATION_DEADBAND_LEAK 0.02 // Power the deadband comes down each loop it moves at a small command
+#define COMPENSATION_BACKLASH_BLEND 0.02 // How far each moving loop pulls the learned up/down sensor offsets
+#define COMPENSATION_BACKLASH_SPEED 0.3 // Output units/s we have to be moving at to learn the backlash
+#define COMPENSATION_KICK_POWER 40 // Least power used to cross the backlash after a direction change
+
+struct MotorCompensation
+{
+  float deadband; // Power
+  float backlash; // Output units the motor turns freely on a direction change
+  float slop; // Where the motor is in the backlash, -backlash/2 (last pushed down) to backlash/2 (last pushed up)
+  float upOffset; // Encoder minus absolute sensor, while going up
+  float downOffset; // And going down
+  bool upSeen;
+  bool downSeen;
+  int stalledTicks;
+  float lastCommand;
+  float holdPower; // Once stopped, commands smaller than this stay 0. For the base, where pixel noise around a centred
+                   // ball would otherwise get every tiny correction boosted past the deadband, and hunt. 0 is COMPENSATION_MIN_POWER
+};
+
+float compensationCommand(const MotorCompensation& compensation, float power);
+float compensationObserve(MotorCompensation& compensation, float encoderStep, float dt);
+void compensationLearnBacklash(MotorCompensation& compensation, float encoder, float absolute, float speed);
+
+#endif // _DRIVER_COMPENSATION_HPP_
@@ -0,0 +1,35 @@
+#ifndef _DRIVER_CONTACT_HPP_
+#define _DRIVER_CONTACT_HPP_
+
+#include "DriverControlLaws.hpp"
+#include <cstdint>
+
+// Time to contact ("tau") from how fast the ball's box is growing. Closing at a steady speed, width / (rate of
+// change of width) is the time until we'd hit it, and it needs no calibration at all: no focal length, no ball
+// size, no mounting. The rate is a Theil-Sen fit (median of the slopes between pairs of frames) of log
+// width over the last few frames, so a bad frame or two doesn't throw it. The y position gets the same fit, which
+// the contact scenario uses to try the arm aiming where the ball will be. Pure maths, so the simulator runs it too.
+
+#define CONTACT_WINDOW 12 // Frames in the fit, 240ms at 50Hz
+#define CONTACT_MIN_FRAMES 4 // Frames needed before there's an estimate
+#define CONTACT_MAX_GAP 100 // ms without a frame before the history is thrown out
+#define CONTACT_BRAKE_TIME 0.35 // Seconds out from the grab width that the forward assist starts easing off. Default for ControlGains
+
+struct ContactEstimate
+{
+  float logWidth[CONTACT_WINDOW]; // Ring of the last few frames
+  float y[CONTACT_WINDOW];
+  uint32_t time[CONTACT_WINDOW]; // ms
+  int count;
+  int next;
+  float expansion; // 1/s, rate of change of log width, which is 1/tau. Positive is closing
+  float yRate; // Pixels/s
+};
+
+void contactReset(ContactEstimate& estimate);
+void contactUpdate(ContactEstimate& estimate, float width, float yMiddle, uint32_t now);
+bool contactValid(const ContactEstimate& estimate, uint32_t now);
+float contactTimeTo(const ContactEstimate& estimate, float width, float targetWidth);
+float contactBrake(const ContactEstimate& estimate, uint32_t now, float width, float targetWidth, float maxPower, const ControlGains& gains);
+
+#endif // _DRIVER_CONTACT_HPP_
@@ -0,0 +1,45 @@
+#ifndef _DRIVER_CONTROL_LAWS_HPP_
+#define _DRIVER_CONTROL_LAWS_HPP_
+
+#include "pros/vision.h"
+#include "DriverPid.hpp"
+
+// The maths of the vision assist, split from the tasks that read the sensors and drive the motors,
+// so the simulator runs exactly the same controllers. The Batch versions run a whole array of robots
+// in one loop, where seen is 1 for a robot that has the ball and 0 for one that doesn't. They take the gains
+// rather than using controlGains, so the parameter tuner can run a different set in every batch.
+
+#define BASE_P 0.6 // The Kp for X error / base power
+#define BASE_DISTANCE_WIDTH 40 // Ball width (px) when it's close enough to grab
+#define ARM_P 1.3
+
+// The forward assist runs as a DriverPid on the ball width, P is controlGains.forwardP (see forwardPidGains)
+#define BASE_FORWARD_I 3 // Gets it the last few pixels the deadband would otherwise leave
+#define BASE_FORWARD_D 0.1
+#define BASE_FORWARD_D_FILTER 0.1 // Seconds, default for ControlGains
+#define BASE_FORWARD_ANTI_WINDUP 10 // 1/s
+
+struct ControlGains // What can be changed at runtime, from a parameter file (see DriverParams). Defaults in the comments
+{
+  float turnP; // BASE_P
+  float forwardP; // BASE_P * 5
+  float armP; // ARM_P
+  float forwardDFilter; // BASE_FORWARD_D_FILTER
+  float targetCoastTime; // TARGET_COAST_TIME, ms
+  float targetBlend; // TARGET_BLEND
+  float rangeGate; // RANGE_GATE
+  float contactBrakeTime; // CONTACT_BRAKE_TIME
+};
+
+extern ControlGains controlGains; // What the robot runs with
+
+PidGains forwardPidGains(const ControlGains& gains); // The forward assist's PID, with gains.forwardP as its P
+
+float visionTurnPower(bool seen, float xMiddle);
+float visionForwardPower(bool seen, float width);
+float armPower(float error);
+
+void visionTurnPowerBatch(const ControlGains& gains, const float* seen, const float* xMiddle, float* power, int count);
+void armPowerBatch(const ControlGains& gains, const float* error, float* power, int count);
+
+#endif // _DRIVER_CONTROL_LAWS_HPP_
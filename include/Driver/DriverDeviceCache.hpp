@@ -0,0 +1,67 @@
+#ifndef _DRIVER_DEVICE_CACHE_HPP_
+#define _DRIVER_DEVICE_CACHE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include "DriverArbiter.hpp"
+
+// One read of every motor and the controller per tick, by the task that owns them (DriverDevices, in
+// motorTask), handed out as a snapshot to everyone else. PROS guards each smart port with a mutex, so two
+// tasks reading the same motor wait on each other or get EACCES; with one owner that can't happen, and
+// each value is read once a tick instead of once per task that wants it. The owner fills in the spare
+// frame and then flips which one is current. A reader that loses the core for a whole tick mid copy could
+// still see its frame being filled in again, so the owner bumps a sequence count around every write and
+// readers copy again if it moved. PortStats counts every access by port, and the ones that found it busy.
+// Pure logic, so the simulator runs it too.
+
+#define PORT_COUNT 22 // Smart ports 1-21, with the controller as 0
+#define PORT_CONTROLLER 0
+#define CONTROLLER_ANALOGS 4
+#define CONTROLLER_DIGITAL_FIRST 6 // E_CONTROLLER_DIGITAL_L1, the buttons are bits from here
+
+struct MotorReading
+{
+  bool valid; // False if any of it came back PROS_ERR
+  double position; // Degrees, get_position
+  float rpm;
+  float watts;
+  int32_t milliamps;
+  uint32_t faults;
+};
+
+struct ControllerReading
+{
+  int8_t analog[CONTROLLER_ANALOGS]; // By E_CONTROLLER_ANALOG_*
+  uint16_t held; // Bit per button that's down, E_CONTROLLER_DIGITAL_L1 first
+};
+
+struct DeviceSnapshot
+{
+  uint32_t time; // millis() it was read
+  MotorReading motors[MOTOR_COUNT];
+  ControllerReading controller;
+};
+
+struct DeviceCache
+{
+  DeviceSnapshot frames[2];
+  std::atomic<int> current; // The frame readers get
+  std::atomic<uint32_t> sequence; // Odd while the owner's writing a frame
+  std::atomic<uint16_t> pressed; // Buttons that have gone down since they were last asked about, only reported while still held
+};
+
+struct PortStats
+{
+  uint32_t reads[PORT_COUNT];
+  uint32_t busy[PORT_COUNT]; // Reads that found another task on the port
+};
+
+DeviceSnapshot& deviceNextFrame(DeviceCache& cache);
+void devicePublish(DeviceCache& cache);
+void deviceRead(const DeviceCache& cache, DeviceSnapshot* snapshot);
+bool controllerHeld(const ControllerReading& controller, int button);
+bool controllerNewPress(DeviceCache& cache, int button);
+void portCount(PortStats& stats, int port, int reads, bool busy);
+uint32_t portTotal(const PortStats& stats, bool busy);
+
+#endif // _DRIVER_DEVICE_CACHE_HPP_
@@ -0,0 +1,8 @@
+#include "main.hpp"
+#include "DriverDeviceCache.hpp"
+
+DeviceSnapshot deviceSnapshot();
+bool deviceNewPress(controller_digital_e_t button);
+void devicePoll(pros::Motor* motors, const uint8_t* ports);
+void devicePortRead(uint8_t port, int reads, bool failed);
+void deviceLog();
@@ -0,0 +1,28 @@
+#ifndef _DRIVER_ENERGY_HPP_
+#define _DRIVER_ENERGY_HPP_
+
+#include "DriverArbiter.hpp"
+
+// Where the battery goes. Every tick each motor's power draw (Motor::get_power on the robot) is split between
+// the sources by how much of its command each one made up (DriverArbiter's share), and added up as joules.
+// Power with no command behind it, a motor braking to a stop or holding, goes to ENERGY_IDLE.
+// Counted against the balls picked up, it gives joules per ball. Pure maths, so the simulator runs it too.
+
+#define ENERGY_IDLE SOURCE_COUNT // The bucket after the sources
+#define ENERGY_BUCKETS (SOURCE_COUNT + 1)
+
+struct EnergyMeter
+{
+  float joules[MOTOR_COUNT][ENERGY_BUCKETS];
+  uint32_t balls;
+  float ballJoules; // Total when the last ball was picked up
+};
+
+void energyAdd(EnergyMeter& meter, ArbiterMotor motor, const float* share, float watts, float dt);
+void energyBall(EnergyMeter& meter);
+float energyTotal(const EnergyMeter& meter);
+float energyOfMotor(const EnergyMeter& meter, ArbiterMotor motor);
+float energyOfSource(const EnergyMeter& meter, int bucket);
+float energyPerBall(const EnergyMeter& meter);
+
+#endif // _DRIVER_ENERGY_HPP_
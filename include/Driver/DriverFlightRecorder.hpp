@@ -0,0 +1,86 @@
+#ifndef _DRIVER_FLIGHT_RECORDER_HPP_
+#define _DRIVER_FLIGHT_RECORDER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include "pros/vision.h"
+
+// A black box. Every vision frame, control output and motor reading goes into a fixed ring of small binary
+// entries, which costs a few stores instead of a formatted log line, and the oldest just gets written over.
+// When something goes wrong (the ball lost for a burst of frames, a motor fault, a task waking up late) it's
+// triggered: it keeps recording for RECORDER_POST_TRIGGER so there's the aftermath too, then freezes, and
+// whoever dumps it (DriverBlackBox's task) gets the last RECORDER_ENTRIES in order. Any task can add
+// entries, the index is taken atomically. Pure maths, so the simulator runs it too.
+
+#define RECORDER_ENTRIES 2048 // About 8 seconds of everything at full rate, 40KB
+#define RECORDER_VALUES 6
+#define RECORDER_POST_TRIGGER 1000 // ms still recorded after a trigger
+
+enum RecorderKind
+{
+  RECORD_VISION, // signature, x, y, width, height, object count
+  RECORD_CONTROL, // who (flags), turn, forward, arm power
+  RECORD_MOTOR, // motor (flags), command, rpm, mA, watts x100, faults
+  RECORD_LATE, // task (flags), ms late, period
+  RECORD_TRIGGER // reason (flags), then what set it off
+};
+
+enum RecorderReason
+{
+  TRIGGER_LOST_TRACK,
+  TRIGGER_MOTOR_FAULT,
+  TRIGGER_LATE,
+  TRIGGER_MANUAL
+};
+
+enum RecorderState
+{
+  RECORDER_ARMED,
+  RECORDER_TRIGGERED, // Still recording the aftermath
+  RECORDER_FROZEN // Waiting to be dumped, nothing gets added
+};
+
+struct RecorderEntry
+{
+  uint32_t time; // millis()
+  uint8_t kind;
+  uint8_t flags;
+  int16_t values[RECORDER_VALUES];
+};
+
+struct RecorderTriggers // What counts as worth keeping. 0 turns one off
+{
+  int lostFrames; // Frames in a row without the ball, after having had it
+  uint32_t faultMask; // get_faults bits
+  uint32_t lateMs; // A task waking this much after it should have
+};
+
+struct FlightRecorder
+{
+  RecorderEntry entries[RECORDER_ENTRIES];
+  std::atomic<uint32_t> written; // Entries ever added, the next one goes at written % RECORDER_ENTRIES
+  std::atomic<int> state;
+  RecorderTriggers triggers;
+  uint32_t triggerTime;
+  uint8_t triggerReason;
+  uint32_t triggerCount;
+  int lostFrames; // No ball, frames in a row
+  bool hadBall;
+};
+
+extern const RecorderTriggers recorderDefaultTriggers;
+
+void recorderReset(FlightRecorder& recorder, const RecorderTriggers& triggers);
+void recorderAdd(FlightRecorder& recorder, uint32_t now, RecorderKind kind, uint8_t flags, int16_t a = 0, int16_t b = 0, int16_t c = 0,
+  int16_t d = 0, int16_t e = 0, int16_t f = 0);
+bool recorderTrigger(FlightRecorder& recorder, uint32_t now, RecorderReason reason, int16_t detail = 0);
+void recorderVision(FlightRecorder& recorder, uint32_t now, const pros::c::vision_object_s_t& object, int32_t objectCount);
+void recorderControl(FlightRecorder& recorder, uint32_t now, uint8_t who, float turn, float forward, float arm);
+void recorderMotor(FlightRecorder& recorder, uint32_t now, uint8_t motor, int32_t command, float rpm, int32_t milliamps, float watts,
+  uint32_t faults);
+void recorderDeadline(FlightRecorder& recorder, uint32_t now, uint8_t task, uint32_t wake, uint32_t period);
+bool recorderFrozen(FlightRecorder& recorder, uint32_t now);
+uint32_t recorderSnapshot(FlightRecorder& recorder, const RecorderEntry** first);
+void recorderRearm(FlightRecorder& recorder);
+
+#endif // _DRIVER_FLIGHT_RECORDER_HPP_
@@ -0,0 +1,22 @@
+#ifndef _DRIVER_FOV_LIMIT_HPP_
+#define _DRIVER_FOV_LIMIT_HPP_
+
+#include "DriverGeometry.hpp"
+
+// Keeps the ball in the picture while turning at it. With a high turn gain the base is still spinning when the
+// ball gets to the middle, carries on past, and the ball goes out the other side of the image. The wheels follow
+// a command with a first order lag. The frame it's working from is latency old (FOV_LATENCY on the robot), so
+// the base has already turned some way past it, and nothing can correct a new command until a frame taken after
+// it is read, a frame time plus the latency from now. So the base turns by (rate now * (latency + lag)) +
+// (commanded rate * (frame time + latency)), and the turn is clamped so that after all that the ball is still
+// FOV_MARGIN pixels inside the image. Pure maths, so the simulator runs it too.
+
+#define FOV_MARGIN 40 // Pixels from the image edge the ball has to stay inside
+#define FOV_FRAME_TIME 0.02 // Seconds until the next frame can correct the turn
+#define FOV_LAG 0.08 // Seconds, the wheels' time constant getting to a new speed
+#define FOV_LATENCY 0.04 // Seconds from the sensor seeing the ball to us reading it, about two frames
+
+float fovYawRate(float leftSpeed, float rightSpeed); // Wheel speeds in inches/s to radians/s, positive being a positive turn
+float fovTurnLimit(const CameraModel& camera, float imageX, float turn, float yawRate, float latency = FOV_LATENCY);
+
+#endif // _DRIVER_FOV_LIMIT_HPP_
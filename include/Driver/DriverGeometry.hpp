@@ -0,0 +1,43 @@
+#ifndef _DRIVER_GEOMETRY_HPP_
+#define _DRIVER_GEOMETRY_HPP_
+
+#include "pros/vision.h"
+
+// Nothing in here talks to the hardware, so it can be built into the simulator as well as the robot
+
+#define BASE_WHEEL_DIAMETER 4.0 // Inches
+#define BASE_TRACK_WIDTH 12.5 // Inches between the left and right wheels
+#define BALL_DIAMETER 3.0 // Inches
+
+struct RobotPose // Where the robot is on the field
+{
+  float x; // Inches
+  float y; // Inches
+  float heading; // Radians, counter-clockwise from the x axis
+};
+
+struct CameraModel // How the vision sensor sees the field
+{
+  float focalLength; // Pixels
+  float centerX; // Pixel the optical axis passes through
+  float centerY;
+  float mountForward; // Inches in front of the robot center
+  float mountLeft; // Inches left of the robot center
+  float mountYaw; // Radians, positive is turned left
+  float mountHeight; // Inches above the floor
+  float mountPitch; // Radians, positive is tilted down
+};
+
+extern CameraModel cameraModel;
+extern float visionAimX; // Image x of something straight ahead of the robot, where the turn assist centres the ball
+
+void odometryStep(RobotPose& pose, float leftTravel, float rightTravel, float strafeTravel);
+
+// Both work on the ball unless told the size of something else (objectHeight is how high its middle is off the floor)
+bool imageToField(const CameraModel& camera, const RobotPose& pose, float imageX, float width, float* fieldX, float* fieldY,
+  float objectWidth = BALL_DIAMETER);
+float cameraAimX(const CameraModel& camera);
+bool fieldToImage(const CameraModel& camera, const RobotPose& pose, float fieldX, float fieldY, float* imageX, float* imageY, float* width,
+  float objectWidth = BALL_DIAMETER, float objectHeight = BALL_DIAMETER / 2);
+
+#endif // _DRIVER_GEOMETRY_HPP_
@@ -0,0 +1,58 @@
+#ifndef _DRIVER_ILC_HPP_
+#define _DRIVER_ILC_HPP_
+
+#include <cstdint>
+
+// Iterative learning control for autonomous. The routine is the same list of moves every match, each one
+// taking the left and right wheels a set distance along a smooth profile in a set time. Feedback on where each
+// wheel should be (plus the power for how fast it should be going) leaves the same errors every time: the
+// lag getting going, the deadband at the end of a move, one side weaker than the other. So every run's error
+// is recorded per segment, ILC_SAMPLE_TIME apart, and between runs ilcUpdate folds it into a table of extra
+// power that's added on next time. Pure maths, so the simulator runs it too.
+
+#define ILC_SEGMENTS 8 // Most moves in a routine
+#define ILC_SAMPLE_TIME 0.02 // Seconds per table entry
+#define ILC_SAMPLES 160 // Entries per segment, so a move can take up to 3.2 seconds
+#define ILC_TRACK_P 10.0 // Power per inch a wheel is behind
+#define ILC_VELOCITY_POWER (127 / (100 * BASE_WHEEL_DIAMETER * M_PI / 60)) // Power per inch/s, full power is 100rpm at the wheel
+#define ILC_LEARN_P 3.0 // Power added per inch of last run's error
+#define ILC_LEARN_D 0.4 // And per inch/s it was growing at
+#define ILC_LEAD 4 // Samples the learning looks ahead, the motor lag's worth, since power now shows up as position later
+#define ILC_SMOOTH 0.25 // Each entry takes this much of each neighbour after an update, so noise doesn't build up run on run
+#define ILC_LIMIT 60 // Most power the table can add
+#define ILC_FILE_NAME "ilc.bin"
+
+enum IlcSide { ILC_LEFT, ILC_RIGHT, ILC_SIDES };
+
+struct RoutineSegment
+{
+  float travel[ILC_SIDES]; // Inches each wheel goes, forwards is positive
+  float duration; // Seconds, up to ILC_SAMPLES * ILC_SAMPLE_TIME
+};
+
+struct IlcTable // What gets saved between runs
+{
+  uint32_t routine; // ilcRoutineId of the routine it was learnt on
+  uint32_t runs;
+  float power[ILC_SEGMENTS][ILC_SAMPLES][ILC_SIDES];
+};
+
+struct IlcRecord // One run's error, in inches the wheel was behind
+{
+  float error[ILC_SEGMENTS][ILC_SAMPLES][ILC_SIDES];
+  uint8_t count[ILC_SEGMENTS][ILC_SAMPLES]; // Ticks that landed in each entry
+};
+
+extern const RoutineSegment autonomousRoutine[]; // What autonomous runs
+extern const int autonomousRoutineLength;
+
+uint32_t ilcRoutineId(const RoutineSegment* routine, int segments);
+void ilcReset(IlcTable& table, uint32_t routine);
+void ilcRecordReset(IlcRecord& record);
+float routineDuration(const RoutineSegment* routine, int segments);
+bool ilcStep(const IlcTable& table, IlcRecord& record, const RoutineSegment* routine, int segments, float time, const float* travel,
+  float* power);
+void ilcUpdate(IlcTable& table, const IlcRecord& record, int segments);
+float ilcSegmentError(const IlcRecord& record, int segment);
+
+#endif // _DRIVER_ILC_HPP_
@@ -0,0 +1,4 @@
+#include "main.hpp"
+
+uint32_t lvglHeapBlocks();
+void lvglMemoryLog();
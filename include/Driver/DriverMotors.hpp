@@ -0,0 +1,12 @@
+#include "main.hpp"
+#include "DriverArbiter.hpp"
+
+void motorCommand(ArbiterMotor motor, ArbiterSource source, float power, bool additive = false, uint32_t timeout = ARBITER_TIMEOUT);
+void motorVelocityCommand(ArbiterMotor motor, ArbiterSource source, float rpm, uint32_t timeout = ARBITER_TIMEOUT);
+void motorRelease(ArbiterMotor motor, ArbiterSource source);
+void motorCompensate(ArbiterMotor motor, MotorCompensation* compensation);
+uint32_t motorWrites();
+uint32_t motorWritesSkipped();
+void motorBallCollected();
+void motorEnergyLog();
+void motorTask(void*);
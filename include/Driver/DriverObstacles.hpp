@@ -0,0 +1,43 @@
+#ifndef _DRIVER_OBSTACLES_HPP_
+#define _DRIVER_OBSTACLES_HPP_
+
+#include "DriverGeometry.hpp"
+
+// Opponent robots, picked out by the vision signature trained on the other alliance's colour, tracked on the
+// field with a velocity, and a velocity obstacle filter that bends the base command away from anything it
+// would hit in the next AVOID_HORIZON seconds. Pure maths like DriverTargetEstimate, so the simulator runs it too.
+
+#define OPPONENT_SIG 3 // Vision signature trained on the other alliance's colour
+#define OPPONENT_TRACKS 2 // There are only ever two of them
+#define OPPONENT_PLATE_WIDTH 10.0 // Inches, how wide the coloured part the sensor picks out is
+#define OPPONENT_PLATE_HEIGHT 6.0 // Inches from the floor to the middle of it
+#define OPPONENT_RADIUS 10.0 // Inches, their footprint as a circle
+#define OPPONENT_GATE 18.0 // A detection further than this (inches) from a track is a different robot
+#define OPPONENT_COAST_TIME 10000 // ms a track lasts out of view. Long, it's usually just beside us where the camera can't see
+#define OPPONENT_MISSING_TIME 200 // ms a track lasts where the camera should see it but doesn't
+#define OPPONENT_COAST_MOTION 500 // ms of that it's assumed to keep moving for, after that it's assumed to have stopped
+#define OPPONENT_POSITION_BLEND 0.5 // How far each detection pulls the position
+#define OPPONENT_VELOCITY_BLEND 0.2 // And the velocity, which is noisier
+
+#define ROBOT_RADIUS 9.0 // Inches, ours as a circle
+#define BASE_MAX_SPEED (100 * BASE_WHEEL_DIAMETER * M_PI / 60) // Inches/s of a 100rpm (36:1) wheel at full power
+#define AVOID_HORIZON 1.2 // Seconds ahead a collision has to be before we steer round it
+#define AVOID_MARGIN 5.0 // Inches of clearance on top of both radii
+#define AVOID_SLOWING_COST 2.0 // Losing speed counts this much more than changing direction, so we go round rather than stall
+#define AVOID_EDGE_MARGIN 0.15 // Radians outside the edge of an opponent that going round it aims
+
+struct OpponentTrack
+{
+  bool valid;
+  float x; // Inches
+  float y;
+  float velocityX; // Inches/s
+  float velocityY;
+  uint32_t lastSeen; // millis()
+};
+
+void opponentUpdate(OpponentTrack* tracks, const RobotPose& pose, const pros::c::vision_object_s_t* detections, int count, uint32_t now);
+bool opponentPredict(const OpponentTrack& track, uint32_t now, float* x, float* y);
+bool avoidFilter(const OpponentTrack* tracks, const RobotPose& pose, uint32_t now, float* left, float* right, float* strafe);
+
+#endif // _DRIVER_OBSTACLES_HPP_
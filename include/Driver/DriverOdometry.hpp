@@ -0,0 +1,6 @@
+#include "main.hpp"
+#include "DriverGeometry.hpp"
+
+RobotPose odometryPose();
+void odometryReset(RobotPose pose);
+void odometryTask(void*);
@@ -0,0 +1,27 @@
+#ifndef _DRIVER_PARAMS_HPP_
+#define _DRIVER_PARAMS_HPP_
+
+#include "DriverControlLaws.hpp"
+
+// Every ControlGains field that can be set from a parameter file, by name. The file is one "name value"
+// per line, written by the simulator's tuner (bin/sim tune) and read by the robot at startup. To make
+// something else tunable, add it to ControlGains, give it a line in paramTable, and have whatever uses it
+// take the ControlGains rather than reading controlGains, since the tuner runs a different set on every thread.
+
+#define PARAMS_FILE_NAME "params.txt"
+
+struct TunableParam
+{
+  const char* name;
+  float ControlGains::*field;
+  float min; // The tuner stays inside these, and a file can't go outside them either
+  float max;
+};
+
+int paramCount();
+const TunableParam& paramAt(int index);
+const TunableParam* paramFind(const char* name);
+int paramsFormat(const ControlGains& gains, char* text, int size);
+int paramsParse(ControlGains& gains, const char* text);
+
+#endif // _DRIVER_PARAMS_HPP_
@@ -0,0 +1,37 @@
+#ifndef _DRIVER_PICKUP_HPP_
+#define _DRIVER_PICKUP_HPP_
+
+#include "DriverGeometry.hpp"
+#include "DriverContact.hpp"
+
+// Gets the arm to the ball at the same time as the base, instead of the arm only setting off once the base
+// has stopped. Where the ball is in the image and how wide it is give how high it is off the floor, which
+// gives the arm angle that puts the claw on it when we get there. How long the arm needs to
+// get there is compared with the time to contact, and the arm sets off once they match.
+// Pure maths, so the simulator runs it too.
+
+#define ARM_PIVOT_HEIGHT 10.0 // Inches above the floor
+#define ARM_LENGTH 12.0 // Inches from the pivot to the middle of the claw
+#define ARM_DOWN_ELEVATION (-60 * M_PI / 180) // Radians above level with the arm down on its bottom stop
+#define PICKUP_ARM_TOP_SPEED 3.0 // Radians/s of the arm at full power
+#define PICKUP_ARM_DELAY 0.1 // Seconds for the arm to get going, through the lag and the backlash
+#define PICKUP_ARM_CLOSE (3 * M_PI / 180) // Radians from the grab angle that's close enough to close the claw
+#define PICKUP_ARRIVED 3 // Pixels of width short of BASE_DISTANCE_WIDTH that counts as there
+#define PICKUP_MARGIN 0.1 // Seconds early to set off, so if anything it's the arm that waits
+
+struct PickupPlan
+{
+  bool moving; // The arm has been sent to grabAngle, which sticks until pickupReset
+  float grabAngle; // Radians up from the bottom stop, what the arm needs to be at when the base gets there
+  float timeToContact; // Seconds, as last worked out
+};
+
+void pickupReset(PickupPlan& plan);
+float pickupBallHeight(const CameraModel& camera, float imageY, float width);
+float pickupArmAngle(float height);
+bool pickupArrived(float width);
+float pickupTravelTime(float from, float to, float armP);
+bool pickupUpdate(PickupPlan& plan, const CameraModel& camera, const ContactEstimate& contact, uint32_t now, float width,
+  float yMiddle, float armAngle, float armP);
+
+#endif // _DRIVER_PICKUP_HPP_
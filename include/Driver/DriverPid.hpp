@@ -0,0 +1,72 @@
+#ifndef _DRIVER_PID_HPP_
+#define _DRIVER_PID_HPP_
+
+#include <cmath>
+
+// PID that copes with the motors maxing out, which the vision assists do all the time.
+//  - Back-calculation anti-windup: whenever the output gets clipped, the integral is bled off by how much
+//    was clipped, so it can't keep winding up while the motor is already flat out. Only ever towards 0,
+//    see pidUpdate
+//  - The derivative is taken on the reading, not the error, so a new target doesn't kick the output,
+//    and it's low passed so vision noise doesn't come straight through
+//  - Setpoint weighting: P only sees setpointWeight of the target, so a jump in target is followed less hard
+// Same idea as okapi's IterativePosPIDController (step/setTarget/reset), but plain functions like the
+// rest of the project, since okapi isn't linked in yet. Pure maths, so the simulator runs it too.
+// No virtual step like okapi's. pidUpdate is in here so the simulator's pidStepBatch (SimDispatch) can inline
+// it over a whole array of controllers.
+
+struct PidGains
+{
+  float kP;
+  float kI;
+  float kD;
+  float derivativeFilter; // Seconds, time constant of the low pass on the derivative. 0 is unfiltered
+  float setpointWeight; // 0 to 1, how much of the target P works on. 1 is a normal PID
+  float backCalculation; // 1/s, how fast clipped output bleeds the integral. 0 is no anti-windup
+  float outputMin;
+  float outputMax;
+};
+
+struct PidController
+{
+  PidGains gains;
+  float target;
+  float integral; // Already multiplied by kI, so changing kI doesn't jump the output
+  float derivative; // Filtered rate of change of the reading, per second
+  float lastReading;
+  bool started; // False until the first step, so there is no derivative kick from a made up lastReading
+  float error;
+  float output;
+};
+
+void pidSetTarget(PidController& pid, float target);
+void pidReset(PidController& pid);
+float pidStep(PidController& pid, float reading, float dt);
+
+inline float pidUpdate(const PidGains& gains, float target, float reading, float dt, bool started,
+  float& integral, float& derivative, float& lastReading)
+// The whole step for one controller. Written without branches, so the simulator's pidStepBatch vectorises
+{
+  float error = target - reading;
+
+  // First order low pass, the same as blending each new rate in by dt / (filter + dt)
+  float safeDt = dt > 0 ? dt : 1;
+  float rate = (reading - lastReading) / safeDt;
+  float filtered = derivative + (rate - derivative) * safeDt / (gains.derivativeFilter + safeDt);
+  derivative = started && dt > 0 ? filtered : derivative;
+  lastReading = reading;
+
+  float unclipped = gains.kP * (gains.setpointWeight * target - reading) + integral - gains.kD * derivative;
+  float output = unclipped > gains.outputMax ? gains.outputMax : unclipped;
+  output = output < gains.outputMin ? gains.outputMin : output;
+
+  // Integrate for next time, taking back whatever the clipping threw away. That only ever unwinds the integral
+  // towards 0. When the limits close in on a big P term (the contact brake, the confidence fading through a
+  // dropout) it would otherwise wind it up the other way, and the PID would fight itself once they opened again
+  float wound = integral + gains.kI * error * dt;
+  float unwound = wound + gains.backCalculation * (output - unclipped) * dt;
+  integral = wound > 0 ? fminf(fmaxf(unwound, 0), wound) : fmaxf(fminf(unwound, 0), wound);
+  return output;
+}
+
+#endif // _DRIVER_PID_HPP_
@@ -0,0 +1,29 @@
+#ifndef _DRIVER_POLICY_HPP_
+#define _DRIVER_POLICY_HPP_
+
+#include "DriverGeometry.hpp"
+#include "Util/QuantMlp.hpp"
+
+// A learnt approach to the ball: a small QuantMlp trained in the simulator on what the vision assist does
+// (the turn P, the braked forward PID and the pickup arm), that gives all three powers from one look at the
+// ball. The features are scaled to about -1 to 1 so one input scale suits them all. The robot runs it if
+// there's a policy.bin on the SD card, and the hand-written controllers otherwise.
+// Pure maths, so the simulator runs it too.
+
+#define POLICY_FILE_NAME "policy.bin"
+#define POLICY_INPUTS 6
+#define POLICY_OUTPUTS 3
+#define POLICY_TIME_CLIP 2.0 // Seconds, time to contact past this is all the same to the policy
+
+struct PolicyCommand // Motor powers, -127 to 127
+{
+  float turn; // Positive turns right, like visionTurnPower
+  float forward; // Positive is closing in, the simulator's way round
+  float arm; // Positive is up
+};
+
+void policyFeatures(const CameraModel& camera, bool visible, float xMiddle, float yMiddle, float width, float timeToContact,
+  float armAngle, float* features);
+PolicyCommand policyRun(const MlpModel& model, const float* features);
+
+#endif // _DRIVER_POLICY_HPP_
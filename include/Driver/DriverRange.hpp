@@ -0,0 +1,44 @@
+#ifndef _DRIVER_RANGE_HPP_
+#define _DRIVER_RANGE_HPP_
+
+#include "DriverGeometry.hpp"
+#include "DriverControlLaws.hpp"
+
+// How far away the ball is, from the vision size and the ultrasonic together. Both are turned into depth,
+// the distance straight out from the camera to the middle of the ball, which is what the width gives anyway.
+// Each reading is trusted according to how good that sensor is at that distance: vision gets worse with the
+// square of the distance (a pixel is a lot of inches far away), the ultrasonic only a little. Readings that
+// are too far from the estimate are thrown out, so a wall behind the ball or a half-hidden ball doesn't
+// drag it off. Pure maths, so the simulator runs it too.
+
+#define ULTRASONIC_ECHO_PORT 'C' // ADI ports of the ultrasonic
+#define ULTRASONIC_PING_PORT 'D'
+#define ULTRASONIC_MOUNT_FORWARD 7.0 // Inches in front of the robot centre, pointing straight ahead
+#define ULTRASONIC_BEAM 0.26 // Radians either side of straight ahead it can pick the ball up
+#define ULTRASONIC_MAX_RANGE 60.0 // Inches, further than this a ball is too small to echo reliably
+#define ULTRASONIC_NOISE 0.3 // Inches of noise up close
+#define ULTRASONIC_NOISE_SCALE 0.01 // Plus this fraction of the range
+
+#define VISION_SIZE_NOISE 1.0 // Pixels of noise on the ball's width or height
+#define RANGE_PROCESS_NOISE 4.0 // Inches^2 per second the depth can wander without odometry knowing (slip, the ball rolling)
+#define RANGE_GATE 3.0 // Readings more than this many standard deviations off are thrown out. Default for ControlGains
+#define RANGE_VISION_RESET 10 // Vision readings thrown out in a row before we believe vision and start again
+#define RANGE_TIMEOUT 1500 // ms without a reading before the estimate is dropped
+
+struct RangeEstimate
+{
+  bool valid;
+  float depth; // Inches
+  float variance; // Inches^2
+  uint32_t lastUpdate; // ms
+  int visionRejects;
+};
+
+void rangePredict(RangeEstimate& estimate, float forwardTravel, float dt);
+bool rangeVisionUpdate(RangeEstimate& estimate, const CameraModel& camera, const pros::c::vision_object_s_t& ball, uint32_t now,
+  const ControlGains& gains);
+bool rangeUltrasonicUpdate(RangeEstimate& estimate, const CameraModel& camera, float ultrasonic, float imageX, uint32_t now,
+  const ControlGains& gains);
+bool rangeValid(const RangeEstimate& estimate, uint32_t now);
+
+#endif // _DRIVER_RANGE_HPP_
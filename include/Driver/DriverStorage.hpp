@@ -0,0 +1,11 @@
+#include "main.hpp"
+
+#define STORAGE_CHUNK 4096 // Bytes per log chunk, allocated up front so a log line never reallocs
+#define STORAGE_LOG_CHUNKS 8 // Log kept in RAM, the oldest chunk gets overwritten past this
+#define STORAGE_FILES 8 // Parameter files waiting for the SD card
+#define STORAGE_LOG_FILE "/usd/log.txt"
+
+void storageLog(const char* format, ...);
+bool storageWriteFile(const char* name, const void* data, uint32_t size);
+int storageFlush();
+uint32_t storageLogDropped();
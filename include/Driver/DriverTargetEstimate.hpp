@@ -0,0 +1,39 @@
+#ifndef _DRIVER_TARGET_ESTIMATE_HPP_
+#define _DRIVER_TARGET_ESTIMATE_HPP_
+
+#include "DriverGeometry.hpp"
+#include "DriverControlLaws.hpp"
+
+#define TARGET_COAST_TIME 1500 // How long (ms) we keep predicting a ball we can't see. These two are defaults for ControlGains
+#define TARGET_GATE 12.0 // A detection further than this (inches) from the estimate is treated as a different ball
+#define TARGET_BLEND 0.5 // How far each detection pulls the estimate towards it
+
+// How much to trust it, 0 to 1, which the assists scale their power by. Each of these takes some off:
+#define TARGET_STREAK_FULL 8 // Frames of the same ball before the streak counts in full
+#define TARGET_INNOVATION_SCALE 6.0 // Pixels, average jump across the image from the estimate to each detection that halves confidence
+#define TARGET_WIDTH_SCALE 4.0 // Pixels, average frame to frame change in width that halves confidence
+#define TARGET_QUALITY_BLEND 0.3 // How far each frame pulls those two averages, and how often it's seen
+#define TARGET_CONFIDENCE_GRACE 40 // ms without a detection before it starts to fade, a frame or two
+#define TARGET_CONFIDENCE_FADE 300 // ms after that over which it fades to nothing
+
+struct TargetEstimate // The ball, remembered on the field instead of in the image
+{
+  bool valid;
+  float fieldX; // Inches
+  float fieldY;
+  uint32_t lastSeen; // millis() of the last detection
+  uint16_t signature;
+  int hits; // Frames this ball's been seen in, up to TARGET_STREAK_FULL
+  float seenRate; // Average of 1 for each frame it's in and 0 for each one it isn't
+  float innovation; // Pixels, average distance across the image of each detection from where the estimate put it
+  float widthChange; // Pixels, average frame to frame change in width
+  float lastWidth; // Pixels
+};
+
+void targetEstimateUpdate(TargetEstimate& estimate, const RobotPose& pose, const pros::c::vision_object_s_t& detection, uint32_t now,
+  const ControlGains& gains);
+float targetConfidence(const TargetEstimate& estimate, uint32_t now);
+bool targetEstimatePredict(const TargetEstimate& estimate, const RobotPose& pose, uint32_t now, pros::c::vision_object_s_t* predicted,
+  const ControlGains& gains);
+
+#endif // _DRIVER_TARGET_ESTIMATE_HPP_
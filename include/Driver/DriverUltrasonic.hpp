@@ -0,0 +1,6 @@
+#include "main.hpp"
+#include "DriverRange.hpp"
+
+bool ballDepthValid();
+float ballDepth();
+void rangeTask(void*);
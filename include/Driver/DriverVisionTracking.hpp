@@ -1,8 +1,20 @@
 #include "main.hpp"
+#include "DriverObstacles.hpp"
+#include "DriverPolicy.hpp"
 
 float driverBaseAngle();
 float driverBaseForward();
+void driverBaseForwardReset();
+bool controlGainsLoad();
 
-int driverArmAngle();
+bool driverArmPickup(float armAngle, float* grabAngle);
+void driverArmPickupReset();
+bool driverBaseArrived();
+bool driverPolicyLoad();
+bool driverPolicy(float armAngle, PolicyCommand* command);
 c::vision_object_s_t calculateVision();
+c::vision_object_s_t calculateTarget();
+float visionConfidence();
+uint32_t visionFrameTime();
+const OpponentTrack* visionOpponents();
 void monitorVisionTask(void*);
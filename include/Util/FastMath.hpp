@@ -0,0 +1,27 @@
+#ifndef _UTIL_FAST_MATH_HPP_
+#define _UTIL_FAST_MATH_HPP_
+
+#include <cstdint>
+
+// Cheaper stand-ins for the libm functions the control loops call every tick.
+// Error bounds are the worst case measured against double precision libm over the stated range
+// (run the simulator's "fastmath" scenario to re-check them and see the timings).
+
+// Float, table + polynomial. Arguments are in radians.
+float fastSin(float x); // |error| < 2e-7 for |x| < 1000
+float fastCos(float x); // |error| < 2e-7 for |x| < 1000
+float fastAtan2(float y, float x); // |error| < 1.2e-5 rad, 0 when both are 0
+
+// Fixed point. Angles are binary: 65536 counts per revolution, so they wrap for free.
+int16_t fixedSin(uint16_t angle); // Q15 (32767 = 1.0), |error| < 4 counts
+int16_t fixedCos(uint16_t angle); // Q15, |error| < 4 counts
+int16_t fixedAtan2(int32_t y, int32_t x); // Binary angle from -32768 (-pi) to 32767, |error| < 2 counts
+uint16_t fixedSqrt(uint32_t x); // Exact floor of the square root
+int32_t fixedExp(int32_t x); // Q16.16 in and out, relative error < 3e-5 (1 count near 0) for x < 10.3, saturates above
+
+// Batches, using NEON 4 at a time on the brain and vectorisable loops everywhere else. out may be the same array as in.
+void fastSinBatch(const float* in, float* out, int count); // |error| < 4e-7 for |x| < 1000
+void fastCosBatch(const float* in, float* out, int count); // |error| < 4e-7 for |x| < 1000
+void fastAtan2Batch(const float* y, const float* x, float* out, int count); // |error| < 1.2e-5 rad
+
+#endif // _UTIL_FAST_MATH_HPP_
@@ -0,0 +1,34 @@
+#ifndef _UTIL_POOL_ALLOCATOR_HPP_
+#define _UTIL_POOL_ALLOCATOR_HPP_
+
+#include <cstdint>
+
+// Fixed size blocks for LVGL, in their own arena so the screen making and deleting labels every frame can't
+// chop up the heap the control tasks allocate from. Each size class is a free list of equal blocks, so
+// allocating and freeing are a couple of loads and a compare-and-swap however long the robot has been on.
+// A full class hands the request up to the next one, and when they're all full poolAlloc returns NULL and
+// the caller goes to the heap. The free lists are lock free, so any task (or the LVGL daemon) can use them.
+// Nothing in here talks to the hardware, the simulator's "lvmem" scenario runs it against a heap.
+
+#define POOL_CLASSES 9 // 16 bytes up to 4096, doubling
+#define POOL_MIN_BLOCK 16
+#define POOL_MAX_BLOCK 4096 // DriverStorage's log chunks are this big, so they come out of here too
+
+struct PoolClassStats
+{
+  uint32_t blockSize; // Bytes
+  uint32_t blocks;
+  uint32_t inUse;
+  uint32_t peak; // Most ever in use at once
+  uint32_t allocs; // Blocks handed out, over all time
+  uint32_t spills; // Times this class was full and a bigger one (or the heap) took the request
+};
+
+void poolInit();
+void* poolAlloc(uint32_t size);
+bool poolFree(const void* block);
+uint32_t poolBlockSize(const void* block);
+void poolStats(PoolClassStats* stats);
+uint32_t poolArenaSize();
+
+#endif // _UTIL_POOL_ALLOCATOR_HPP_
@@ -0,0 +1,48 @@
+#ifndef _UTIL_QUANT_MLP_HPP_
+#define _UTIL_QUANT_MLP_HPP_
+
+#include <cstdint>
+
+// A small fully connected network with int8 weights and activations, for learned controllers. Everything
+// lives in the MlpModel, sized by the defines, so there's no heap and a run touches nothing else but the
+// stack. Each layer's int32 sums are scaled back to int8 by a fixed point multiplier (Q24), with ReLU on
+// every layer but the last, which comes out as float. The dot products are NEON on the brain (8 int8
+// multiplies an instruction) and plain loops everywhere else.
+//
+// File layout, little endian: magic, version, layer count, input count (uint32), input scale (float), then
+// per layer: inputs, outputs (uint32), multiplier (int32, Q24, or for the last layer the float scale back
+// to real units), outputs x inputs int8 weights, row by row, then outputs int32 biases.
+
+#define MLP_MAGIC 0x504C4D51 // "QMLP"
+#define MLP_VERSION 1
+#define MLP_MAX_LAYERS 4
+#define MLP_MAX_WIDTH 32 // Inputs or outputs of any layer
+#define MLP_MAX_WEIGHTS (MLP_MAX_LAYERS * MLP_MAX_WIDTH * MLP_MAX_WIDTH)
+#define MLP_MULTIPLIER_SHIFT 24
+
+struct MlpLayer
+{
+  uint16_t inputs;
+  uint16_t outputs;
+  uint32_t weightOffset; // Into MlpModel::weights
+  uint32_t biasOffset; // Into MlpModel::biases
+  int32_t multiplier; // Q24 sum -> next layer's int8. Hidden layers only
+  float outputScale; // Sum -> real units. Last layer only
+};
+
+struct MlpModel
+{
+  int layerCount;
+  int inputs;
+  float inputScale; // Real units per int8 step of the input
+  MlpLayer layers[MLP_MAX_LAYERS];
+  alignas(8) int8_t weights[MLP_MAX_WEIGHTS];
+  int32_t biases[MLP_MAX_LAYERS * MLP_MAX_WIDTH];
+};
+
+bool mlpLoad(MlpModel& model, const uint8_t* data, uint32_t size);
+uint32_t mlpSave(const MlpModel& model, uint8_t* data, uint32_t capacity);
+int mlpOutputs(const MlpModel& model);
+void mlpRun(const MlpModel& model, const float* input, float* output);
+
+#endif // _UTIL_QUANT_MLP_HPP_
@@ -21,6 +21,9 @@
 #define LV_MEM_ATTR /*Complier prefix for big array declaration*/
 #define LV_MEM_AUTO_DEFRAG 1 /*Automatically defrag on free*/
 #else                        /*LV_MEM_CUSTOM*/
+/* libpros.a is built with these. src/Driver/DriverLvglMemory.cpp defines the
+ * lv_mem_* functions itself so LVGL uses Util/PoolAllocator first, and
+ * kmalloc/kfree only for what doesn't fit the pools */
 #define LV_MEM_CUSTOM_INCLUDE                                                  \
   "kapi.h"                          /*Header for the dynamic memory function*/
 #define LV_MEM_CUSTOM_ALLOC kmalloc /*Wrapper to malloc*/
@@ -0,0 +1,85 @@
+#include "Driver/DriverArbiter.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Motor writes over a made up two minute driver session, every motor written every loop like we used to,
+// against going through DriverArbiter. The sticks spend a lot of time centred or pushed all the way,
+// and the assist is held about a third of the time with a new correction every vision frame (20ms)
+
+#define SIM_ARBITER_TICKS 12000 // Two minutes of 10ms loops
+
+void simArbiter()
+{
+  std::mt19937 random(3);
+  std::uniform_real_distribution<float> chance(0, 1);
+  std::uniform_int_distribution<int> segment(30, 200); // Loops the driver does one thing for
+  std::uniform_real_distribution<float> stick(-127, 127);
+
+  Arbiter arbiter = {};
+  float sticks[3] = {}; // Right Y, left X, right X
+  float sweep[3] = {};
+  int segmentLeft = 0;
+  bool assisting = false;
+  float turnBias = 0;
+  float armPower = 0;
+  long naiveWrites = 0;
+
+  for(uint32_t tick = 0; tick < SIM_ARBITER_TICKS; tick++)
+  {
+    uint32_t now = tick * 10;
+    if(--segmentLeft <= 0)
+    {
+      segmentLeft = segment(random);
+      for(int axis = 0; axis < 3; axis++)
+      {
+        float pick = chance(random);
+        sticks[axis] = pick < 0.4 ? 0 : (pick < 0.7 ? (chance(random) < 0.5 ? -127 : 127) : stick(random));
+        sweep[axis] = pick >= 0.7 ? stick(random) / 100 : 0; // Part way pushes drift around
+      }
+      assisting = chance(random) < 0.33;
+    }
+    for(int axis = 0; axis < 3; axis++)
+    {
+      sticks[axis] = fmax(fmin(sticks[axis] + sweep[axis], 127), -127);
+    }
+    if(assisting && tick % 2 == 0)
+    {
+      turnBias = stick(random) / 4;
+      armPower = stick(random) / 2;
+    }
+
+    int rightY = lround(sticks[0]);
+    int leftX = lround(sticks[1]);
+    int rightX = lround(sticks[2]);
+    arbiterSubmit(arbiter, MOTOR_BASE_RIGHT, SOURCE_DRIVER, MODE_POWER, rightY - leftX, false, now, ARBITER_TIMEOUT);
+    arbiterSubmit(arbiter, MOTOR_BASE_LEFT, SOURCE_DRIVER, MODE_POWER, rightY + leftX, false, now, ARBITER_TIMEOUT);
+    arbiterSubmit(arbiter, MOTOR_BASE_H, SOURCE_DRIVER, MODE_POWER, rightX, false, now, ARBITER_TIMEOUT);
+    if(assisting)
+    {
+      arbiterSubmit(arbiter, MOTOR_BASE_RIGHT, SOURCE_ASSIST, MODE_POWER, -turnBias, true, now, ARBITER_TIMEOUT);
+      arbiterSubmit(arbiter, MOTOR_BASE_LEFT, SOURCE_ASSIST, MODE_POWER, turnBias, true, now, ARBITER_TIMEOUT);
+      arbiterSubmit(arbiter, MOTOR_ARM, SOURCE_ASSIST, MODE_POWER, armPower, false, now, ARBITER_TIMEOUT);
+    }
+    else
+    {
+      arbiterRelease(arbiter, MOTOR_BASE_RIGHT, SOURCE_ASSIST);
+      arbiterRelease(arbiter, MOTOR_BASE_LEFT, SOURCE_ASSIST);
+      arbiterRelease(arbiter, MOTOR_ARM, SOURCE_ASSIST);
+      arbiterSubmit(arbiter, MOTOR_ARM, SOURCE_DRIVER, MODE_POWER, 0, false, now, ARBITER_TIMEOUT);
+    }
+
+    for(int motor = 0; motor < MOTOR_COUNT; motor++)
+    {
+      ArbiterMode mode;
+      int32_t value;
+      arbiterResolve(arbiter, (ArbiterMotor)motor, now, &mode, &value);
+      naiveWrites++;
+    }
+  }
+
+  float seconds = SIM_ARBITER_TICKS / 100.0;
+  printf("writing      motor writes/s  saved\n");
+  printf("every loop   %14.1f\n", naiveWrites / seconds);
+  printf("arbiter      %14.1f  %4.1f%%\n", arbiter.writes / seconds, 100.0 * arbiter.skipped / naiveWrites);
+}
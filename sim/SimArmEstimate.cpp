@@ -0,0 +1,114 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Compares ways of getting the arm angle and speed every 10ms loop:
+//  pot      - the raw pot, differenced for speed
+//  pot-lpf  - the pot through a low pass about as smooth as the fused estimate, which lags
+//  encoder  - motor 3's encoder only, which is smooth but carries the backlash
+//  fused    - DriverArmEstimate, the encoder moving the angle and the pot correcting it
+//  +slop    - fused, with the encoder steps that only crossed the backlash taken out (DriverCompensation, as armP does)
+
+#define SIM_ARM_TICK 0.01 // Seconds per arm loop
+#define SIM_ARM_EPISODES 200
+#define SIM_POT_LOWPASS 0.1 // Blend per loop of the pot-lpf estimator
+
+enum SimArmEstimator { ARM_POT, ARM_POT_LOWPASS, ARM_ENCODER, ARM_FUSED, ARM_FUSED_SLOP, ARM_ESTIMATOR_COUNT };
+const char* simArmEstimatorNames[ARM_ESTIMATOR_COUNT] = {"pot", "pot-lpf", "encoder", "fused", "+slop"};
+
+struct SimArmError
+{
+  double angleSquared;
+  double velocitySquared;
+  float worstAngle;
+  int samples;
+};
+
+
+void simArmEpisode(uint32_t seed, SimArmError* errors)
+// The driver swings the arm up and down with a new stick position every half second or so
+{
+  SimWorld world;
+  simReset(world, seed);
+
+  float angle[ARM_ESTIMATOR_COUNT] = {};
+  float velocity[ARM_ESTIMATOR_COUNT] = {};
+  float lastAngle[ARM_ESTIMATOR_COUNT] = {};
+  ArmEstimate fused = {};
+  ArmEstimate fusedSlop = {};
+  MotorCompensation compensation = {};
+  float armTravel = 0;
+  float lastEncoder = 0;
+
+  std::uniform_real_distribution<float> stick(-127, 127);
+  std::uniform_int_distribution<int> hold(20, 80);
+  float power = 0;
+  int holdTicks = 0;
+
+  for(int tick = 0; tick < 2000; tick++)
+  {
+    if(--holdTicks <= 0)
+    {
+      power = stick(world.random);
+      holdTicks = hold(world.random);
+    }
+    float lastTrueAngle = world.armAngle;
+    simDriveArm(world, power, SIM_ARM_TICK);
+
+    float pot = simArmPot(world) * ARM_RADIANS_PER_POT_COUNT;
+    float encoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+
+    armEstimateUpdate(fused, pot, encoder, SIM_ARM_TICK);
+    angle[ARM_FUSED] = fused.angle;
+    velocity[ARM_FUSED] = fused.velocity;
+
+    armTravel += compensationObserve(compensation, encoder - lastEncoder, SIM_ARM_TICK);
+    lastEncoder = encoder;
+    armEstimateUpdate(fusedSlop, pot, armTravel, SIM_ARM_TICK);
+    compensationLearnBacklash(compensation, encoder, pot, fusedSlop.velocity);
+    angle[ARM_FUSED_SLOP] = fusedSlop.angle;
+    velocity[ARM_FUSED_SLOP] = fusedSlop.velocity;
+
+    angle[ARM_POT] = pot;
+    angle[ARM_POT_LOWPASS] = tick == 0 ? pot : angle[ARM_POT_LOWPASS] + (pot - angle[ARM_POT_LOWPASS]) * SIM_POT_LOWPASS;
+    angle[ARM_ENCODER] = encoder;
+    for(int estimator = ARM_POT; estimator < ARM_FUSED; estimator++)
+    {
+      float speed = tick == 0 ? 0 : (angle[estimator] - lastAngle[estimator]) / SIM_ARM_TICK;
+      velocity[estimator] = estimator == ARM_ENCODER ? velocity[estimator] + (speed - velocity[estimator]) * ARM_VELOCITY_BLEND : speed;
+      lastAngle[estimator] = angle[estimator];
+    }
+
+    float trueVelocity = (world.armAngle - lastTrueAngle) / SIM_ARM_TICK; // Of the arm itself, which sits still while the motor crosses the backlash
+    for(int estimator = 0; estimator < ARM_ESTIMATOR_COUNT; estimator++)
+    {
+      float angleError = angle[estimator] - world.armAngle;
+      float velocityError = velocity[estimator] - trueVelocity;
+      errors[estimator].angleSquared += angleError * angleError;
+      errors[estimator].velocitySquared += velocityError * velocityError;
+      errors[estimator].worstAngle = fmax(errors[estimator].worstAngle, fabs(angleError));
+      errors[estimator].samples++;
+    }
+  }
+}
+
+
+void simArmEstimate()
+{
+  SimArmError errors[ARM_ESTIMATOR_COUNT] = {};
+  for(uint32_t episode = 1; episode <= SIM_ARM_EPISODES; episode++)
+  {
+    simArmEpisode(episode, errors);
+  }
+
+  printf("estimator  angle RMS (deg)  worst angle (deg)  speed RMS (deg/s)\n");
+  for(int estimator = 0; estimator < ARM_ESTIMATOR_COUNT; estimator++)
+  {
+    SimArmError& error = errors[estimator];
+    printf("%-9s  %15.2f  %17.2f  %17.1f\n", simArmEstimatorNames[estimator],
+      sqrt(error.angleSquared / error.samples) * 180 / M_PI, error.worstAngle * 180 / M_PI,
+      sqrt(error.velocitySquared / error.samples) * 180 / M_PI);
+  }
+}
@@ -0,0 +1,146 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverArmMask.hpp"
+#include "Driver/DriverPickup.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Logs of the vision frames while carrying a ball: the arm comes up from the grab to a carrying angle, holds it,
+// and goes back down, with another ball somewhere out on the field most of the time. Every frame is replayed
+// through the biggest detection, like get_by_sig(0, BALL_SIG) picked, and through armMaskPick on the four
+// biggest. The mask gets the robot's arm angle, which is a frame behind and a little noisy, and the real camera
+// is a little off the camera model, the way calibration leaves it. A field ball behind the held one isn't seen.
+
+#define SIM_MASK_LOGS 500
+#define SIM_MASK_FRAMES 150 // 3s at 50Hz
+#define SIM_MASK_ARM_SPEED 2.5 // Radians/s up and down
+#define SIM_MASK_ANGLE_NOISE 0.02 // Radians on the robot's arm angle
+#define SIM_MASK_FIELD_BALL 0.7 // Chance there's a ball on the field as well
+#define SIM_MASK_SIG 2
+
+struct SimMaskStats
+{
+  int clawFrames; // The held ball was in view
+  int fieldFrames; // The field ball was in view
+  int falseLocks[2]; // Picked the held ball, biggest vs masked
+  int missed[2]; // The field ball was in view and something else (or nothing) got picked
+};
+
+static float simMaskArm(int frame, float carry) // Radians up from the stop at this frame
+{
+  float time = frame * 0.02;
+  float up = fminf(carry, fmaxf(0, (time - 0.5f) * SIM_MASK_ARM_SPEED));
+  float down = fmaxf(0, (time - 2.0f) * SIM_MASK_ARM_SPEED);
+  return fmaxf(0, up - down);
+}
+
+static bool simMaskDetect(const CameraModel& camera, std::mt19937& random, float forward, float left, float height, float size,
+  pros::c::vision_object_s_t* seen)
+{
+  float imageX, imageY, width;
+  if(!fieldToImage(camera, {0, 0, 0}, forward, left, &imageX, &imageY, &width, size, height)
+    || imageX < 0 || imageX >= VISION_FOV_WIDTH || imageY < 0 || imageY >= VISION_FOV_HEIGHT)
+  {
+    return false;
+  }
+  std::normal_distribution<float> noise(0, SIM_PIXEL_NOISE);
+  *seen = {};
+  seen->signature = SIM_MASK_SIG;
+  seen->x_middle_coord = lround(imageX + noise(random));
+  seen->y_middle_coord = lround(imageY + noise(random));
+  seen->width = std::max(1L, lround(width + noise(random)));
+  seen->height = seen->width;
+  return true;
+}
+
+static void simMaskLog(const ArmMask& mask, uint32_t seed, SimMaskStats& stats)
+{
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> unit(0, 1);
+  std::normal_distribution<float> normal(0, 1);
+  CameraModel camera = cameraModel; // The real one, a little off the model
+  camera.mountPitch += 0.03 * normal(random);
+  camera.mountHeight += 0.5 * normal(random);
+  camera.mountYaw += 0.02 * normal(random);
+
+  float carry = 0.5 + 1.3 * unit(random);
+  bool fieldBall = unit(random) < SIM_MASK_FIELD_BALL;
+  float distance = 24 + 72 * unit(random);
+  float bearing = 0.8 * (unit(random) - 0.5f);
+  float clawOffset = 0.5 * normal(random); // Where in the claw the ball sits, inches left
+
+  for(int frame = 0; frame < SIM_MASK_FRAMES; frame++)
+  {
+    pros::c::vision_object_s_t objects[ARM_MASK_OBJECTS];
+    int count = 0;
+    int claw = -1, field = -1; // Which detection is which, by index once sorted
+
+    float arm = simMaskArm(frame, carry);
+    float elevation = ARM_DOWN_ELEVATION + arm;
+    pros::c::vision_object_s_t seen;
+    if(simMaskDetect(camera, random, ARM_PIVOT_FORWARD + ARM_LENGTH * cosf(elevation), clawOffset,
+      ARM_PIVOT_HEIGHT + ARM_LENGTH * sinf(elevation), BALL_DIAMETER, &seen))
+    {
+      seen.left_coord = 1; // Marks it as ours through the sort
+      objects[count++] = seen;
+    }
+    if(fieldBall && simMaskDetect(camera, random, distance * cosf(bearing), distance * sinf(bearing), BALL_DIAMETER / 2, BALL_DIAMETER, &seen))
+    {
+      bool hidden = count > 0 && abs(seen.x_middle_coord - objects[0].x_middle_coord) < objects[0].width / 2
+        && abs(seen.y_middle_coord - objects[0].y_middle_coord) < objects[0].height / 2; // Behind the one in the claw
+      if(!hidden)
+      {
+        seen.left_coord = 2;
+        objects[count++] = seen;
+      }
+    }
+    std::sort(objects, objects + count, [](const pros::c::vision_object_s_t& a, const pros::c::vision_object_s_t& b) { return a.width > b.width; });
+    for(int i = 0; i < count; i++)
+    {
+      if(objects[i].left_coord == 1) claw = i;
+      if(objects[i].left_coord == 2) field = i;
+    }
+
+    float measuredArm = simMaskArm(frame + 1, carry) + SIM_MASK_ANGLE_NOISE * normal(random);
+    int picks[2] = {count > 0 ? 0 : -1, armMaskPick(mask, measuredArm, objects, count)};
+    stats.clawFrames += claw >= 0;
+    stats.fieldFrames += field >= 0;
+    for(int way = 0; way < 2; way++)
+    {
+      stats.falseLocks[way] += claw >= 0 && picks[way] == claw;
+      stats.missed[way] += field >= 0 && picks[way] != field;
+    }
+  }
+}
+
+void simArmMask()
+{
+  ArmMask mask;
+  armMaskBuild(mask, cameraModel);
+  int first = -1, last = -1;
+  for(int step = 0; step < ARM_MASK_STEPS; step++)
+  {
+    if(mask.boxes[step].visible)
+    {
+      last = step;
+      first = first < 0 ? step : first;
+    }
+  }
+  float step = ARM_MASK_RANGE / (ARM_MASK_STEPS - 1);
+  printf("The claw is in view from %.2f to %.2f rad up from the stop\n", first * step, last * step);
+
+  SimMaskStats stats = {};
+  for(uint32_t log = 1; log <= SIM_MASK_LOGS; log++)
+  {
+    simMaskLog(mask, log, stats);
+  }
+  printf("%d logs of %d frames, the held ball in view in %d frames, the field ball in %d\n", SIM_MASK_LOGS, SIM_MASK_FRAMES,
+    stats.clawFrames, stats.fieldFrames);
+  printf("pick          locked on our own ball  missed the field ball\n");
+  const char* names[2] = {"biggest", "armMaskPick"};
+  for(int way = 0; way < 2; way++)
+  {
+    printf("%-12s  %21.1f%%  %20.1f%%\n", names[way], 100.0 * stats.falseLocks[way] / std::max(1, stats.clawFrames),
+      100.0 * stats.missed[way] / std::max(1, stats.fieldFrames));
+  }
+}
@@ -0,0 +1,444 @@
+#include "SimBatch.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include "Util/FastMath.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#define SIM_BATCH_ROBOTS 1024
+#define SIM_BATCH_TICKS 3000 // 30 simulated seconds per robot
+#define SIM_ARRIVE_X 10 // Pixels from centre that count as lined up
+#define SIM_BALL_SIG 2
+#define SIM_BATCH_NEAREST 36 // Inches out the ball is placed. Closer than about 26 it's already the grab width
+#define SIM_BATCH_FURTHEST 72
+#define SIM_BATCH_ARM_START (90 * M_PI / 180) // Where the arm starts each approach, carried up out of the way
+
+static inline float simUniform(uint32_t& state) // 0 to 1, xorshift32 so it vectorises
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return (state >> 8) * (1.0f / 16777216);
+}
+
+static const MotorCompensation simBatchArmCompensation = {SIM_ARM_DEADBAND}; // No backlash in the batch, so only the deadband
+
+struct SimAssistOutput
+{
+  bool aimed; // There's a ball to aim at, seen or coasted
+  float aimX; // Pixels, where it is or should be
+  float confidence;
+  float forward; // Power, subtracted like driverBaseForward's
+  float armError; // Degrees off the grab angle, 0 until the pickup plan says go
+};
+
+static void simAssistReset(SimAssist& assist)
+{
+  assist.target = {};
+  assist.range = {};
+  contactReset(assist.contact);
+  assist.forwardPid.target = BASE_DISTANCE_WIDTH;
+  pidReset(assist.forwardPid);
+  pickupReset(assist.pickup);
+}
+
+static void simAssistStep(SimAssist& assist, const ControlGains& gains, const RobotPose& pose, const pros::c::vision_object_s_t& frame,
+  bool newFrame, uint32_t now, float forwardTravel, float ultrasonic, float armAngle, SimAssistOutput* output)
+// One tick of what monitorVisionTask, rangeTask, driverBaseForward and driverArmPickup do with a frame. ultrasonic is
+// in inches, 0 for nothing heard. The turn is left to the caller, from aimX
+{
+  rangePredict(assist.range, forwardTravel, SIM_TICK);
+  if(newFrame)
+  {
+    targetEstimateUpdate(assist.target, pose, frame, now, gains);
+    if(frame.signature != VISION_OBJECT_ERR_SIG)
+    {
+      contactUpdate(assist.contact, frame.width, frame.y_middle_coord, now);
+    }
+    rangeVisionUpdate(assist.range, cameraModel, frame, now, gains);
+  }
+
+  pros::c::vision_object_s_t aim = frame; // calculateTarget
+  if(aim.signature == VISION_OBJECT_ERR_SIG)
+  {
+    targetEstimatePredict(assist.target, pose, now, &aim, gains);
+  }
+  output->aimed = aim.signature != VISION_OBJECT_ERR_SIG;
+  output->aimX = aim.x_middle_coord;
+  output->confidence = targetConfidence(assist.target, now);
+  output->forward = 0;
+  output->armError = 0;
+  if(!output->aimed)
+  {
+    pidReset(assist.forwardPid);
+    pickupReset(assist.pickup);
+    return;
+  }
+  rangeUltrasonicUpdate(assist.range, cameraModel, ultrasonic, aim.x_middle_coord, now, gains);
+
+  float width = aim.width;
+  if(rangeValid(assist.range, now) && assist.range.depth > BALL_DIAMETER)
+  {
+    width = BALL_DIAMETER * cameraModel.focalLength / assist.range.depth;
+  }
+  assist.forwardPid.gains = forwardPidGains(gains);
+  assist.forwardPid.gains.outputMax = contactBrake(assist.contact, now, width, BASE_DISTANCE_WIDTH, 127 * output->confidence, gains);
+  assist.forwardPid.gains.outputMin = -127 * output->confidence;
+  output->forward = -pidStep(assist.forwardPid, width, SIM_TICK);
+
+  if(pickupUpdate(assist.pickup, cameraModel, assist.contact, now, aim.width, aim.y_middle_coord, armAngle, gains.armP))
+  {
+    output->armError = (assist.pickup.grabAngle - armAngle) * 180 / M_PI; // Degrees, like DriverArmP
+  }
+}
+
+static float simBatchUltrasonic(SimBatch& batch, int i) // Inches, as simUltrasonic would read it, with the batch's uniform noise
+{
+  float headingSin = sinf(batch.heading[i]);
+  float headingCos = cosf(batch.heading[i]);
+  float dx = batch.ballX[i] - (batch.x[i] + (float)ULTRASONIC_MOUNT_FORWARD * headingCos);
+  float dy = batch.ballY[i] - (batch.y[i] + (float)ULTRASONIC_MOUNT_FORWARD * headingSin);
+  float forward = dx * headingCos + dy * headingSin;
+  float left = -dx * headingSin + dy * headingCos;
+  float range = sqrtf(forward * forward + left * left) - BALL_DIAMETER / 2;
+
+  if(simUniform(batch.random[i]) < (float)SIM_ULTRASONIC_GHOST)
+  {
+    return roundf(simUniform(batch.random[i]) * 150) / 2.54f;
+  }
+  if(forward <= 0 || fabsf(atan2f(left, forward)) > (float)ULTRASONIC_BEAM || range > (float)ULTRASONIC_MAX_RANGE
+    || simUniform(batch.random[i]) < (float)SIM_ULTRASONIC_MISS)
+  {
+    return 0;
+  }
+  float noise = (simUniform(batch.random[i]) - 0.5f) * (float)(SIM_ULTRASONIC_NOISE * 3.464);
+  return roundf((range + noise) * 2.54f) / 2.54f; // The sensor reads whole cm
+}
+
+static pros::c::vision_object_s_t simBatchFrame(const SimBatch& batch, int i) // Robot i's frame as simSee would have given it
+{
+  pros::c::vision_object_s_t frame = {};
+  frame.signature = batch.seen[i] != 0 ? SIM_BALL_SIG : VISION_OBJECT_ERR_SIG;
+  frame.x_middle_coord = batch.imageX[i];
+  frame.y_middle_coord = batch.imageY[i];
+  frame.width = batch.width[i] > 1 ? batch.width[i] : 1;
+  frame.height = frame.width;
+  frame.left_coord = frame.x_middle_coord - frame.width / 2;
+  frame.top_coord = frame.y_middle_coord - frame.height / 2;
+  return frame;
+}
+
+void simBatchPlace(SimBatch& batch, int i) // Starts robot i on a new approach
+{
+  float distance = SIM_BATCH_NEAREST + (SIM_BATCH_FURTHEST - SIM_BATCH_NEAREST) * simUniform(batch.random[i]);
+  float bearing = (simUniform(batch.random[i]) - 0.5f) * 1.0f;
+  batch.x[i] = 0;
+  batch.y[i] = 0;
+  batch.heading[i] = 0;
+  batch.leftSpeed[i] = 0;
+  batch.rightSpeed[i] = 0;
+  batch.strafeSpeed[i] = 0;
+  batch.ballX[i] = distance * cos(bearing);
+  batch.ballY[i] = distance * sin(bearing);
+  batch.seen[i] = 0; // The last approach's frame would otherwise count for the first tick of this one
+  batch.droppingOut[i] = 0;
+  batch.episodeTime[i] = 0;
+  batch.armAngle[i] = SIM_BATCH_ARM_START;
+  batch.armSpeed[i] = 0;
+  simAssistReset(batch.assist[i]);
+}
+
+void simBatchReset(SimBatch& batch, int count, uint32_t seed)
+{
+  batch.count = count;
+  batch.gains = controlGains;
+  for(std::vector<float>* array : {&batch.x, &batch.y, &batch.heading, &batch.leftSpeed, &batch.rightSpeed, &batch.strafeSpeed,
+    &batch.armAngle, &batch.armSpeed, &batch.ballX, &batch.ballY, &batch.seen, &batch.imageX, &batch.imageY, &batch.width,
+    &batch.droppingOut, &batch.aimed, &batch.aimX, &batch.confidence, &batch.episodeTime, &batch.scratchA, &batch.scratchB,
+    &batch.scratchC, &batch.scratchD, &batch.scratchE, &batch.scratchF})
+  {
+    array->assign(count, 0);
+  }
+  batch.random.resize(count);
+  batch.assist.resize(count);
+  for(int i = 0; i < count; i++)
+  {
+    batch.random[i] = seed * 2654435761u + i * 40503u + 1; // Any non-zero start works for xorshift
+    simBatchPlace(batch, i);
+  }
+  batch.ticks = 0;
+  batch.episodes = 0;
+  batch.arrivals = 0;
+  batch.arrivalTime = 0;
+  batch.armError = 0;
+}
+
+
+void simBatchSee(SimBatch& batch) // Same camera model as fieldToImage/simSee, for every robot at once
+{
+  const CameraModel camera = cameraModel;
+  int n = batch.count;
+  float* __restrict headingSin = batch.scratchA.data();
+  float* __restrict headingCos = batch.scratchB.data();
+  float* __restrict depth = batch.scratchC.data();
+  float* __restrict below = batch.scratchD.data();
+  float* __restrict height = batch.scratchE.data();
+
+  fastSinBatch(batch.heading.data(), headingSin, n); // mountYaw is 0 in the sim, so the camera faces the same way as the robot
+  fastCosBatch(batch.heading.data(), headingCos, n);
+
+  float* __restrict left = batch.scratchF.data();
+  const float* __restrict x = batch.x.data();
+  const float* __restrict y = batch.y.data();
+  const float* __restrict ballX = batch.ballX.data();
+  const float* __restrict ballY = batch.ballY.data();
+#pragma GCC ivdep // The arrays never overlap
+  for(int i = 0; i < n; i++)
+  {
+    float cameraX = x[i] + camera.mountForward * headingCos[i] - camera.mountLeft * headingSin[i];
+    float cameraY = y[i] + camera.mountForward * headingSin[i] + camera.mountLeft * headingCos[i];
+    float dx = ballX[i] - cameraX;
+    float dy = ballY[i] - cameraY;
+    depth[i] = dx * headingCos[i] + dy * headingSin[i];
+    left[i] = -dx * headingSin[i] + dy * headingCos[i];
+    height[i] = camera.mountHeight - BALL_DIAMETER / 2;
+  }
+
+  fastAtan2Batch(height, depth, below, n);
+  for(int i = 0; i < n; i++)
+  {
+    below[i] -= camera.mountPitch;
+  }
+  fastSinBatch(below, headingSin, n); // Reusing the scratch arrays, the heading is done with
+  fastCosBatch(below, headingCos, n);
+
+  uint32_t* __restrict random = batch.random.data();
+  float* __restrict droppingOut = batch.droppingOut.data();
+  float* __restrict seen = batch.seen.data();
+  float* __restrict imageX = batch.imageX.data();
+  float* __restrict imageY = batch.imageY.data();
+  float* __restrict width = batch.width.data();
+#pragma GCC ivdep // The arrays never overlap
+  for(int i = 0; i < n; i++)
+  {
+    float safeDepth = depth[i] > BALL_DIAMETER ? depth[i] : BALL_DIAMETER;
+    float trueX = camera.centerX - left[i] * camera.focalLength / safeDepth;
+    float trueY = camera.centerY + camera.focalLength * headingSin[i] / headingCos[i];
+    float trueWidth = BALL_DIAMETER * camera.focalLength / safeDepth;
+
+    float inView = (depth[i] >= BALL_DIAMETER) & (trueX >= 0) & (trueX < VISION_FOV_WIDTH) & (trueY >= 0) & (trueY < VISION_FOV_HEIGHT); // & not &&, no branches
+    float chance = simUniform(random[i]);
+    droppingOut[i] = droppingOut[i] != 0 ? chance > (float)SIM_DROPOUT_END : chance < (float)SIM_DROPOUT_START;
+
+    // Uniform noise with the same spread as SIM_PIXEL_NOISE, a Gaussian doesn't vectorise cheaply
+    float noiseX = (simUniform(random[i]) - 0.5f) * (float)(SIM_PIXEL_NOISE * 3.464);
+    float noiseY = (simUniform(random[i]) - 0.5f) * (float)(SIM_PIXEL_NOISE * 3.464);
+    float noiseWidth = (simUniform(random[i]) - 0.5f) * (float)(SIM_PIXEL_NOISE * 3.464);
+    seen[i] = inView * (1 - droppingOut[i]);
+    imageX[i] = roundf(trueX + noiseX);
+    imageY[i] = roundf(trueY + noiseY);
+    width[i] = roundf(trueWidth + noiseWidth);
+  }
+}
+
+
+void simBatchStep(SimBatch& batch)
+{
+  int n = batch.count;
+  bool newFrame = batch.ticks % 2 == 0; // The sensor runs at 50Hz, half the control rate
+  if(newFrame)
+  {
+    simBatchSee(batch);
+  }
+  uint32_t now = batch.ticks * (uint32_t)(SIM_TICK * 1000); // ms, like millis()
+
+  float* __restrict turn = batch.scratchA.data();
+  float* __restrict forward = batch.scratchB.data();
+  float* __restrict armError = batch.scratchC.data();
+  float* __restrict arm = batch.scratchD.data();
+
+  // What the assists track, one robot at a time
+  for(int i = 0; i < n; i++)
+  {
+    RobotPose pose = {batch.x[i], batch.y[i], batch.heading[i]}; // Odometry is exact here
+    float forwardTravel = (batch.leftSpeed[i] + batch.rightSpeed[i]) * (float)(SIM_TICK / 2);
+    SimAssistOutput output;
+    simAssistStep(batch.assist[i], batch.gains, pose, simBatchFrame(batch, i), newFrame, now, forwardTravel,
+      simBatchUltrasonic(batch, i), batch.armAngle[i], &output);
+    batch.aimed[i] = output.aimed;
+    batch.aimX[i] = output.aimX;
+    batch.confidence[i] = output.confidence;
+    forward[i] = output.forward;
+    armError[i] = output.armError;
+  }
+
+  // The robot's own controllers, on every robot at once
+  visionTurnPowerBatch(batch.gains, batch.aimed.data(), batch.aimX.data(), turn, n);
+  const float* __restrict confidence = batch.confidence.data();
+  for(int i = 0; i < n; i++)
+  {
+    turn[i] *= confidence[i]; // Like driverBaseTurn, without the FOV limit
+  }
+  armPowerBatch(batch.gains, armError, arm, n);
+  for(int i = 0; i < n; i++) // The arbiter's deadband compensation, already learnt. Without it armPower stalls a long way short
+  {
+    arm[i] = compensationCommand(simBatchArmCompensation, arm[i]);
+  }
+
+  float baseResponse = 1 - exp(-SIM_TICK / SIM_MOTOR_LAG);
+  float armResponse = 1 - exp(-SIM_TICK / SIM_ARM_LAG);
+  float* __restrict midHeading = batch.scratchE.data();
+  const float* __restrict heading = batch.heading.data();
+  float* __restrict leftSpeed = batch.leftSpeed.data();
+  float* __restrict rightSpeed = batch.rightSpeed.data();
+  float* __restrict strafeSpeed = batch.strafeSpeed.data();
+  float* __restrict armAngle = batch.armAngle.data();
+  float* __restrict armSpeed = batch.armSpeed.data();
+#pragma GCC ivdep // The arrays never overlap
+  for(int i = 0; i < n; i++)
+  {
+    // Same mixing as driverBaseControl with the sticks centred
+    float left = turn[i] - forward[i];
+    float right = -turn[i] - forward[i];
+    left = simDeadband(left, SIM_BASE_DEADBAND);
+    right = simDeadband(right, SIM_BASE_DEADBAND);
+    leftSpeed[i] += (left / 127 * (float)SIM_BASE_MAX_SPEED - leftSpeed[i]) * baseResponse;
+    rightSpeed[i] += (right / 127 * (float)SIM_BASE_MAX_SPEED - rightSpeed[i]) * baseResponse;
+    strafeSpeed[i] -= strafeSpeed[i] * baseResponse;
+    midHeading[i] = heading[i] + (rightSpeed[i] - leftSpeed[i]) * (float)(SIM_TICK / BASE_TRACK_WIDTH / 2);
+
+    float power = simDeadband(arm[i], SIM_ARM_DEADBAND);
+    float speed = armSpeed[i] + (power / 127 * (float)SIM_ARM_MAX_SPEED - armSpeed[i]) * armResponse;
+    float angle = armAngle[i] + speed * (float)SIM_TICK;
+    bool stopped = angle < 0 || angle > (float)SIM_ARM_RANGE; // Hit a hard stop
+    armAngle[i] = angle < 0 ? 0 : (angle > (float)SIM_ARM_RANGE ? (float)SIM_ARM_RANGE : angle);
+    armSpeed[i] = stopped ? 0 : speed;
+  }
+
+  // odometryStep, batched
+  float* __restrict headingSin = batch.scratchC.data();
+  float* __restrict headingCos = batch.scratchD.data();
+  fastSinBatch(midHeading, headingSin, n);
+  fastCosBatch(midHeading, headingCos, n);
+  float* __restrict x = batch.x.data();
+  float* __restrict y = batch.y.data();
+  float* __restrict newHeading = batch.heading.data();
+  float* __restrict episodeTime = batch.episodeTime.data();
+#pragma GCC ivdep // The arrays never overlap
+  for(int i = 0; i < n; i++)
+  {
+    float forwardTravel = (leftSpeed[i] + rightSpeed[i]) * (float)(SIM_TICK / 2);
+    float strafeTravel = strafeSpeed[i] * (float)SIM_TICK;
+    x[i] += forwardTravel * headingCos[i] + strafeTravel * headingSin[i];
+    y[i] += forwardTravel * headingSin[i] - strafeTravel * headingCos[i];
+    newHeading[i] += (rightSpeed[i] - leftSpeed[i]) * (float)(SIM_TICK / BASE_TRACK_WIDTH);
+    episodeTime[i] += (float)SIM_TICK;
+  }
+
+  // Finished approaches start again. Rare enough that this loop doesn't need to vectorise
+  for(int i = 0; i < n; i++)
+  {
+    bool arrived = batch.seen[i] != 0 && fabsf(batch.imageX[i] - VISION_FOV_WIDTH/2) < SIM_ARRIVE_X && batch.width[i] >= BASE_DISTANCE_WIDTH - 2;
+    if(arrived || batch.episodeTime[i] >= SIM_EPISODE_TIMEOUT)
+    {
+      batch.episodes++;
+      if(arrived)
+      {
+        batch.arrivals++;
+        batch.arrivalTime += batch.episodeTime[i];
+        batch.armError += fabsf(batch.armAngle[i] - pickupArmAngle(BALL_DIAMETER / 2)) * 180 / M_PI; // The ball's on the floor
+      }
+      simBatchPlace(batch, i);
+    }
+  }
+  batch.ticks++;
+}
+
+
+void simScalarApproaches(int robots, int ticks, long* episodes, long* arrivals, double* arrivalTime)
+// The same approaches one SimWorld at a time, for comparison
+{
+  for(int robot = 0; robot < robots; robot++)
+  {
+    SimWorld world;
+    simReset(world, robot + 1);
+    std::uniform_real_distribution<float> distance(SIM_BATCH_NEAREST, SIM_BATCH_FURTHEST), bearing(-0.5, 0.5);
+    pros::c::vision_object_s_t seen = {};
+    SimAssist assist;
+    float episodeTime = 0;
+
+    auto place = [&]()
+    {
+      float range = distance(world.random), angle = bearing(world.random);
+      world.pose = {0, 0, 0};
+      world.leftSpeed = world.rightSpeed = world.strafeSpeed = 0;
+      world.ballX = range * cos(angle);
+      world.ballY = range * sin(angle);
+      world.armAngle = world.armMotorAngle = SIM_BATCH_ARM_START;
+      seen.signature = VISION_OBJECT_ERR_SIG;
+      world.armSpeed = 0;
+      episodeTime = 0;
+      simAssistReset(assist);
+    };
+    place();
+
+    for(int tick = 0; tick < ticks; tick++)
+    {
+      bool newFrame = tick % 2 == 0;
+      if(newFrame)
+      {
+        seen = simSee(world, SIM_BALL_SIG);
+      }
+      bool visible = seen.signature != VISION_OBJECT_ERR_SIG;
+      SimAssistOutput output;
+      simAssistStep(assist, controlGains, world.pose, seen, newFrame, world.time, (world.leftSpeed + world.rightSpeed) * SIM_TICK / 2,
+        simUltrasonic(world) / 2.54, world.armAngle, &output);
+      float turn = visionTurnPower(output.aimed, output.aimX) * output.confidence;
+      simDrive(world, turn - output.forward, -turn - output.forward, 0, SIM_TICK);
+      simDriveArm(world, compensationCommand(simBatchArmCompensation, armPower(output.armError)), SIM_TICK);
+      episodeTime += SIM_TICK;
+
+      bool arrived = visible && fabs(seen.x_middle_coord - VISION_FOV_WIDTH/2) < SIM_ARRIVE_X && seen.width >= BASE_DISTANCE_WIDTH - 2;
+      if(arrived || episodeTime >= SIM_EPISODE_TIMEOUT)
+      {
+        (*episodes)++;
+        if(arrived)
+        {
+          (*arrivals)++;
+          *arrivalTime += episodeTime;
+        }
+        place();
+      }
+    }
+  }
+}
+
+
+void simBatchThroughput()
+{
+  using Clock = std::chrono::steady_clock;
+
+  SimBatch batch;
+  simBatchReset(batch, SIM_BATCH_ROBOTS, 1);
+  Clock::time_point start = Clock::now();
+  for(int tick = 0; tick < SIM_BATCH_TICKS; tick++)
+  {
+    simBatchStep(batch);
+  }
+  double batchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  long episodes = 0, arrivals = 0;
+  double arrivalTime = 0;
+  start = Clock::now();
+  simScalarApproaches(SIM_BATCH_ROBOTS, SIM_BATCH_TICKS, &episodes, &arrivals, &arrivalTime);
+  double scalarSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // Single threaded, so these are per core
+  printf("%d robots x %.0f simulated seconds, single core\n", SIM_BATCH_ROBOTS, SIM_BATCH_TICKS * SIM_TICK);
+  printf("stepping     episodes  arrived  mean approach (s)  wall (s)  episodes/s/core  robot-ticks/s/core\n");
+  printf("one-by-one   %8ld  %6.1f%%  %17.2f  %8.3f  %15.0f  %18.3g\n", episodes, 100.0 * arrivals / episodes,
+    arrivalTime / arrivals, scalarSeconds, episodes / scalarSeconds, SIM_BATCH_ROBOTS * (double)SIM_BATCH_TICKS / scalarSeconds);
+  printf("batch (SoA)  %8ld  %6.1f%%  %17.2f  %8.3f  %15.0f  %18.3g\n", batch.episodes, 100.0 * batch.arrivals / batch.episodes,
+    batch.arrivalTime / batch.arrivals, batchSeconds, batch.episodes / batchSeconds, SIM_BATCH_ROBOTS * (double)SIM_BATCH_TICKS / batchSeconds);
+}
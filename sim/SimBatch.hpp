@@ -0,0 +1,66 @@
+#ifndef _SIM_BATCH_HPP_
+#define _SIM_BATCH_HPP_
+
+#include "SimWorld.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverRange.hpp"
+#include "Driver/DriverContact.hpp"
+#include "Driver/DriverPickup.hpp"
+#include <vector>
+
+// Many robots stepped together, one array per quantity (struct of arrays) so every step is a
+// straight loop the compiler vectorises. Uses the same dynamics as SimWorld (except the arm
+// backlash, which nothing here measures) and the Batch versions of the controllers in DriverControlLaws.
+// What the assists track goes one robot at a time (simAssistStep), since the estimates have branches all through
+// them: the TargetEstimate coasting through dropouts, the range from vision and an ultrasonic as the forward PID's
+// reading, contactBrake and the confidence as its limits, and DriverPickup for the arm. Everything they're tuned
+// with comes from the batch's ControlGains, so the tuner scores all of it.
+
+#define SIM_TICK 0.01 // Seconds per control tick, like the 10ms delay in the robot tasks
+#define SIM_EPISODE_TIMEOUT 8.0 // Seconds before an approach counts as failed
+
+struct SimAssist // One robot's driverBaseTurn, driverBaseForward and driverArmPickup, and what they keep between ticks
+{
+  TargetEstimate target;
+  RangeEstimate range;
+  ContactEstimate contact;
+  PidController forwardPid;
+  PickupPlan pickup;
+};
+
+struct SimBatch
+{
+  int count;
+  ControlGains gains; // What the controllers run with, controlGains unless the tuner is trying something
+
+  // Drivetrain
+  std::vector<float> x, y, heading;
+  std::vector<float> leftSpeed, rightSpeed, strafeSpeed;
+
+  // Arm
+  std::vector<float> armAngle, armSpeed;
+
+  // Vision, refreshed every other tick. seen is 1 or 0 so it can be used in maths
+  std::vector<float> ballX, ballY;
+  std::vector<float> seen, imageX, imageY, width, droppingOut;
+
+  std::vector<SimAssist> assist;
+  std::vector<float> aimed, aimX, confidence; // From simAssistStep, for the batched turn. aimed is 1 or 0
+
+  std::vector<float> episodeTime; // Seconds into the current approach
+  std::vector<uint32_t> random; // xorshift state per robot
+
+  std::vector<float> scratchA, scratchB, scratchC, scratchD, scratchE, scratchF;
+
+  int ticks;
+  long episodes;
+  long arrivals;
+  double arrivalTime; // Summed over arrivals
+  double armError; // Degrees the arm is off the ball's grab angle when the base gets there, summed over arrivals
+};
+
+void simBatchReset(SimBatch& batch, int count, uint32_t seed);
+void simBatchStep(SimBatch& batch);
+
+#endif // _SIM_BATCH_HPP_
@@ -0,0 +1,135 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverFlightRecorder.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// A few minutes of the vision assist going after ball after ball with everything going into the recorder at the
+// rate the robot would: each vision frame, the control output and all four motors every tick. The sensor drops
+// out like it does in the other scenarios, and now and then a motor reports a fault or a tick runs long. Each
+// time it freezes the snapshot is checked like the dump task would see it: in order, with the trigger in it,
+// and how far back it goes. Then what an entry costs, against formatting the same thing as a log line.
+
+#define SIM_BLACKBOX_TICK 10 // ms
+#define SIM_BLACKBOX_SECONDS 300
+#define SIM_BLACKBOX_BALL_EVERY 6000 // ms before a new ball gets put down
+#define SIM_BLACKBOX_FAULT_CHANCE 0.0002 // Per motor per tick
+#define SIM_BLACKBOX_LATE_CHANCE 0.0002 // Per tick, a wake SIM_BLACKBOX_LATE after it should have been
+#define SIM_BLACKBOX_LATE 8 // ms
+#define SIM_BLACKBOX_BENCH 1000000
+
+float simBlackBoxSink;
+
+void simBlackBox()
+{
+  static FlightRecorder recorder;
+  recorderReset(recorder, recorderDefaultTriggers);
+  SimWorld world;
+  simReset(world, 1);
+  std::uniform_real_distribution<float> chance(0, 1);
+  std::uniform_real_distribution<float> range(30, 90);
+  std::uniform_real_distribution<float> bearing(-0.4, 0.4);
+
+  const char* reasons[] = {"lost track", "motor fault", "late task", "manual"};
+  int dumps[4] = {};
+  double before[4] = {}, after[4] = {};
+  float shortest = 1e9;
+  int outOfOrder = 0, missingTrigger = 0;
+  long entries = 0;
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+
+  uint32_t now = 0;
+  uint32_t tick = 0;
+  uint32_t nextBall = 0;
+  while(now < SIM_BLACKBOX_SECONDS * 1000)
+  {
+    if(now >= nextBall) // A new ball somewhere in front
+    {
+      float distance = range(world.random), angle = bearing(world.random) + world.pose.heading;
+      world.ballX = world.pose.x + distance * cos(angle);
+      world.ballY = world.pose.y + distance * sin(angle);
+      nextBall = now + SIM_BLACKBOX_BALL_EVERY;
+    }
+    if(tick % 2 == 0)
+    {
+      seen = simSee(world, 2);
+      recorderVision(recorder, now, seen, seen.signature != VISION_OBJECT_ERR_SIG);
+    }
+    bool visible = seen.signature != VISION_OBJECT_ERR_SIG;
+    float turn = visionTurnPower(visible, seen.x_middle_coord);
+    float forward = -visionForwardPower(visible, seen.width);
+    recorderControl(recorder, now, 1, turn, forward, 0);
+    float commands[4] = {turn - forward, -turn - forward, 0, 0};
+    float speeds[4] = {world.leftSpeed, world.rightSpeed, world.strafeSpeed, 0};
+    for(int motor = 0; motor < 4; motor++)
+    {
+      uint32_t faults = chance(world.random) < SIM_BLACKBOX_FAULT_CHANCE ? 0x02 : 0;
+      float rpm = speeds[motor] / (BASE_WHEEL_DIAMETER * M_PI) * 60;
+      recorderMotor(recorder, now, motor, lroundf(commands[motor]), rpm, fabs(commands[motor]) * 15, fabs(commands[motor]) * 0.05, faults);
+    }
+    simDrive(world, commands[0], commands[1], 0, SIM_BLACKBOX_TICK / 1000.0);
+    tick++;
+    now = tick * SIM_BLACKBOX_TICK;
+    if(chance(world.random) < SIM_BLACKBOX_LATE_CHANCE) // Something ran long, so this wake is late
+    {
+      now += SIM_BLACKBOX_LATE;
+      recorderDeadline(recorder, now, 0, tick * SIM_BLACKBOX_TICK, SIM_BLACKBOX_TICK);
+    }
+
+    if(recorderFrozen(recorder, now)) // What the dump task does
+    {
+      const RecorderEntry* first;
+      uint32_t count = recorderSnapshot(recorder, &first);
+      bool trigger = false;
+      for(uint32_t i = 0; i < count; i++)
+      {
+        outOfOrder += i > 0 && first[i].time < first[i - 1].time;
+        trigger = trigger || (first[i].kind == RECORD_TRIGGER && first[i].time == recorder.triggerTime);
+      }
+      missingTrigger += !trigger;
+      int reason = recorder.triggerReason;
+      dumps[reason]++;
+      before[reason] += (recorder.triggerTime - first[0].time) / 1000.0;
+      after[reason] += (first[count - 1].time - recorder.triggerTime) / 1000.0;
+      if(count == RECORDER_ENTRIES) // Not the ones before it's filled up
+      {
+        shortest = fmin(shortest, (recorder.triggerTime - first[0].time) / 1000.0);
+      }
+      entries += count;
+      recorderRearm(recorder);
+    }
+  }
+
+  printf("%d s of ball chasing, %zu bytes of recorder (%d entries of %zu bytes)\n", SIM_BLACKBOX_SECONDS, sizeof(FlightRecorder),
+    RECORDER_ENTRIES, sizeof(RecorderEntry));
+  printf("trigger      dumps  seconds before  seconds after\n");
+  for(int reason = 0; reason < 3; reason++)
+  {
+    printf("%-11s  %5d  %14.2f  %13.2f\n", reasons[reason], dumps[reason], dumps[reason] ? before[reason] / dumps[reason] : 0,
+      dumps[reason] ? after[reason] / dumps[reason] : 0);
+  }
+  printf("shortest lead up once full %.2f s, %d entries out of order, %d dumps without their trigger\n", shortest, outOfOrder, missingTrigger);
+
+  // An entry against the log line storageLog would have to format for the same thing
+  recorderReset(recorder, {0, 0, 0});
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < SIM_BLACKBOX_BENCH; i++)
+  {
+    recorderMotor(recorder, i, i & 3, i & 127, i * 0.01f, 800, 2.5f, 0);
+  }
+  std::chrono::duration<double, std::nano> added = std::chrono::steady_clock::now() - start;
+  char line[160];
+  int length = 0;
+  start = std::chrono::steady_clock::now();
+  for(int i = 0; i < SIM_BLACKBOX_BENCH; i++)
+  {
+    length += snprintf(line, sizeof(line), "%lu motor %d: %d, %.1f rpm, %d mA, %.2f W, faults %x", (unsigned long)i, i & 3, i & 127,
+      i * 0.01f, 800, 2.5f, 0u);
+  }
+  std::chrono::duration<double, std::nano> formatted = std::chrono::steady_clock::now() - start;
+  simBlackBoxSink = length + recorder.entries[5].values[1];
+  printf("recorderMotor %.1f ns, the same as a log line %.1f ns (%.0f bytes vs %zu) before it's even been written\n",
+    added.count() / SIM_BLACKBOX_BENCH, formatted.count() / SIM_BLACKBOX_BENCH, (double)length / SIM_BLACKBOX_BENCH, sizeof(RecorderEntry));
+}
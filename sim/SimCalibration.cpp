@@ -0,0 +1,118 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverCameraFit.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The real camera is mounted a bit differently to what cameraModel says (turned, tilted, higher, offset,
+// and a slightly different lens). The robot goes round the calibration stations, the fit runs, and then
+// balls are placed around the field to see how well each model puts them where they really are
+
+#define SIM_CALIBRATION_FRAMES 10 // Frames averaged at each station
+#define SIM_CALIBRATION_TRIALS 20
+#define SIM_CALIBRATION_TESTS 200
+
+struct SimCalibrationError
+{
+  double position; // Inches between where the model puts the ball and where it is, squared
+  double bearing; // Radians, squared
+  double aim; // Pixels the turn assist's centre is off straight ahead, squared, once per trial
+};
+
+void simCalibrationTest(SimWorld& world, const CameraModel& model, SimCalibrationError& error)
+{
+  std::uniform_real_distribution<float> range(20, 70);
+  std::uniform_real_distribution<float> bearing(-0.4, 0.4);
+  world.pose = {0, 0, 0};
+  for(int test = 0; test < SIM_CALIBRATION_TESTS; test++)
+  {
+    float distance = range(world.random);
+    float angle = bearing(world.random);
+    world.ballX = distance * cos(angle);
+    world.ballY = distance * sin(angle);
+
+    float imageX, imageY, width, fieldX, fieldY;
+    if(!simTruth(world, &imageX, &imageY, &width) || !imageToField(model, world.pose, imageX, width, &fieldX, &fieldY))
+    {
+      continue;
+    }
+    error.position += (fieldX - world.ballX) * (fieldX - world.ballX) + (fieldY - world.ballY) * (fieldY - world.ballY);
+    float bearingError = atan2(fieldY, fieldX) - angle;
+    error.bearing += bearingError * bearingError;
+  }
+  float aimError = cameraAimX(model) - cameraAimX(world.camera);
+  error.aim += aimError * aimError;
+}
+
+
+void simCalibration()
+{
+  SimCalibrationError before = {};
+  SimCalibrationError after = {};
+  int fitted = 0;
+  float rmsBefore = 0, rmsAfter = 0;
+
+  for(uint32_t trial = 1; trial <= SIM_CALIBRATION_TRIALS; trial++)
+  {
+    SimWorld world;
+    simReset(world, trial);
+    std::normal_distribution<float> mounting(0, 1);
+    world.camera.focalLength *= 1 + 0.04 * mounting(world.random);
+    world.camera.mountForward += 0.5 * mounting(world.random);
+    world.camera.mountLeft += 0.75 * mounting(world.random);
+    world.camera.mountYaw += 0.05 * mounting(world.random);
+    world.camera.mountHeight += 0.75 * mounting(world.random);
+    world.camera.mountPitch += 0.05 * mounting(world.random);
+
+    // Go round the stations. The robot ends up a little off where odometry thinks it is
+    std::normal_distribution<float> placement(0, 0.3);
+    std::normal_distribution<float> turning(0, 0.01);
+    CalibrationSample samples[32];
+    int count = 0;
+    for(int station = 0; station < calibrationStationCount() && count < 32; station++)
+    {
+      RobotPose odometry = calibrationStation(station);
+      world.ballX = CALIBRATION_BALL_DISTANCE;
+      world.ballY = 0;
+      world.pose = {odometry.x + placement(world.random), odometry.y + placement(world.random), odometry.heading + turning(world.random)};
+
+      CalibrationSample sample = {odometry, CALIBRATION_BALL_DISTANCE, 0, 0, 0, 0};
+      int frames = 0;
+      for(int frame = 0; frame < SIM_CALIBRATION_FRAMES; frame++)
+      {
+        pros::c::vision_object_s_t seen = simSee(world, 2);
+        if(seen.signature != VISION_OBJECT_ERR_SIG)
+        {
+          sample.imageX += seen.x_middle_coord;
+          sample.imageY += seen.y_middle_coord;
+          sample.width += seen.width;
+          frames++;
+        }
+      }
+      if(frames > 0)
+      {
+        sample.imageX /= frames;
+        sample.imageY /= frames;
+        sample.width /= frames;
+        samples[count++] = sample;
+      }
+    }
+
+    CameraModel model = cameraModel;
+    float trialBefore, trialAfter;
+    if(calibrationFit(model, samples, count, &trialBefore, &trialAfter))
+    {
+      fitted++;
+      rmsBefore += trialBefore;
+      rmsAfter += trialAfter;
+    }
+    simCalibrationTest(world, cameraModel, before);
+    simCalibrationTest(world, model, after);
+  }
+
+  int tests = SIM_CALIBRATION_TRIALS * SIM_CALIBRATION_TESTS;
+  printf("%d of %d fits worked, station residual %.2f px -> %.2f px\n", fitted, SIM_CALIBRATION_TRIALS,
+    rmsBefore / fitted, rmsAfter / fitted);
+  printf("camera model   ball position RMS (in)  bearing RMS (deg)  aim RMS (px)\n");
+  printf("hand-tuned     %22.2f  %17.2f  %12.2f\n", sqrt(before.position / tests), sqrt(before.bearing / tests) * 180 / M_PI, sqrt(before.aim / SIM_CALIBRATION_TRIALS));
+  printf("calibrated     %22.2f  %17.2f  %12.2f\n", sqrt(after.position / tests), sqrt(after.bearing / tests) * 180 / M_PI, sqrt(after.aim / SIM_CALIBRATION_TRIALS));
+}
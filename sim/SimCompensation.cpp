@@ -0,0 +1,197 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Small corrections with and without DriverCompensation, on motors with a deadband and (on the arm) backlash.
+//  arm  - P on the fused arm angle towards targets a few degrees away, like the small vision corrections
+//  base - the turn assist lining up on a ball that's only a little off centre
+// The compensation keeps learning across episodes like it would over a match, and the first few are warm up
+
+#define SIM_COMP_TICK 0.01
+#define SIM_COMP_EPISODES 400
+#define SIM_COMP_WARMUP 40 // Episodes not counted while the deadband and backlash are learnt
+#define SIM_COMP_EPISODE_TICKS 300 // 3 seconds to settle
+#define SIM_ARM_SETTLED (1 * M_PI / 180) // Within a degree of the target
+#define SIM_BASE_SETTLED 4 // Pixels from centre
+#define SIM_BALL_SIG 2
+
+struct SimSettleStats
+{
+  int episodes;
+  int settled;
+  double settleTime; // Summed over settled episodes
+  double finalError;
+  long reversals; // Command direction changes, which is the hunting
+};
+
+
+void simArmSettling(bool compensated, SimSettleStats& stats)
+{
+  SimWorld world;
+  simReset(world, 7);
+  ArmEstimate estimate = {};
+  MotorCompensation compensation = {};
+  float armTravel = 0;
+  float lastEncoder = 0;
+  float lastPower = 0;
+
+  std::uniform_real_distribution<float> step(2 * M_PI / 180, 12 * M_PI / 180);
+  std::uniform_int_distribution<int> side(0, 1);
+
+  for(int episode = 0; episode < SIM_COMP_EPISODES; episode++)
+  {
+    float target = estimate.angle + (side(world.random) ? 1 : -1) * step(world.random);
+    target = fmin(fmax(target, 20 * M_PI / 180), 250 * M_PI / 180);
+
+    int lastUnsettled = 0;
+    long reversals = 0;
+    for(int tick = 1; tick <= SIM_COMP_EPISODE_TICKS; tick++)
+    {
+      float pot = simArmPot(world) * ARM_RADIANS_PER_POT_COUNT;
+      float encoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+      armTravel += compensationObserve(compensation, encoder - lastEncoder, SIM_COMP_TICK);
+      lastEncoder = encoder;
+      armEstimateUpdate(estimate, pot, compensated ? armTravel : encoder, SIM_COMP_TICK);
+      compensationLearnBacklash(compensation, encoder, pot, estimate.velocity);
+
+      float power = armPower((target - estimate.angle) * 180 / M_PI); // Degrees of error, like the pixels of the vision error
+      if(compensated)
+      {
+        power = compensationCommand(compensation, power);
+      }
+      compensation.lastCommand = power;
+      simDriveArm(world, power, SIM_COMP_TICK);
+
+      if(power * lastPower < 0)
+      {
+        reversals++;
+      }
+      lastPower = power != 0 ? power : lastPower;
+      if(fabs(world.armAngle - target) > SIM_ARM_SETTLED)
+      {
+        lastUnsettled = tick;
+      }
+    }
+
+    if(episode >= SIM_COMP_WARMUP)
+    {
+      stats.episodes++;
+      stats.reversals += reversals;
+      stats.finalError += fabs(world.armAngle - target) * 180 / M_PI;
+      if(lastUnsettled < SIM_COMP_EPISODE_TICKS)
+      {
+        stats.settled++;
+        stats.settleTime += lastUnsettled * SIM_COMP_TICK;
+      }
+    }
+  }
+
+  if(compensated)
+  {
+    printf("arm learnt deadband %.1f (really %d), backlash %.2f deg (really %.2f)\n", compensation.deadband, SIM_ARM_DEADBAND,
+      compensation.backlash * 180 / M_PI, SIM_ARM_BACKLASH * 180 / M_PI);
+  }
+}
+
+
+void simBaseSettling(bool compensated, SimSettleStats& stats)
+{
+  SimWorld world;
+  simReset(world, 11);
+  MotorCompensation leftCompensation = {};
+  MotorCompensation rightCompensation = {};
+  leftCompensation.holdPower = rightCompensation.holdPower = COMPENSATION_HOLD_POWER; // Like driverBaseControl
+  pros::c::vision_object_s_t seen = {};
+  float lastTurn = 0;
+
+  std::uniform_real_distribution<float> offset(0.03, 0.2); // Radians the ball is off to one side
+  std::uniform_int_distribution<int> side(0, 1);
+
+  for(int episode = 0; episode < SIM_COMP_EPISODES; episode++)
+  {
+    // Put the ball a little to one side of wherever the robot is pointing now
+    float bearing = world.pose.heading + (side(world.random) ? 1 : -1) * offset(world.random);
+    world.ballX = world.pose.x + 48 * cos(bearing);
+    world.ballY = world.pose.y + 48 * sin(bearing);
+
+    int lastUnsettled = 0;
+    long reversals = 0;
+    float imageX, imageY, width;
+    for(int tick = 1; tick <= SIM_COMP_EPISODE_TICKS; tick++)
+    {
+      if(tick % 2 == 0) // Vision only has a new frame every 20ms
+      {
+        seen = simSee(world, SIM_BALL_SIG);
+      }
+      float turn = visionTurnPower(seen.signature != VISION_OBJECT_ERR_SIG, seen.x_middle_coord);
+
+      float left = turn;
+      float right = -turn;
+      if(compensated)
+      {
+        left = compensationCommand(leftCompensation, left);
+        right = compensationCommand(rightCompensation, right);
+      }
+      leftCompensation.lastCommand = left;
+      rightCompensation.lastCommand = right;
+      simDrive(world, left, right, 0, SIM_COMP_TICK);
+      compensationObserve(leftCompensation, world.leftSpeed * SIM_COMP_TICK / (BASE_WHEEL_DIAMETER / 2), SIM_COMP_TICK);
+      compensationObserve(rightCompensation, world.rightSpeed * SIM_COMP_TICK / (BASE_WHEEL_DIAMETER / 2), SIM_COMP_TICK);
+
+      if(left * lastTurn < 0) // What the motors were actually sent, like the arm
+      {
+        reversals++;
+      }
+      lastTurn = left != 0 ? left : lastTurn;
+      if(!simTruth(world, &imageX, &imageY, &width) || fabs(imageX - VISION_FOV_WIDTH/2) > SIM_BASE_SETTLED)
+      {
+        lastUnsettled = tick;
+      }
+    }
+
+    if(episode >= SIM_COMP_WARMUP)
+    {
+      stats.episodes++;
+      stats.reversals += reversals;
+      stats.finalError += fabs(imageX - VISION_FOV_WIDTH/2);
+      if(lastUnsettled < SIM_COMP_EPISODE_TICKS)
+      {
+        stats.settled++;
+        stats.settleTime += lastUnsettled * SIM_COMP_TICK;
+      }
+    }
+  }
+
+  if(compensated)
+  {
+    printf("base learnt deadband %.1f / %.1f (really %d)\n", leftCompensation.deadband, rightCompensation.deadband, SIM_BASE_DEADBAND);
+  }
+}
+
+
+void simCompensation()
+{
+  SimSettleStats stats[2][2] = {};
+  for(int compensated = 0; compensated < 2; compensated++)
+  {
+    simArmSettling(compensated, stats[0][compensated]);
+    simBaseSettling(compensated, stats[1][compensated]);
+  }
+
+  const char* names[2] = {"arm", "base"};
+  const char* units[2] = {"deg", "px"};
+  printf("motor  compensated  settled  mean settle (s)  final error  reversals/episode\n");
+  for(int motor = 0; motor < 2; motor++)
+  {
+    for(int compensated = 0; compensated < 2; compensated++)
+    {
+      SimSettleStats& s = stats[motor][compensated];
+      printf("%-5s  %-11s  %6.1f%%  %15.2f  %8.2f %-3s  %17.2f\n", names[motor], compensated ? "yes" : "no",
+        100.0 * s.settled / s.episodes, s.settled ? s.settleTime / s.settled : 0.0, s.finalError / s.episodes, units[motor],
+        (double)s.reversals / s.episodes);
+    }
+  }
+}
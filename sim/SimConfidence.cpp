@@ -0,0 +1,127 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The turn and forward assists on the tracked ball, following the estimate through dropouts like
+// calculateTarget, with the power at full strength or scaled by targetConfidence. Three sensors:
+//  clean   - SimWorld's, as every other scenario has it
+//  flicker - a third of the frames lost on top of that, one here and one there
+//  ghosts  - one frame in ten is something else ball coloured, somewhere else in the picture
+// Ghost effort is the mean turn power sent while the target was a ghost, or the estimate it dragged off.
+// Jitter is the mean change in turn power from one tick to the next.
+
+#define SIM_CONFIDENCE_TRIALS 300
+#define SIM_CONFIDENCE_TIMEOUT 10.0 // Seconds to reach the ball
+#define SIM_CONFIDENCE_FLICKER 0.33 // Chance a frame is lost, on top of SimWorld's dropouts
+#define SIM_CONFIDENCE_GHOSTS 0.1 // Chance a frame is a ghost
+#define SIM_CONFIDENCE_SIG 2
+#define SIM_ARRIVE_X 10 // Pixels from the aim that count as lined up, same as SimBatch
+#define SIM_ARRIVE_WIDTH 5 // Pixels short of BASE_DISTANCE_WIDTH that count as there, the forward P stalls in the deadband short of 2
+
+enum SimConfidenceSensor { SENSOR_CLEAN, SENSOR_FLICKER, SENSOR_GHOSTS, SENSOR_COUNT };
+
+struct SimConfidenceStats
+{
+  int arrived;
+  double arrivalTime;
+  double ghostEffort;
+  long ghostTicks;
+  double jitter;
+  long ticks;
+};
+
+static void simConfidenceTrial(int sensor, float gain, bool confidence, uint32_t seed, SimConfidenceStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> unit(0, 1);
+  float distance = 30 + 60 * unit(world.random);
+  float angle = 0.6 * (unit(world.random) - 0.5f);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+
+  ControlGains gains = controlGains;
+  controlGains.turnP *= gain;
+  controlGains.forwardP *= gain;
+  TargetEstimate estimate = {};
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+  bool ghost = false; // The estimate's following a ghost, until the real ball takes it back
+  float lastTurn = 0;
+  for(int tick = 0; tick * 0.01 < SIM_CONFIDENCE_TIMEOUT; tick++)
+  {
+    if(tick % 2 == 0) // 50Hz sensor
+    {
+      seen = simSee(world, SIM_CONFIDENCE_SIG);
+      if(sensor == SENSOR_FLICKER && unit(world.random) < SIM_CONFIDENCE_FLICKER)
+      {
+        seen.signature = VISION_OBJECT_ERR_SIG;
+      }
+      bool ghostFrame = sensor == SENSOR_GHOSTS && unit(world.random) < SIM_CONFIDENCE_GHOSTS;
+      if(ghostFrame)
+      {
+        seen.signature = SIM_CONFIDENCE_SIG;
+        seen.x_middle_coord = lround(VISION_FOV_WIDTH * unit(world.random));
+        seen.y_middle_coord = lround(VISION_FOV_HEIGHT * unit(world.random));
+        seen.width = seen.height = lround(5 + 35 * unit(world.random));
+      }
+      if(seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        ghost = ghostFrame;
+      }
+      targetEstimateUpdate(estimate, world.odometry, seen, world.time, controlGains);
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, world.time, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+    float scale = confidence ? targetConfidence(estimate, world.time) : 1;
+    float turn = visionTurnPower(visible, target.x_middle_coord) * scale;
+    float forward = visionForwardPower(visible, target.width) * scale;
+    simDrive(world, turn - forward, -turn - forward, 0, 0.01);
+
+    if(ghost && visible)
+    {
+      stats.ghostEffort += fabs(turn);
+      stats.ghostTicks++;
+    }
+    stats.jitter += fabs(turn - lastTurn);
+    stats.ticks++;
+    lastTurn = turn;
+
+    float imageX, imageY, width;
+    if(simTruth(world, &imageX, &imageY, &width) && fabs(imageX - visionAimX) < SIM_ARRIVE_X && width >= BASE_DISTANCE_WIDTH - SIM_ARRIVE_WIDTH)
+    {
+      stats.arrived++;
+      stats.arrivalTime += tick * 0.01;
+      break;
+    }
+  }
+  controlGains = gains;
+}
+
+void simConfidence()
+{
+  const char* sensors[SENSOR_COUNT] = {"clean", "flicker", "ghosts"};
+  struct { float gain; bool confidence; const char* name; } ways[] = {{1, false, "x1"}, {2, false, "x2"}, {2, true, "x2 * confidence"}};
+  printf("%d trials per row, ball 30-90 in out, %.0f s to reach it\n", SIM_CONFIDENCE_TRIALS, SIM_CONFIDENCE_TIMEOUT);
+  printf("sensor   gains            reached ball  mean time (s)  ghost effort  jitter\n");
+  for(int sensor = 0; sensor < SENSOR_COUNT; sensor++)
+  {
+    for(auto& way : ways)
+    {
+      SimConfidenceStats stats = {};
+      for(int trial = 0; trial < SIM_CONFIDENCE_TRIALS; trial++)
+      {
+        simConfidenceTrial(sensor, way.gain, way.confidence, trial + 1, stats);
+      }
+      printf("%-7s  %-15s  %11.1f%%  %13.2f  %12.1f  %6.2f\n", sensors[sensor], way.name, 100.0 * stats.arrived / SIM_CONFIDENCE_TRIALS,
+        stats.arrived ? stats.arrivalTime / stats.arrived : 0, stats.ghostTicks ? stats.ghostEffort / stats.ghostTicks : 0,
+        stats.jitter / stats.ticks);
+    }
+  }
+}
@@ -0,0 +1,175 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include "Driver/DriverContact.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The forward assist coming in from a long way out, like the pid scenario:
+//  PID+AW       - driverBaseForward as it was
+//  PID+AW+tau   - the same, with contactBrake as the PID's outputMax, easing off as the time to the grab width runs out
+//  fast         - the forward P doubled
+//  fast+tau     - doubled, and braked
+// and, for the arm, how far off the final ball y its target is in the last SIM_CONTACT_ARM_LEAD before arriving,
+// aiming at the ball as it is now vs at simContactLeadY
+
+#define SIM_CONTACT_TICK 0.01
+#define SIM_CONTACT_EPISODES 300
+#define SIM_CONTACT_EPISODE_TICKS 800
+#define SIM_CONTACT_SETTLED 3 // Pixels of width
+#define SIM_CONTACT_HIT_WIDTH (BASE_DISTANCE_WIDTH * 1.25) // Wider than this and we've pushed into the ball
+#define SIM_CONTACT_FAST 2.0
+#define SIM_BALL_SIG 2
+#define SIM_CONTACT_ARM_LEAD 0.5 // Seconds out from the grab width that the arm starts aiming where the ball will be
+
+enum SimContactController { CONTACT_PID, CONTACT_PID_TAU, CONTACT_FAST, CONTACT_FAST_TAU, CONTACT_CONTROLLERS };
+const char* simContactNames[CONTACT_CONTROLLERS] = {"PID+AW", "PID+AW+tau", "fast", "fast+tau"};
+
+static float simContactLeadY(const ContactEstimate& estimate, uint32_t now, float width, float yMiddle, float targetWidth)
+// Where the ball will be in the image (y) when it's targetWidth wide, once that's less than SIM_CONTACT_ARM_LEAD away.
+// The arm is slower than the base, so it would want to be heading there before we arrive
+{
+  if(!contactValid(estimate, now))
+  {
+    return yMiddle;
+  }
+  float time = contactTimeTo(estimate, width, targetWidth);
+  if(time >= SIM_CONTACT_ARM_LEAD || time <= 0)
+  {
+    return yMiddle;
+  }
+  return yMiddle + estimate.yRate * time;
+}
+
+struct SimContactStats
+{
+  int settled;
+  double settleTime;
+  double arrivalTime; // First time within SIM_CONTACT_SETTLED
+  int arrived;
+  int hits;
+  double overshoot;
+  double armNow; // Pixels between the arm's target and the ball's final y, over the lead window
+  double armLead;
+  long armTicks;
+};
+
+void simContactEpisode(SimContactController controller, uint32_t seed, SimContactStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.15, 0.15);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+
+  PidGains gains = forwardPidGains(controlGains);
+  if(controller == CONTACT_FAST || controller == CONTACT_FAST_TAU)
+  {
+    gains.kP *= SIM_CONTACT_FAST;
+  }
+  PidController pid = {gains, BASE_DISTANCE_WIDTH};
+  TargetEstimate estimate = {};
+  ContactEstimate contact = {};
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+
+  float armNow[SIM_CONTACT_EPISODE_TICKS], armLead[SIM_CONTACT_EPISODE_TICKS]; // The two arm targets, every tick
+  int arrivedTick = -1;
+  float overshoot = 0;
+  bool hit = false;
+  int lastUnsettled = 0;
+  float imageX, imageY, width = 0;
+  float arrivedY = 0;
+  for(int tick = 1; tick <= SIM_CONTACT_EPISODE_TICKS; tick++)
+  {
+    if(tick % 2 == 0)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      targetEstimateUpdate(estimate, world.odometry, seen, world.time, controlGains);
+      if(seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        contactUpdate(contact, seen.width, seen.y_middle_coord, world.time);
+      }
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, world.time, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+
+    float turn = visionTurnPower(visible, target.x_middle_coord);
+    if(controller == CONTACT_PID_TAU || controller == CONTACT_FAST_TAU)
+    {
+      pid.gains.outputMax = contactBrake(contact, world.time, target.width, BASE_DISTANCE_WIDTH, gains.outputMax, controlGains);
+    }
+    float forward = visible ? pidStep(pid, target.width, SIM_CONTACT_TICK) : 0;
+    simDrive(world, turn + forward, -turn + forward, 0, SIM_CONTACT_TICK);
+    armNow[tick - 1] = target.y_middle_coord;
+    armLead[tick - 1] = simContactLeadY(contact, world.time, target.width, target.y_middle_coord, BASE_DISTANCE_WIDTH);
+
+    if(simTruth(world, &imageX, &imageY, &width))
+    {
+      overshoot = fmax(overshoot, width - BASE_DISTANCE_WIDTH);
+      hit = hit || width > SIM_CONTACT_HIT_WIDTH;
+    }
+    if(fabs(width - BASE_DISTANCE_WIDTH) > SIM_CONTACT_SETTLED)
+    {
+      lastUnsettled = tick;
+    }
+    else if(arrivedTick < 0)
+    {
+      arrivedTick = tick;
+      arrivedY = imageY;
+    }
+  }
+
+  stats.overshoot += overshoot;
+  stats.hits += hit;
+  if(lastUnsettled < SIM_CONTACT_EPISODE_TICKS)
+  {
+    stats.settled++;
+    stats.settleTime += lastUnsettled * SIM_CONTACT_TICK;
+  }
+  if(arrivedTick > 0)
+  {
+    stats.arrived++;
+    stats.arrivalTime += arrivedTick * SIM_CONTACT_TICK;
+    int leadTicks = lround(SIM_CONTACT_ARM_LEAD / SIM_CONTACT_TICK);
+    for(int tick = std::max(0, arrivedTick - leadTicks); tick < arrivedTick; tick++)
+    {
+      stats.armNow += fabs(armNow[tick] - arrivedY);
+      stats.armLead += fabs(armLead[tick] - arrivedY);
+      stats.armTicks++;
+    }
+  }
+}
+
+
+void simContact()
+{
+  printf("controller  arrive (s)  settled  settle (s)  overshoot (px)  hit the ball\n");
+  SimContactStats arm = {};
+  for(int controller = 0; controller < CONTACT_CONTROLLERS; controller++)
+  {
+    SimContactStats stats = {};
+    for(uint32_t episode = 1; episode <= SIM_CONTACT_EPISODES; episode++)
+    {
+      simContactEpisode((SimContactController)controller, episode, stats);
+    }
+    printf("%-10s  %10.2f  %6.1f%%  %10.2f  %14.2f  %11.1f%%\n", simContactNames[controller],
+      stats.arrived ? stats.arrivalTime / stats.arrived : 0.0, 100.0 * stats.settled / SIM_CONTACT_EPISODES,
+      stats.settled ? stats.settleTime / stats.settled : 0.0, stats.overshoot / SIM_CONTACT_EPISODES, 100.0 * stats.hits / SIM_CONTACT_EPISODES);
+    if(controller == CONTACT_PID_TAU)
+    {
+      arm = stats;
+    }
+  }
+  printf("arm target in the last %.1f s before arriving (PID+AW+tau), pixels from the ball's y on arrival:\n", SIM_CONTACT_ARM_LEAD);
+  printf("  ball as it is now    %.2f\n", arm.armNow / arm.armTicks);
+  printf("  simContactLeadY      %.2f\n", arm.armLead / arm.armTicks);
+}
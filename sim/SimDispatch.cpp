@@ -0,0 +1,195 @@
+#include "Driver/DriverPid.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// What okapi's style of controller costs against ours. okapi steps every controller through a virtual
+// IterativeController::step, usually held in a shared_ptr, so the compiler can never inline the maths.
+// The same PID is timed four ways on the same readings:
+//  - okapi style: virtual step through shared_ptr<base>
+//  - final: the same class marked final and held by value, so the step inlines into the loop
+//  - pidStep: our plain function, a direct call into DriverPid.cpp
+//  - pidStepBatch: all of them in one loop, inlined and vectorised
+// Set up so the dispatch is all there is to time: few enough controllers and readings to stay in L1, and each
+// output stored rather than summed (a running float sum is a 4 cycle chain every step, which hid everything).
+// Best of a few runs, since the host is shared.
+
+#define SIM_DISPATCH_CONTROLLERS 256
+#define SIM_DISPATCH_ROWS 16 // Rows of readings, cycled through
+#define SIM_DISPATCH_STEPS 20000
+#define SIM_DISPATCH_RUNS 5
+#define SIM_DISPATCH_DT 0.01
+
+float simDispatchSink;
+
+class SimIterativeController // Shaped like okapi::IterativeController<double, double>
+{
+  public:
+  virtual ~SimIterativeController() = default;
+  virtual float step(float reading) = 0;
+};
+
+static inline float simDispatchStep(PidController& pid, float reading) // pidStep, inlined
+{
+  pid.error = pid.target - reading;
+  pid.output = pidUpdate(pid.gains, pid.target, reading, SIM_DISPATCH_DT, pid.started, pid.integral, pid.derivative, pid.lastReading);
+  pid.started = true;
+  return pid.output;
+}
+
+class SimVirtualPid : public SimIterativeController
+{
+  public:
+  SimVirtualPid(const PidGains& gains, float target)
+  {
+    pid = {gains, target};
+    pidReset(pid);
+  }
+  float step(float reading) override
+  {
+    return simDispatchStep(pid, reading);
+  }
+  PidController pid;
+};
+
+class SimFinalPid final : public SimIterativeController
+{
+  public:
+  SimFinalPid(const PidGains& gains, float target)
+  {
+    pid = {gains, target};
+    pidReset(pid);
+  }
+  float step(float reading) override
+  {
+    return simDispatchStep(pid, reading);
+  }
+  PidController pid;
+};
+
+static void pidStepBatch(const PidGains& gains, const float* __restrict target, const float* __restrict reading, float* __restrict started,
+  float* __restrict integral, float* __restrict derivative, float* __restrict lastReading, float* __restrict output, int count, float dt)
+// A whole array of DriverPid controllers with the same gains, one array per quantity and started 1 or 0
+{
+  const PidGains copy = gains; // So the compiler knows writing the arrays can't change the gains
+  for(int i = 0; i < count; i++)
+  {
+    output[i] = pidUpdate(copy, target[i], reading[i], dt, started[i] != 0, integral[i], derivative[i], lastReading[i]);
+    started[i] = 1;
+  }
+}
+
+static float simDispatchReading(int controller, int row) // A width that wanders about near the target
+{
+  return BASE_DISTANCE_WIDTH - 20 + (controller * 7 + row * 3) % 41;
+}
+
+template <typename Run>
+static double simDispatchTime(Run run) // Seconds for the fastest of SIM_DISPATCH_RUNS
+{
+  using Clock = std::chrono::steady_clock;
+  double best = 1e9;
+  for(int r = 0; r < SIM_DISPATCH_RUNS; r++)
+  {
+    Clock::time_point start = Clock::now();
+    run();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    best = seconds < best ? seconds : best;
+  }
+  return best;
+}
+
+void simDispatch()
+{
+  const int n = SIM_DISPATCH_CONTROLLERS;
+  PidGains gains = forwardPidGains(controlGains);
+
+  static float readings[SIM_DISPATCH_ROWS][SIM_DISPATCH_CONTROLLERS];
+  static float outputs[SIM_DISPATCH_CONTROLLERS];
+  for(int row = 0; row < SIM_DISPATCH_ROWS; row++)
+  {
+    for(int i = 0; i < n; i++) readings[row][i] = simDispatchReading(i, row);
+  }
+  auto check = [&]() // Every way should end up with the same outputs
+  {
+    double sum = 0;
+    for(int i = 0; i < n; i++) sum += outputs[i];
+    return sum;
+  };
+
+  double seconds[4];
+  double checks[4];
+
+  // okapi style
+  std::vector<std::shared_ptr<SimIterativeController>> virtualPids;
+  seconds[0] = simDispatchTime([&]()
+  {
+    virtualPids.clear();
+    for(int i = 0; i < n; i++) virtualPids.push_back(std::make_shared<SimVirtualPid>(gains, BASE_DISTANCE_WIDTH));
+    for(int step = 0; step < SIM_DISPATCH_STEPS; step++)
+    {
+      const float* row = readings[step % SIM_DISPATCH_ROWS];
+      for(int i = 0; i < n; i++) outputs[i] = virtualPids[i]->step(row[i]);
+    }
+  });
+  checks[0] = check();
+
+  // final, held by value
+  std::vector<SimFinalPid> finalPids;
+  seconds[1] = simDispatchTime([&]()
+  {
+    finalPids.clear();
+    for(int i = 0; i < n; i++) finalPids.emplace_back(gains, BASE_DISTANCE_WIDTH);
+    for(int step = 0; step < SIM_DISPATCH_STEPS; step++)
+    {
+      const float* row = readings[step % SIM_DISPATCH_ROWS];
+      for(int i = 0; i < n; i++) outputs[i] = finalPids[i].step(row[i]);
+    }
+  });
+  checks[1] = check();
+
+  // Plain pidStep
+  std::vector<PidController> pids(n);
+  seconds[2] = simDispatchTime([&]()
+  {
+    for(PidController& pid : pids)
+    {
+      pid = {gains, BASE_DISTANCE_WIDTH};
+      pidReset(pid);
+    }
+    for(int step = 0; step < SIM_DISPATCH_STEPS; step++)
+    {
+      const float* row = readings[step % SIM_DISPATCH_ROWS];
+      for(int i = 0; i < n; i++) outputs[i] = pidStep(pids[i], row[i], SIM_DISPATCH_DT);
+    }
+  });
+  checks[2] = check();
+
+  // Batch
+  std::vector<float> target(n, BASE_DISTANCE_WIDTH), started(n), integral(n), derivative(n), lastReading(n);
+  seconds[3] = simDispatchTime([&]()
+  {
+    std::fill(started.begin(), started.end(), 0);
+    std::fill(integral.begin(), integral.end(), 0);
+    std::fill(derivative.begin(), derivative.end(), 0);
+    for(int step = 0; step < SIM_DISPATCH_STEPS; step++)
+    {
+      pidStepBatch(gains, target.data(), readings[step % SIM_DISPATCH_ROWS], started.data(), integral.data(), derivative.data(),
+        lastReading.data(), outputs, n, SIM_DISPATCH_DT);
+    }
+  });
+  checks[3] = check();
+  simDispatchSink = checks[3];
+
+  const char* names[4] = {"okapi style (virtual, shared_ptr)", "final, held by value", "pidStep", "pidStepBatch"};
+  double steps = (double)n * SIM_DISPATCH_STEPS;
+  printf("%d PIDs x %d steps, single core, best of %d. The output sums should all match\n", n, SIM_DISPATCH_STEPS, SIM_DISPATCH_RUNS);
+  printf("%-34s  ns/step  vs okapi style  output sum\n", "");
+  for(int way = 0; way < 4; way++)
+  {
+    printf("%-34s  %7.2f  %13.1fx  %10.3f\n", names[way], seconds[way] * 1e9 / steps, seconds[0] / seconds[way], checks[way]);
+  }
+}
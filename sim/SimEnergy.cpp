@@ -0,0 +1,164 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include "Driver/DriverContact.hpp"
+#include "Driver/DriverPickup.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include "Driver/DriverArbiter.hpp"
+#include "Driver/DriverEnergy.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Joules per ball for the pickup the robot does now (the same as the pickup scenario), against versions of
+// it that are quicker or slower to get there. The commands go through the arbiter like on the robot, with
+// the driver's sticks centred, and each motor's draw comes from simMotorWatts into DriverEnergy.
+//  as is       - controlGains, the braked forward PID and the predictive arm
+//  turn x3     - turnP tripled, which has the turn flat out on any real error
+//  no brake    - the forward PID without contactBrake, as it was before
+//  late arm    - the arm only setting off once the base is there
+
+#define SIM_ENERGY_TICK 0.01
+#define SIM_ENERGY_BALLS 300
+#define SIM_ENERGY_TIMEOUT 800 // Ticks
+#define SIM_ENERGY_CARRY (90 * M_PI / 180)
+#define SIM_BALL_SIG 2
+
+enum SimEnergyVariant { ENERGY_AS_IS, ENERGY_TURN, ENERGY_NO_BRAKE, ENERGY_LATE_ARM, ENERGY_VARIANTS };
+const char* simEnergyNames[ENERGY_VARIANTS] = {"as is", "turn x3", "no brake", "late arm"};
+
+static bool simEnergyBall(SimEnergyVariant variant, uint32_t seed, EnergyMeter& meter, double* seconds)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.3, 0.3);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+  world.armAngle = world.armMotorAngle = SIM_ENERGY_CARRY;
+
+  ControlGains gains = controlGains;
+  if(variant == ENERGY_TURN)
+  {
+    gains.turnP *= 3;
+  }
+  PidGains forwardGains = forwardPidGains(gains);
+  PidController pid = {forwardGains, BASE_DISTANCE_WIDTH};
+  TargetEstimate estimate = {};
+  ContactEstimate contact = {};
+  PickupPlan plan;
+  pickupReset(plan);
+  ArmEstimate arm = {};
+  MotorCompensation compensation = {};
+  compensation.deadband = SIM_ARM_DEADBAND;
+  compensation.backlash = SIM_ARM_BACKLASH;
+  compensation.slop = -SIM_ARM_BACKLASH / 2;
+  Arbiter arbiter = {};
+  arbiter.compensation[MOTOR_ARM] = &compensation;
+  float lastEncoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+  float armTravel = 0;
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+  float grabAngle = pickupArmAngle(BALL_DIAMETER / 2);
+  float imageX, imageY, width;
+
+  for(int tick = 1; tick <= SIM_ENERGY_TIMEOUT; tick++)
+  {
+    uint32_t now = world.time;
+    if(tick % 2 == 0)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      targetEstimateUpdate(estimate, world.odometry, seen, now, controlGains);
+      if(seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        contactUpdate(contact, seen.width, seen.y_middle_coord, now);
+      }
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, now, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+
+    if(variant != ENERGY_NO_BRAKE)
+    {
+      pid.gains.outputMax = contactBrake(contact, now, target.width, BASE_DISTANCE_WIDTH, forwardGains.outputMax, controlGains);
+    }
+    float turn = visible ? (target.x_middle_coord - visionAimX) * gains.turnP : 0;
+    float forward = visible ? pidStep(pid, target.width, SIM_ENERGY_TICK) : 0;
+
+    float encoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+    armTravel += compensationObserve(compensation, encoder - lastEncoder, SIM_ENERGY_TICK);
+    lastEncoder = encoder;
+    armEstimateUpdate(arm, simArmPot(world) * ARM_RADIANS_PER_POT_COUNT, armTravel, SIM_ENERGY_TICK);
+    bool go;
+    if(variant == ENERGY_LATE_ARM)
+    {
+      go = plan.moving = plan.moving || (visible && pickupArrived(target.width));
+    }
+    else
+    {
+      go = visible && pickupUpdate(plan, cameraModel, contact, now, target.width, target.y_middle_coord, arm.angle, controlGains.armP);
+    }
+
+    // The driver's sticks are centred, the assist adds on top, the same as DriverBaseControl and armP
+    float commands[MOTOR_COUNT] = {turn + forward, -turn + forward, 0, go ? armPower((plan.grabAngle - arm.angle) * 180 / M_PI) : 0};
+    float resolved[MOTOR_COUNT];
+    for(int motor = 0; motor < MOTOR_COUNT; motor++)
+    {
+      arbiterSubmit(arbiter, (ArbiterMotor)motor, SOURCE_DRIVER, MODE_POWER, 0, false, now, ARBITER_TIMEOUT);
+      arbiterSubmit(arbiter, (ArbiterMotor)motor, SOURCE_ASSIST, MODE_POWER, commands[motor], true, now, ARBITER_TIMEOUT);
+      ArbiterMode mode;
+      int32_t value;
+      arbiterResolve(arbiter, (ArbiterMotor)motor, now, &mode, &value);
+      resolved[motor] = arbiter.outputs[motor].value;
+    }
+    compensation.lastCommand = resolved[MOTOR_ARM];
+
+    // Power drawn at the start of the tick's speeds, the same as get_power reporting over the tick
+    float speeds[MOTOR_COUNT] = {world.leftSpeed / (float)SIM_BASE_MAX_SPEED, world.rightSpeed / (float)SIM_BASE_MAX_SPEED,
+      world.strafeSpeed / (float)SIM_BASE_MAX_SPEED, world.armSpeed / (float)SIM_ARM_MAX_SPEED};
+    for(int motor = 0; motor < MOTOR_COUNT; motor++)
+    {
+      energyAdd(meter, (ArbiterMotor)motor, arbiter.outputs[motor].share, simMotorWatts(resolved[motor], speeds[motor]), SIM_ENERGY_TICK); // The command about to run
+    }
+    simDrive(world, resolved[MOTOR_BASE_LEFT], resolved[MOTOR_BASE_RIGHT], resolved[MOTOR_BASE_H], SIM_ENERGY_TICK);
+    simDriveArm(world, resolved[MOTOR_ARM], SIM_ENERGY_TICK);
+
+    simTruth(world, &imageX, &imageY, &width);
+    if(fabs(width - BASE_DISTANCE_WIDTH) <= PICKUP_ARRIVED && fabs(world.armAngle - grabAngle) <= PICKUP_ARM_CLOSE)
+    {
+      energyBall(meter);
+      *seconds += tick * SIM_ENERGY_TICK;
+      return true;
+    }
+  }
+  return false;
+}
+
+void simEnergy()
+{
+  printf("%d pickups from 36-96in, up to 0.3 rad off to the side, arm starting at %.0f deg\n", SIM_ENERGY_BALLS, SIM_ENERGY_CARRY * 180 / M_PI);
+  printf("variant   balls  s/ball  J/ball  base J/ball  arm J/ball  idle J/ball\n");
+  for(int variant = 0; variant < ENERGY_VARIANTS; variant++)
+  {
+    EnergyMeter meter = {};
+    double seconds = 0;
+    for(uint32_t seed = 1; seed <= SIM_ENERGY_BALLS; seed++)
+    {
+      simEnergyBall((SimEnergyVariant)variant, seed, meter, &seconds);
+    }
+    float balls = meter.balls ? meter.balls : 1;
+    float base = 0;
+    for(int motor = MOTOR_BASE_LEFT; motor <= MOTOR_BASE_H; motor++)
+    {
+      base += energyOfMotor(meter, (ArbiterMotor)motor);
+    }
+    printf("%-8s  %5lu  %6.2f  %6.1f  %11.1f  %10.1f  %11.2f\n", simEnergyNames[variant], (unsigned long)meter.balls, seconds / balls,
+      energyPerBall(meter), base / balls, energyOfMotor(meter, MOTOR_ARM) / balls, energyOfSource(meter, ENERGY_IDLE) / balls);
+  }
+}
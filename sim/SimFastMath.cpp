@@ -0,0 +1,135 @@
+#include "Util/FastMath.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Checks the error bounds written in FastMath.hpp against libm, and times each function against its libm version.
+// On a desktop the batch functions are the vectorisable loops, the NEON versions only build for the brain.
+
+#define SIM_MATH_SAMPLES 1000000
+#define SIM_MATH_TIMING_RUNS 20
+
+float simMathSink; // Keeps the optimiser from throwing the timed loops away
+
+template <typename Function>
+double simNanosecondsPerCall(const std::vector<float>& inputs, Function function)
+{
+  auto start = std::chrono::steady_clock::now();
+  float sum = 0;
+  for(int run = 0; run < SIM_MATH_TIMING_RUNS; run++)
+  {
+    for(float x : inputs)
+    {
+      sum += function(x);
+    }
+  }
+  simMathSink = sum;
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (inputs.size() * SIM_MATH_TIMING_RUNS);
+}
+
+std::vector<float> simMathRange(float low, float high)
+{
+  std::vector<float> inputs(SIM_MATH_SAMPLES);
+  for(int i = 0; i < SIM_MATH_SAMPLES; i++)
+  {
+    inputs[i] = low + (high - low) * i / (SIM_MATH_SAMPLES - 1);
+  }
+  return inputs;
+}
+
+void simMathReport(const char* name, double worstError, const char* errorKind, double fastTime = 0, double libmTime = 0)
+{
+  if(fastTime > 0)
+  {
+    printf("%-14s  %10.2e %-8s  %7.2f ns  %7.2f ns  %5.2fx\n", name, worstError, errorKind, fastTime, libmTime, libmTime / fastTime);
+  }
+  else
+  {
+    printf("%-14s  %10.2e %-8s\n", name, worstError, errorKind);
+  }
+}
+
+
+void simFastMath()
+{
+  printf("function        worst error          fast        libm        speedup\n");
+
+  std::vector<float> angles = simMathRange(-1000, 1000);
+  std::vector<float> out(angles.size());
+  double sinError = 0, cosError = 0, sinBatchError = 0, cosBatchError = 0;
+  for(float x : angles)
+  {
+    sinError = fmax(sinError, fabs(fastSin(x) - sin((double)x)));
+    cosError = fmax(cosError, fabs(fastCos(x) - cos((double)x)));
+  }
+  fastSinBatch(angles.data(), out.data(), angles.size());
+  for(size_t i = 0; i < angles.size(); i++)
+  {
+    sinBatchError = fmax(sinBatchError, fabs(out[i] - sin((double)angles[i])));
+  }
+  fastCosBatch(angles.data(), out.data(), angles.size());
+  for(size_t i = 0; i < angles.size(); i++)
+  {
+    cosBatchError = fmax(cosBatchError, fabs(out[i] - cos((double)angles[i])));
+  }
+  simMathReport("fastSin", sinError, "abs", simNanosecondsPerCall(angles, fastSin), simNanosecondsPerCall(angles, sinf));
+  simMathReport("fastCos", cosError, "abs", simNanosecondsPerCall(angles, fastCos), simNanosecondsPerCall(angles, cosf));
+  simMathReport("fastSinBatch", sinBatchError, "abs");
+  simMathReport("fastCosBatch", cosBatchError, "abs");
+
+  std::vector<float> turns = simMathRange(-2 * M_PI, 2 * M_PI); // atan2 around a circle of radius 50
+  double atanError = 0;
+  for(float t : turns)
+  {
+    atanError = fmax(atanError, fabs(remainder(fastAtan2(50 * sin(t), 50 * cos(t)) - atan2(50 * sin(t), 50 * cos(t)), 2 * M_PI)));
+  }
+  std::vector<float> ys(turns.size()), xs(turns.size());
+  for(size_t i = 0; i < turns.size(); i++)
+  {
+    ys[i] = 50 * sin(turns[i]);
+    xs[i] = 50 * cos(turns[i]);
+  }
+  fastAtan2Batch(ys.data(), xs.data(), out.data(), turns.size());
+  double atanBatchError = 0;
+  for(size_t i = 0; i < turns.size(); i++)
+  {
+    atanBatchError = fmax(atanBatchError, fabs(remainder(out[i] - atan2((double)ys[i], (double)xs[i]), 2 * M_PI)));
+  }
+  simMathReport("fastAtan2", atanError, "rad",
+    simNanosecondsPerCall(turns, [](float t) { return fastAtan2(t, 1.5f); }),
+    simNanosecondsPerCall(turns, [](float t) { return atan2f(t, 1.5f); }));
+
+  simMathReport("fastAtan2Batch", atanBatchError, "rad");
+
+  double fixedSinError = 0, fixedCosError = 0, fixedAtanError = 0;
+  for(int angle = 0; angle < 65536; angle++)
+  {
+    fixedSinError = fmax(fixedSinError, fabs(fixedSin(angle) - 32767 * sin(angle * M_PI / 32768)));
+    fixedCosError = fmax(fixedCosError, fabs(fixedCos(angle) - 32767 * cos(angle * M_PI / 32768)));
+    int32_t x = lround(100000 * cos(angle * M_PI / 32768));
+    int32_t y = lround(100000 * sin(angle * M_PI / 32768));
+    double exact = atan2((double)y, (double)x) * 32768 / M_PI;
+    fixedAtanError = fmax(fixedAtanError, fabs(remainder(fixedAtan2(y, x) - exact, 65536)));
+  }
+  simMathReport("fixedSin", fixedSinError, "counts");
+  simMathReport("fixedCos", fixedCosError, "counts");
+  simMathReport("fixedAtan2", fixedAtanError, "counts");
+
+  bool sqrtExact = true;
+  for(uint32_t x = 0; x < 4000000000u; x += 9973)
+  {
+    uint32_t root = fixedSqrt(x);
+    sqrtExact = sqrtExact && (uint64_t)root * root <= x && (uint64_t)(root + 1) * (root + 1) > x;
+  }
+  printf("%-14s  %s\n", "fixedSqrt", sqrtExact ? "exact" : "NOT EXACT");
+
+  double fixedExpError = 0;
+  for(int32_t x = -655360; x < 675020; x += 7)
+  {
+    double exact = exp(x / 65536.0) * 65536;
+    fixedExpError = fmax(fixedExpError, fabs(fixedExp(x) - exact) / fmax(exact, 1 / 3e-5));
+  }
+  simMathReport("fixedExp", fixedExpError, "relative");
+}
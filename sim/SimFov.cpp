@@ -0,0 +1,138 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverFovLimit.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The turn and forward assists together, from a ball well off to one side, with the turn gain turned up
+// until it whips past the ball, with and without fovTurnLimit. Then the same with the driver spinning flat out
+// to find a ball that starts out of view, and letting the assist take over once it comes into the picture. Once the ball's gone out of the picture the
+// assist has nothing to turn at, so a lost lock is usually a ball never reached. Lost is the real ball
+// leaving the image (not a dropout), at any point before arriving. SimWorld's sensor has no latency, the real
+// one hands over frames a couple behind, and that delay is what makes a high gain overshoot, so frames here
+// come out SIM_FOV_LATENCY_FRAMES late. At that the base can't turn fast enough to throw the ball out of the
+// picture, so the last block hands frames over SIM_FOV_SLOW_FRAMES late (a busy vision task, or the sensor's
+// slower tracking modes), with fovTurnLimit told the same latency. That's where the lock actually gets lost.
+
+#define SIM_FOV_TRIALS 300
+#define SIM_FOV_TIMEOUT 10.0 // Seconds to reach the ball
+#define SIM_FOV_SIG 2
+#define SIM_FOV_LATENCY_FRAMES 2
+#define SIM_FOV_SLOW_FRAMES 6 // Late enough that even the standard turn gain throws the ball out of view
+#define SIM_FOV_SPIN_BEARING 0.8 // Radians, where the ball is when the spinning start begins, out of view
+#define SIM_ARRIVE_X 10 // Pixels from the aim that count as lined up, same as SimBatch
+
+struct SimFovStats
+{
+  int lost;
+  int arrived;
+  double arrivalTime;
+  double worstX; // Furthest the ball got past the middle to the other side, pixels, summed over trials
+};
+
+static void simFovTrial(float gain, bool limit, bool spinning, int latencyFrames, uint32_t seed, SimFovStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(24, 72);
+  std::uniform_real_distribution<float> bearing(0.2, 0.4); // Radians, most of the way out to the 0.53 edge
+  std::uniform_int_distribution<int> side(0, 1);
+  float distance = range(world.random);
+  float angle = bearing(world.random) * (side(world.random) ? 1 : -1);
+  float spin = 0;
+  if(spinning)
+  {
+    angle = copysign(SIM_FOV_SPIN_BEARING, angle);
+    spin = -copysign(127, angle); // Turning towards it, a ball on the left being a positive angle
+    world.leftSpeed = spin / 127 * SIM_BASE_MAX_SPEED;
+    world.rightSpeed = -world.leftSpeed;
+  }
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+
+  ControlGains gains = controlGains;
+  controlGains.turnP *= gain;
+  float startX = spin > 0 ? 0 : VISION_FOV_WIDTH, imageY, width; // Which side of the aim it starts, for the overshoot
+  if(!spinning)
+  {
+    simTruth(world, &startX, &imageY, &width);
+  }
+  bool engaged = !spinning; // The assist has the base
+  bool lost = false;
+  float worst = 0;
+  pros::c::vision_object_s_t ball = {};
+  ball.signature = VISION_OBJECT_ERR_SIG;
+  pros::c::vision_object_s_t frames[SIM_FOV_SLOW_FRAMES + 1]; // The ones taken but not handed over yet
+  for(pros::c::vision_object_s_t& frame : frames) frame = ball;
+  float latency = latencyFrames * 0.02;
+  for(int tick = 0; tick * 0.01 < SIM_FOV_TIMEOUT; tick++)
+  {
+    if(tick % 2 == 0) // 50Hz sensor
+    {
+      int frame = tick / 2;
+      frames[frame % (latencyFrames + 1)] = simSee(world, SIM_FOV_SIG);
+      ball = frames[(frame + 1) % (latencyFrames + 1)]; // The oldest, latencyFrames ago
+    }
+    bool visible = ball.signature != VISION_OBJECT_ERR_SIG;
+    engaged = engaged || visible;
+    if(!engaged)
+    {
+      simDrive(world, spin, -spin, 0, 0.01);
+      continue;
+    }
+    float turn = visionTurnPower(visible, ball.x_middle_coord);
+    if(limit && visible)
+    {
+      turn = fovTurnLimit(cameraModel, ball.x_middle_coord, turn, fovYawRate(world.leftSpeed, world.rightSpeed), latency);
+    }
+    float forward = visionForwardPower(visible, ball.width);
+    simDrive(world, turn - forward, -turn - forward, 0, 0.01);
+
+    float imageX;
+    bool inView = simTruth(world, &imageX, &imageY, &width) && imageX >= 0 && imageX < VISION_FOV_WIDTH;
+    lost = lost || !inView;
+    worst = fmax(worst, (imageX - visionAimX) * (startX < visionAimX ? 1 : -1)); // Past the aim, on the side it didn't start
+    if(visible && fabs(ball.x_middle_coord - visionAimX) < SIM_ARRIVE_X && ball.width >= BASE_DISTANCE_WIDTH - 2)
+    {
+      stats.arrived++;
+      stats.arrivalTime += tick * 0.01;
+      break;
+    }
+  }
+  controlGains = gains;
+  stats.lost += lost;
+  stats.worstX += fmin(worst, VISION_FOV_WIDTH);
+}
+
+void simFov()
+{
+  const float gains[] = {1, 4, 8, 16};
+  printf("%d trials per row, %.0f s to reach the ball\n", SIM_FOV_TRIALS, SIM_FOV_TIMEOUT);
+  for(int block = 0; block < 3; block++)
+  {
+    bool spinning = block == 1;
+    int latencyFrames = block == 2 ? SIM_FOV_SLOW_FRAMES : SIM_FOV_LATENCY_FRAMES;
+    if(spinning)
+    {
+      printf("spinning flat out to a ball %.2f rad off, assist from its first frame, frames %d late\n", SIM_FOV_SPIN_BEARING, latencyFrames);
+    }
+    else
+    {
+      printf("from standing, ball 0.2-0.4 rad off to one side, frames %d late\n", latencyFrames);
+    }
+    printf("turn P  limit  lost lock  reached ball  mean time (s)  overshoot past aim (px)\n");
+    for(float gain : gains)
+    {
+      for(int limit = 0; limit < 2; limit++)
+      {
+        SimFovStats stats = {};
+        for(int trial = 0; trial < SIM_FOV_TRIALS; trial++)
+        {
+          simFovTrial(gain, limit, spinning, latencyFrames, trial + 1, stats);
+        }
+        printf("x%-5.0f  %-5s  %8.1f%%  %11.1f%%  %13.2f  %23.1f\n", gain, limit ? "on" : "off", 100.0 * stats.lost / SIM_FOV_TRIALS,
+          100.0 * stats.arrived / SIM_FOV_TRIALS, stats.arrived ? stats.arrivalTime / stats.arrived : 0, stats.worstX / SIM_FOV_TRIALS);
+      }
+    }
+  }
+}
@@ -0,0 +1,89 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverIlc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// autonomousRoutine, run after run on a robot whose right side is a bit tired, with the battery a little
+// different every time. Feedback alone makes the same mistakes every run; with the ILC table learning between
+// runs they should shrink. The wheel travel comes from the simulated wheel speeds, like the motor encoders.
+
+#define SIM_ILC_TICK 0.01
+#define SIM_ILC_RUNS 10
+#define SIM_ILC_SETTLE 0.3 // Seconds holding the end before the pose is checked
+#define SIM_ILC_RIGHT_WEAK 0.9 // The right side only gets this much of its power
+#define SIM_ILC_BATTERY 0.04 // Up to this much less power, run to run
+
+struct SimIlcRun
+{
+  float rms; // Inches, over every sample of every segment
+  float worst; // Worst segment's RMS
+  float endError; // Inches between where the robot ended up and where the routine should have put it
+  float endHeading; // Degrees
+};
+
+static SimIlcRun simIlcRun(const IlcTable& table, IlcRecord& record, uint32_t seed)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> battery(1 - SIM_ILC_BATTERY, 1);
+  float supply = battery(world.random);
+  ilcRecordReset(record);
+
+  float travel[ILC_SIDES] = {0, 0};
+  float end = routineDuration(autonomousRoutine, autonomousRoutineLength) + SIM_ILC_SETTLE;
+  for(float time = 0; time < end; time += SIM_ILC_TICK)
+  {
+    float power[ILC_SIDES];
+    ilcStep(table, record, autonomousRoutine, autonomousRoutineLength, time, travel, power);
+    float left = std::clamp(power[ILC_LEFT], -127.0f, 127.0f) * supply;
+    float right = std::clamp(power[ILC_RIGHT], -127.0f, 127.0f) * supply * SIM_ILC_RIGHT_WEAK;
+    simDrive(world, left, right, 0, SIM_ILC_TICK);
+    travel[ILC_LEFT] += world.leftSpeed * SIM_ILC_TICK;
+    travel[ILC_RIGHT] += world.rightSpeed * SIM_ILC_TICK;
+  }
+
+  RobotPose planned = {0, 0, 0}; // Where the routine goes, stepped in small pieces so the curves come out right
+  for(int segment = 0; segment < autonomousRoutineLength; segment++)
+  {
+    for(int piece = 0; piece < 100; piece++)
+    {
+      odometryStep(planned, autonomousRoutine[segment].travel[ILC_LEFT] / 100, autonomousRoutine[segment].travel[ILC_RIGHT] / 100, 0);
+    }
+  }
+
+  SimIlcRun run = {};
+  double sum = 0;
+  for(int segment = 0; segment < autonomousRoutineLength; segment++)
+  {
+    float error = ilcSegmentError(record, segment);
+    sum += error * error * autonomousRoutine[segment].duration;
+    run.worst = fmax(run.worst, error);
+  }
+  run.rms = sqrt(sum / routineDuration(autonomousRoutine, autonomousRoutineLength));
+  run.endError = hypot(world.pose.x - planned.x, world.pose.y - planned.y);
+  run.endHeading = fabs(remainder(world.pose.heading - planned.heading, 2 * M_PI)) * 180 / M_PI;
+  return run;
+}
+
+void simIlc()
+{
+  static IlcTable learning, none;
+  static IlcRecord record;
+  uint32_t routine = ilcRoutineId(autonomousRoutine, autonomousRoutineLength);
+  ilcReset(learning, routine);
+  ilcReset(none, routine);
+
+  printf("%d segments, %.1f s. Right side at %.0f%% power, battery down to %.0f%% at random\n", autonomousRoutineLength,
+    routineDuration(autonomousRoutine, autonomousRoutineLength), SIM_ILC_RIGHT_WEAK * 100, (1 - SIM_ILC_BATTERY) * 100);
+  printf("       feedback only                  with ILC\n");
+  printf("run    RMS (in)  worst  end (in, deg)  RMS (in)  worst  end (in, deg)\n");
+  for(int run = 1; run <= SIM_ILC_RUNS; run++)
+  {
+    SimIlcRun plain = simIlcRun(none, record, run);
+    SimIlcRun learnt = simIlcRun(learning, record, run);
+    ilcUpdate(learning, record, autonomousRoutineLength);
+    printf("%3d  %9.3f  %5.3f  %5.2f %6.1f  %8.3f  %5.3f  %5.2f %6.1f\n", run, plain.rms, plain.worst, plain.endError, plain.endHeading,
+      learnt.rms, learnt.worst, learnt.endError, learnt.endHeading);
+  }
+}
@@ -0,0 +1,302 @@
+#include "Util/PoolAllocator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+// The brain screen making and deleting its labels and boxes every frame, alongside a control task that
+// allocates as it goes, for a two minute match. Both take from a first fit heap with coalescing, the way
+// FreeRTOS's heap_4 (behind kmalloc) does it:
+//  shared  - LVGL allocating from that heap too, which is what lv_conf.h's kmalloc meant
+//  pools   - LVGL from PoolAllocator, as DriverLvglMemory does now, and only the control task in the heap
+// Every second the control task asks for one big block, which is what fails once the heap is chopped up.
+
+#define SIM_HEAP_SIZE (96 * 1024)
+#define SIM_HEAP_HEADER 8
+#define SIM_HEAP_MIN_SPLIT 16 // Smaller leftovers stay on the block instead of becoming a free block
+#define SIM_LV_MATCH_TICKS 12000 // 10ms ticks in two minutes
+#define SIM_LV_FRAME_TICKS 10 // The screen redraws at 10Hz
+#define SIM_LV_LINES 12 // display_printf lines, the screen drawing task uses 5 and the rest of the brain screen more
+#define SIM_LV_BIG_BLOCK (12 * 1024) // What the control task asks for once a second
+#define SIM_LV_SEEDS 20
+
+struct SimHeap // First fit over a free list kept in address order, joined up on free
+{
+  std::vector<uint8_t> arena;
+  uint32_t freeList; // Offset of the first free block, SIM_HEAP_SIZE for none
+  long steps; // Free list blocks looked at, the time an alloc or free takes
+  long worstSteps; // Most in one call
+  int failures;
+};
+
+static uint32_t& simHeapSize(SimHeap& heap, uint32_t block) { return *(uint32_t*)&heap.arena[block]; }
+static uint32_t& simHeapNext(SimHeap& heap, uint32_t block) { return *(uint32_t*)&heap.arena[block + 4]; }
+
+static void simHeapReset(SimHeap& heap)
+{
+  heap.arena.assign(SIM_HEAP_SIZE, 0);
+  heap.freeList = 0;
+  simHeapSize(heap, 0) = SIM_HEAP_SIZE;
+  simHeapNext(heap, 0) = SIM_HEAP_SIZE;
+  heap.steps = heap.worstSteps = 0;
+  heap.failures = 0;
+}
+
+static void* simHeapAlloc(SimHeap& heap, uint32_t size)
+{
+  uint32_t need = (size + SIM_HEAP_HEADER + 7) & ~7u;
+  uint32_t* link = &heap.freeList;
+  long steps = 0;
+  while(*link != SIM_HEAP_SIZE)
+  {
+    steps++;
+    uint32_t block = *link;
+    uint32_t blockSize = simHeapSize(heap, block);
+    if(blockSize >= need)
+    {
+      if(blockSize - need >= SIM_HEAP_MIN_SPLIT)
+      {
+        uint32_t rest = block + need;
+        simHeapSize(heap, rest) = blockSize - need;
+        simHeapNext(heap, rest) = simHeapNext(heap, block);
+        *link = rest;
+        simHeapSize(heap, block) = need;
+      }
+      else
+      {
+        *link = simHeapNext(heap, block);
+      }
+      heap.steps += steps;
+      heap.worstSteps = std::max(heap.worstSteps, steps);
+      return &heap.arena[block + SIM_HEAP_HEADER];
+    }
+    link = &simHeapNext(heap, block);
+  }
+  heap.steps += steps;
+  heap.worstSteps = std::max(heap.worstSteps, steps);
+  heap.failures++;
+  return nullptr;
+}
+
+static void simHeapFree(SimHeap& heap, void* pointer)
+{
+  uint32_t block = (uint8_t*)pointer - heap.arena.data() - SIM_HEAP_HEADER;
+  uint32_t previous = SIM_HEAP_SIZE;
+  uint32_t next = heap.freeList;
+  long steps = 0;
+  while(next < block) // Find where it goes in address order
+  {
+    steps++;
+    previous = next;
+    next = simHeapNext(heap, next);
+  }
+  simHeapNext(heap, block) = next;
+  if(next != SIM_HEAP_SIZE && block + simHeapSize(heap, block) == next) // Join the one after
+  {
+    simHeapSize(heap, block) += simHeapSize(heap, next);
+    simHeapNext(heap, block) = simHeapNext(heap, next);
+  }
+  if(previous == SIM_HEAP_SIZE)
+  {
+    heap.freeList = block;
+  }
+  else if(previous + simHeapSize(heap, previous) == block) // And the one before
+  {
+    simHeapSize(heap, previous) += simHeapSize(heap, block);
+    simHeapNext(heap, previous) = simHeapNext(heap, block);
+  }
+  else
+  {
+    simHeapNext(heap, previous) = block;
+  }
+  heap.steps += steps;
+  heap.worstSteps = std::max(heap.worstSteps, steps);
+}
+
+static uint32_t simHeapBiggest(SimHeap& heap, uint32_t* total)
+{
+  uint32_t biggest = 0;
+  *total = 0;
+  for(uint32_t block = heap.freeList; block != SIM_HEAP_SIZE; block = simHeapNext(heap, block))
+  {
+    biggest = std::max(biggest, simHeapSize(heap, block));
+    *total += simHeapSize(heap, block);
+  }
+  return biggest;
+}
+
+
+struct SimLvStats
+{
+  long uiOps;
+  double uiSeconds; // Host time in the UI allocs and frees
+  long heapSteps;
+  long heapWorstSteps;
+  int bigFailures; // Big control blocks that couldn't be had
+  int bigAsks;
+  double biggestFree; // Fraction of the free heap in its biggest block at the end
+  int heapFailures;
+};
+
+struct SimLvBlock
+{
+  void* pointer;
+  bool pool;
+};
+
+static void simLvMatch(bool pools, uint32_t seed, SimLvStats& stats)
+{
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 random(seed);
+  SimHeap heap;
+  simHeapReset(heap);
+  poolInit();
+
+  auto uiAlloc = [&](uint32_t size) -> SimLvBlock
+  {
+    void* pointer = pools ? poolAlloc(size) : nullptr;
+    if(pointer != nullptr)
+    {
+      return {pointer, true};
+    }
+    return {simHeapAlloc(heap, size), false};
+  };
+  auto uiFree = [&](SimLvBlock block)
+  {
+    if(block.pool)
+    {
+      poolFree(block.pointer);
+    }
+    else if(block.pointer != nullptr)
+    {
+      simHeapFree(heap, block.pointer);
+    }
+  };
+
+  std::vector<SimLvBlock> screen; // This frame's objects
+  std::vector<SimLvBlock> lines;
+  for(int i = 0; i < SIM_LV_LINES; i++)
+  {
+    lines.push_back(uiAlloc(64)); // The label, which stays
+    lines.push_back(uiAlloc(28));
+    lines.push_back(uiAlloc(16)); // And its text, which doesn't
+  }
+  std::deque<std::pair<int, void*>> control; // Control task blocks and the tick they're freed on
+  std::uniform_int_distribution<int> boxes(1, 6), text(6, 48), smallSize(24, 480), life(1, 300);
+  std::uniform_int_distribution<int> bigSize(2048, 8192);
+  std::uniform_real_distribution<float> chance(0, 1);
+  std::vector<void*> bigs;
+
+  for(int tick = 0; tick < SIM_LV_MATCH_TICKS; tick++)
+  {
+    if(tick % SIM_LV_FRAME_TICKS == 0)
+    {
+      Clock::time_point start = Clock::now();
+      // The display_printf lines are labels that stay, but every call reallocs their text
+      for(size_t i = 2; i < lines.size(); i += 3)
+      {
+        uiFree(lines[i]);
+        lines[i] = uiAlloc(text(random));
+      }
+      // drawObjects clears its area and draws the boxes and their labels again
+      for(SimLvBlock block : screen)
+      {
+        uiFree(block);
+      }
+      screen.clear();
+      int count = boxes(random);
+      for(int i = 0; i < count; i++)
+      {
+        screen.push_back(uiAlloc(64)); // lv_obj_t
+        screen.push_back(uiAlloc(72)); // Its own style
+        screen.push_back(uiAlloc(64)); // The label with it
+        screen.push_back(uiAlloc(28)); // Label ext
+        screen.push_back(uiAlloc(text(random)));
+      }
+      stats.uiSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+      stats.uiOps += 2 * (screen.size() + lines.size() / 3);
+    }
+
+    // The control task: a couple of short lived buffers a tick, now and then a longer one
+    int asks = chance(random) < 0.5 ? 1 : 2;
+    for(int i = 0; i < asks; i++)
+    {
+      bool longLived = chance(random) < 0.002;
+      void* pointer = simHeapAlloc(heap, longLived ? bigSize(random) : smallSize(random));
+      if(pointer != nullptr)
+      {
+        control.push_back({tick + (longLived ? 20 * life(random) : life(random) / 10 + 1), pointer});
+      }
+    }
+    std::sort(control.begin(), control.end(), [](const std::pair<int, void*>& a, const std::pair<int, void*>& b) { return a.first < b.first; });
+    while(!control.empty() && control.front().first <= tick)
+    {
+      simHeapFree(heap, control.front().second);
+      control.pop_front();
+    }
+
+    if(tick % 100 == 50) // Once a second, one big block that's let go straight away
+    {
+      stats.bigAsks++;
+      void* big = simHeapAlloc(heap, SIM_LV_BIG_BLOCK);
+      if(big == nullptr)
+      {
+        stats.bigFailures++;
+        heap.failures--; // Counted on its own
+      }
+      else
+      {
+        simHeapFree(heap, big);
+      }
+    }
+  }
+
+  uint32_t total;
+  uint32_t biggest = simHeapBiggest(heap, &total);
+  stats.biggestFree += total ? (double)biggest / total : 0;
+  stats.heapSteps += heap.steps;
+  stats.heapWorstSteps = std::max(stats.heapWorstSteps, heap.worstSteps);
+  stats.heapFailures += heap.failures;
+  for(SimLvBlock block : screen)
+  {
+    uiFree(block);
+  }
+  for(SimLvBlock block : lines)
+  {
+    uiFree(block);
+  }
+  for(auto& entry : control)
+  {
+    simHeapFree(heap, entry.second);
+  }
+}
+
+void simLvglMemory()
+{
+  printf("%d matches of %d s, heap %d KB, pool arena %u KB. A big block is %d KB, asked for once a second\n", SIM_LV_SEEDS,
+    SIM_LV_MATCH_TICKS / 100, SIM_HEAP_SIZE / 1024, poolArenaSize() / 1024, SIM_LV_BIG_BLOCK / 1024);
+  printf("lvgl     ns/UI op  heap steps/tick  worst steps  big block fails  other heap fails  biggest free/free\n");
+  for(int pools = 0; pools < 2; pools++)
+  {
+    SimLvStats stats = {};
+    for(uint32_t seed = 1; seed <= SIM_LV_SEEDS; seed++)
+    {
+      simLvMatch(pools, seed, stats);
+    }
+    printf("%-7s  %8.1f  %13.2f  %11ld  %14.1f%%  %16d  %16.1f%%\n", pools ? "pools" : "shared", stats.uiSeconds * 1e9 / stats.uiOps,
+      (double)stats.heapSteps / (SIM_LV_SEEDS * SIM_LV_MATCH_TICKS), stats.heapWorstSteps, 100.0 * stats.bigFailures / stats.bigAsks,
+      stats.heapFailures, 100.0 * stats.biggestFree / SIM_LV_SEEDS);
+  }
+
+  PoolClassStats classes[POOL_CLASSES];
+  poolStats(classes);
+  printf("pool classes after the last match (bytes: peak in use / blocks, spilled)\n ");
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    printf(" %u: %u/%u, %u", classes[c].blockSize, classes[c].peak, classes[c].blocks, classes[c].spills);
+  }
+  printf("\n");
+}
@@ -0,0 +1,162 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverObstacles.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+// The robot runs the vision assist to a ball while a scripted opponent gets in the way, once with the
+// assist driving straight at the ball like it used to and once through avoidFilter. The opponent is
+// seen by its own signature through the same camera, noise and all, and tracked with opponentUpdate.
+
+#define SIM_OPPONENT_TRIALS 200
+#define SIM_OPPONENT_TIMEOUT 12.0 // Seconds to reach the ball
+#define SIM_OPPONENT_SIG 3
+#define SIM_ARRIVE_X 10 // Pixels from centre that count as lined up, same as SimBatch
+
+enum SimOpponentScript
+{
+  SCRIPT_CROSSING, // Drives across our path, timed to get there when we do
+  SCRIPT_HEAD_ON, // Comes straight at us from behind the ball, and doesn't stop
+  SCRIPT_PARKED, // Sitting between us and the ball
+  SCRIPT_COUNT
+};
+
+float simOpponentSink; // Keeps the timed loop from being thrown away
+
+struct SimOpponentStats
+{
+  int collisions; // Trials where the two touched
+  int arrived;
+  double arrivalTime;
+  double clearance; // Closest the edges got, summed over trials
+};
+
+static pros::c::vision_object_s_t simSeeOpponent(SimWorld& world, float opponentX, float opponentY)
+{
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+  float imageX, imageY, width;
+  if(!fieldToImage(world.camera, world.pose, opponentX, opponentY, &imageX, &imageY, &width, OPPONENT_PLATE_WIDTH, OPPONENT_PLATE_HEIGHT)
+    || imageX < 0 || imageX >= VISION_FOV_WIDTH || imageY < 0 || imageY >= VISION_FOV_HEIGHT)
+  {
+    return seen;
+  }
+  std::normal_distribution<float> noise(0, SIM_PIXEL_NOISE);
+  seen.signature = SIM_OPPONENT_SIG;
+  seen.x_middle_coord = lround(imageX + noise(world.random));
+  seen.y_middle_coord = lround(imageY + noise(world.random));
+  seen.width = std::max(1L, lround(width + noise(world.random)));
+  seen.height = seen.width;
+  return seen;
+}
+
+static void simOpponentTrial(int script, bool avoid, uint32_t seed, SimOpponentStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> jitter(-1, 1);
+  world.ballX = 60 + 6 * jitter(world.random);
+  world.ballY = 8 * jitter(world.random);
+
+  float opponentX, opponentY, opponentVX, opponentVY;
+  switch(script)
+  {
+    case SCRIPT_CROSSING:
+      opponentX = 40 + 4 * jitter(world.random);
+      opponentY = -30 + 5 * jitter(world.random); // Starts near the edge of the view
+      opponentVX = 0;
+      opponentVY = 12 + 3 * jitter(world.random);
+      break;
+    case SCRIPT_HEAD_ON:
+      opponentX = 100 + 5 * jitter(world.random);
+      opponentY = world.ballY + 3 * jitter(world.random);
+      opponentVX = -20 + 4 * jitter(world.random);
+      opponentVY = 0;
+      break;
+    default:
+      opponentX = 24 + 4 * jitter(world.random);
+      opponentY = world.ballY / 2 + 3 * jitter(world.random);
+      opponentVX = opponentVY = 0;
+      break;
+  }
+
+  OpponentTrack tracks[OPPONENT_TRACKS] = {};
+  pros::c::vision_object_s_t ball = {};
+  ball.signature = VISION_OBJECT_ERR_SIG;
+  bool touched = false;
+  float clearance = 1e9;
+  float time = 0;
+  for(int tick = 0; time < SIM_OPPONENT_TIMEOUT; tick++)
+  {
+    opponentX += opponentVX * 0.01;
+    opponentY += opponentVY * 0.01;
+
+    if(tick % 2 == 0) // 50Hz sensor
+    {
+      ball = simSee(world, 2);
+      pros::c::vision_object_s_t opponent = simSeeOpponent(world, opponentX, opponentY);
+      opponentUpdate(tracks, world.odometry, &opponent, 1, world.time);
+    }
+    bool visible = ball.signature != VISION_OBJECT_ERR_SIG;
+    float turn = visionTurnPower(visible, ball.x_middle_coord);
+    float forward = visionForwardPower(visible, ball.width);
+    float left = turn - forward;
+    float right = -turn - forward;
+    float strafe = 0;
+    if(avoid)
+    {
+      avoidFilter(tracks, world.odometry, world.time, &left, &right, &strafe);
+    }
+    simDrive(world, left, right, strafe, 0.01);
+    time += 0.01;
+
+    float gap = hypot(opponentX - world.pose.x, opponentY - world.pose.y) - ROBOT_RADIUS - OPPONENT_RADIUS;
+    clearance = fmin(clearance, gap);
+    touched = touched || gap < 0;
+
+    if(visible && fabs(ball.x_middle_coord - VISION_FOV_WIDTH/2) < SIM_ARRIVE_X && ball.width >= BASE_DISTANCE_WIDTH - 2)
+    {
+      stats.arrived++;
+      stats.arrivalTime += time;
+      break;
+    }
+  }
+  stats.collisions += touched;
+  stats.clearance += clearance;
+}
+
+void simOpponents()
+{
+  const char* names[SCRIPT_COUNT] = {"crossing", "head-on", "parked"};
+  printf("%d trials per script. Clearance is the closest the edges got, negative is overlapping\n", SIM_OPPONENT_TRIALS);
+  printf("script    avoidance  collisions  reached ball  mean time (s)  mean clearance (in)\n");
+  for(int script = 0; script < SCRIPT_COUNT; script++)
+  {
+    for(int avoid = 0; avoid < 2; avoid++)
+    {
+      SimOpponentStats stats = {};
+      for(int trial = 0; trial < SIM_OPPONENT_TRIALS; trial++)
+      {
+        simOpponentTrial(script, avoid, trial + 1, stats);
+      }
+      printf("%-8s  %-9s  %9.1f%%  %11.1f%%  %13.2f  %19.1f\n", names[script], avoid ? "on" : "off",
+        100.0 * stats.collisions / SIM_OPPONENT_TRIALS, 100.0 * stats.arrived / SIM_OPPONENT_TRIALS,
+        stats.arrived ? stats.arrivalTime / stats.arrived : 0, stats.clearance / SIM_OPPONENT_TRIALS);
+    }
+  }
+
+  // Worst case for the control tick: both opponents live and in the way, so every candidate gets tried
+  OpponentTrack tracks[OPPONENT_TRACKS] = {{true, 30, 0, -10, 0, 0}, {true, 30, 15, 0, -10, 0}};
+  float sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int call = 0; call < 100000; call++)
+  {
+    float left = 100, right = 100 + (call & 7), strafe = 0;
+    avoidFilter(tracks, {0, 0, 0}, 0, &left, &right, &strafe);
+    sink += left + strafe;
+  }
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  simOpponentSink = sink;
+  printf("avoidFilter with both opponents in the way: %.2f us per call on this machine\n", elapsed.count() / 100000);
+}
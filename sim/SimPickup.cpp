@@ -0,0 +1,145 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include "Driver/DriverContact.hpp"
+#include "Driver/DriverPickup.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include <cmath>
+#include <cstdio>
+
+// A whole pickup from a long way out with the arm carried up, the base coming in on the forward PID with the
+// contactBrake like the robot, and the arm:
+//  reactive    - setting off for the grab angle once the base is there, which is what holding LEFT amounted to
+//  predictive  - DriverPickup, setting off when the time to contact gets down to the arm's travel time
+// The pickup is done when the ball is the grab width and the claw is within SIM_PICKUP_ARM_DONE of it
+
+#define SIM_PICKUP_TICK 0.01
+#define SIM_PICKUP_EPISODES 300
+#define SIM_PICKUP_EPISODE_TICKS 800
+#define SIM_PICKUP_CARRY (90 * M_PI / 180) // Where the arm starts, up out of the way
+#define SIM_PICKUP_BASE_DONE 3 // Pixels of width
+#define SIM_PICKUP_ARM_DONE (3 * M_PI / 180)
+#define SIM_BALL_SIG 2
+
+struct SimPickupStats
+{
+  int done;
+  double pickupTime; // Summed over the done ones
+  double baseTime; // When the base first got there
+  double armWait; // Seconds the base sat there waiting on the arm
+  double armEarly; // Seconds the arm sat at the grab angle before the base got there
+};
+
+static void simPickupEpisode(bool predictive, uint32_t seed, SimPickupStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.15, 0.15);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+  world.armAngle = SIM_PICKUP_CARRY;
+  world.armMotorAngle = SIM_PICKUP_CARRY;
+
+  PidGains gains = forwardPidGains(controlGains);
+  PidController pid = {gains, BASE_DISTANCE_WIDTH};
+  TargetEstimate estimate = {};
+  ContactEstimate contact = {};
+  PickupPlan plan;
+  pickupReset(plan);
+  ArmEstimate arm = {};
+  MotorCompensation compensation = {}; // Already learnt, as it would be a little way into a match
+  compensation.deadband = SIM_ARM_DEADBAND;
+  compensation.backlash = SIM_ARM_BACKLASH;
+  compensation.slop = -SIM_ARM_BACKLASH / 2;
+  float lastEncoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+  float armTravel = 0;
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+
+  float grabAngle = pickupArmAngle(BALL_DIAMETER / 2); // Where the claw really needs to be
+  int baseTick = -1;
+  int armEarlyTicks = 0;
+  float imageX, imageY, width = 0;
+  for(int tick = 1; tick <= SIM_PICKUP_EPISODE_TICKS; tick++)
+  {
+    if(tick % 2 == 0)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      targetEstimateUpdate(estimate, world.odometry, seen, world.time, controlGains);
+      if(seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        contactUpdate(contact, seen.width, seen.y_middle_coord, world.time);
+      }
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, world.time, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+
+    pid.gains.outputMax = contactBrake(contact, world.time, target.width, BASE_DISTANCE_WIDTH, gains.outputMax, controlGains);
+    float turn = visionTurnPower(visible, target.x_middle_coord);
+    float forward = visible ? pidStep(pid, target.width, SIM_PICKUP_TICK) : 0;
+    simDrive(world, turn + forward, -turn + forward, 0, SIM_PICKUP_TICK);
+
+    // The arm loop, as armP and the arbiter run it
+    float encoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+    armTravel += compensationObserve(compensation, encoder - lastEncoder, SIM_PICKUP_TICK);
+    lastEncoder = encoder;
+    armEstimateUpdate(arm, simArmPot(world) * ARM_RADIANS_PER_POT_COUNT, armTravel, SIM_PICKUP_TICK);
+    bool go;
+    if(predictive)
+    {
+      go = visible && pickupUpdate(plan, cameraModel, contact, world.time, target.width, target.y_middle_coord, arm.angle, controlGains.armP);
+    }
+    else
+    {
+      go = plan.moving = plan.moving || (visible && target.width >= BASE_DISTANCE_WIDTH - SIM_PICKUP_BASE_DONE);
+    }
+    float power = compensationCommand(compensation, go ? armPower((plan.grabAngle - arm.angle) * 180 / M_PI) : 0);
+    compensation.lastCommand = power;
+    simDriveArm(world, power, SIM_PICKUP_TICK);
+
+    simTruth(world, &imageX, &imageY, &width);
+    bool baseThere = fabs(width - BASE_DISTANCE_WIDTH) <= SIM_PICKUP_BASE_DONE;
+    bool armThere = fabs(world.armAngle - grabAngle) <= SIM_PICKUP_ARM_DONE;
+    if(baseThere && baseTick < 0)
+    {
+      baseTick = tick;
+    }
+    armEarlyTicks += armThere && baseTick < 0;
+    if(baseThere && armThere)
+    {
+      stats.done++;
+      stats.pickupTime += tick * SIM_PICKUP_TICK;
+      stats.baseTime += baseTick * SIM_PICKUP_TICK;
+      stats.armWait += (tick - baseTick) * SIM_PICKUP_TICK;
+      stats.armEarly += armEarlyTicks * SIM_PICKUP_TICK;
+      return;
+    }
+  }
+}
+
+void simPickup()
+{
+  printf("%d pickups from 36-96in with the arm starting up at %.0f deg, grab angle %.1f deg\n", SIM_PICKUP_EPISODES,
+    SIM_PICKUP_CARRY * 180 / M_PI, pickupArmAngle(BALL_DIAMETER / 2) * 180 / M_PI);
+  printf("arm         done  pickup (s)  base there (s)  base waiting (s)  arm waiting (s)\n");
+  for(int predictive = 0; predictive < 2; predictive++)
+  {
+    SimPickupStats stats = {};
+    for(uint32_t episode = 1; episode <= SIM_PICKUP_EPISODES; episode++)
+    {
+      simPickupEpisode(predictive, episode, stats);
+    }
+    int done = stats.done ? stats.done : 1;
+    printf("%-10s  %5.1f%%  %10.2f  %14.2f  %16.2f  %15.2f\n", predictive ? "predictive" : "reactive", 100.0 * stats.done / SIM_PICKUP_EPISODES,
+      stats.pickupTime / done, stats.baseTime / done, stats.armWait / done, stats.armEarly / done);
+  }
+}
@@ -0,0 +1,121 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include <cmath>
+#include <cstdio>
+
+// The forward assist driving up to a ball from a long way out, where it sits at full power most of the way:
+//  P          - visionForwardPower, what we had
+//  PID        - with an I to get rid of the deadband offset and a D against the overshoot, but nothing else
+//  PID+AW     - the same gains with anti-windup and the derivative filter, as driverBaseForward() runs it
+// Everyone uses the field-frame ball estimate through dropouts, like calculateTarget()
+
+#define SIM_PID_TICK 0.01
+#define SIM_PID_EPISODES 300
+#define SIM_PID_EPISODE_TICKS 1000
+#define SIM_PID_SETTLED 3 // Pixels of width
+#define SIM_BALL_SIG 2
+
+enum SimForwardController { FORWARD_P, FORWARD_PID, FORWARD_PID_AW, FORWARD_COUNT };
+const char* simForwardNames[FORWARD_COUNT] = {"P", "PID", "PID+AW"};
+
+struct SimPidStats
+{
+  int settled;
+  double settleTime;
+  double overshoot; // Pixels of width past the target, summed
+  double finalError;
+  double jitterSquared; // Change in command per tick, squared
+  long ticks;
+};
+
+
+void simPidEpisode(SimForwardController controller, uint32_t seed, const PidGains& gains, SimPidStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.15, 0.15);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+
+  TargetEstimate estimate = {};
+  PidController pid = {gains};
+  pidSetTarget(pid, BASE_DISTANCE_WIDTH);
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+
+  float lastForward = 0;
+  float overshoot = 0;
+  int lastUnsettled = 0;
+  float imageX, imageY, width = 0;
+  for(int tick = 1; tick <= SIM_PID_EPISODE_TICKS; tick++)
+  {
+    if(tick % 2 == 0)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      targetEstimateUpdate(estimate, world.odometry, seen, world.time, controlGains);
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, world.time, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+
+    float turn = visionTurnPower(visible, target.x_middle_coord);
+    float forward = -visionForwardPower(visible, target.width);
+    if(controller != FORWARD_P)
+    {
+      forward = visible ? pidStep(pid, target.width, SIM_PID_TICK) : 0;
+    }
+    simDrive(world, turn + forward, -turn + forward, 0, SIM_PID_TICK);
+
+    stats.jitterSquared += (forward - lastForward) * (forward - lastForward);
+    stats.ticks++;
+    lastForward = forward;
+
+    if(simTruth(world, &imageX, &imageY, &width))
+    {
+      overshoot = fmax(overshoot, width - BASE_DISTANCE_WIDTH);
+    }
+    if(fabs(width - BASE_DISTANCE_WIDTH) > SIM_PID_SETTLED)
+    {
+      lastUnsettled = tick;
+    }
+  }
+
+  stats.overshoot += overshoot;
+  stats.finalError += fabs(width - BASE_DISTANCE_WIDTH);
+  if(lastUnsettled < SIM_PID_EPISODE_TICKS)
+  {
+    stats.settled++;
+    stats.settleTime += lastUnsettled * SIM_PID_TICK;
+  }
+}
+
+
+void simPid()
+{
+  // Same gains both ways, only the saturation handling and derivative filter differ
+  PidGains plain = {BASE_P * 5, BASE_FORWARD_I, BASE_FORWARD_D, 0, 1, 0, -127, 127};
+  PidGains saturating = plain;
+  saturating.derivativeFilter = BASE_FORWARD_D_FILTER;
+  saturating.backCalculation = BASE_FORWARD_ANTI_WINDUP;
+
+  printf("controller  settled  mean settle (s)  overshoot (px)  final error (px)  command jitter RMS\n");
+  for(int controller = 0; controller < FORWARD_COUNT; controller++)
+  {
+    SimPidStats stats = {};
+    for(uint32_t episode = 1; episode <= SIM_PID_EPISODES; episode++)
+    {
+      simPidEpisode((SimForwardController)controller, episode, controller == FORWARD_PID_AW ? saturating : plain, stats);
+    }
+    printf("%-10s  %6.1f%%  %15.2f  %14.2f  %16.2f  %18.2f\n", simForwardNames[controller],
+      100.0 * stats.settled / SIM_PID_EPISODES, stats.settled ? stats.settleTime / stats.settled : 0.0,
+      stats.overshoot / SIM_PID_EPISODES, stats.finalError / SIM_PID_EPISODES, sqrt(stats.jitterSquared / stats.ticks));
+  }
+}
@@ -0,0 +1,429 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include "Driver/DriverContact.hpp"
+#include "Driver/DriverPickup.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCompensation.hpp"
+#include "Driver/DriverArbiter.hpp"
+#include "Driver/DriverPolicy.hpp"
+#include "Util/QuantMlp.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Trains the approach policy and writes policy.bin for the SD card. The teacher is the pickup the robot does
+// now (the same loop as the energy scenario): the turn P, the braked forward PID and the predictive arm.
+//  1. The teacher picks up balls and every frame's features and powers are kept
+//  2. A float 6-24-24-3 ReLU net is fitted to them with Adam
+//  3. Then the net drives and the teacher says what it would have done (DAgger), so it learns to get back from
+//     places the teacher never goes. Twice, refitting on everything each time
+//  4. Quantized to int8 with the scales from the data it was trained on, saved, and loaded back with mlpLoad
+// Then teacher, float and int8 pick up the same held out balls, and mlpRun is timed.
+
+#define SIM_POLICY_TICK 0.01
+#define SIM_POLICY_TIMEOUT 800 // Ticks
+#define SIM_POLICY_TRAIN_BALLS 300
+#define SIM_POLICY_TEST_BALLS 300
+#define SIM_POLICY_DAGGER 2 // Rounds of the net driving
+#define SIM_POLICY_EPOCHS 12
+#define SIM_POLICY_BATCH 64
+#define SIM_POLICY_RATE 0.003 // Adam's step, halved every few epochs
+#define SIM_POLICY_HIDDEN 24
+#define SIM_POLICY_CARRY (90 * M_PI / 180)
+#define SIM_POLICY_BENCH 1000000
+#define SIM_BALL_SIG 2
+
+enum SimPolicyDriver { POLICY_TEACHER, POLICY_FLOAT, POLICY_INT8, POLICY_DRIVERS };
+const char* simPolicyNames[POLICY_DRIVERS] = {"teacher", "float", "int8"};
+
+float simPolicySink;
+
+struct SimPolicySample
+{
+  float features[POLICY_INPUTS];
+  float powers[POLICY_OUTPUTS]; // The teacher's, over 127
+};
+
+struct SimPolicyNet // Float, for training. Row per output, like the quantized layers
+{
+  float w1[SIM_POLICY_HIDDEN][POLICY_INPUTS], b1[SIM_POLICY_HIDDEN];
+  float w2[SIM_POLICY_HIDDEN][SIM_POLICY_HIDDEN], b2[SIM_POLICY_HIDDEN];
+  float w3[POLICY_OUTPUTS][SIM_POLICY_HIDDEN], b3[POLICY_OUTPUTS];
+};
+#define SIM_POLICY_PARAMETERS (sizeof(SimPolicyNet) / sizeof(float))
+
+struct SimPolicyActivations
+{
+  float h1[SIM_POLICY_HIDDEN];
+  float h2[SIM_POLICY_HIDDEN];
+  float out[POLICY_OUTPUTS];
+};
+
+static void simPolicyForward(const SimPolicyNet& net, const float* in, SimPolicyActivations& a)
+{
+  for(int o = 0; o < SIM_POLICY_HIDDEN; o++)
+  {
+    float sum = net.b1[o];
+    for(int i = 0; i < POLICY_INPUTS; i++) sum += net.w1[o][i] * in[i];
+    a.h1[o] = fmaxf(sum, 0);
+  }
+  for(int o = 0; o < SIM_POLICY_HIDDEN; o++)
+  {
+    float sum = net.b2[o];
+    for(int i = 0; i < SIM_POLICY_HIDDEN; i++) sum += net.w2[o][i] * a.h1[i];
+    a.h2[o] = fmaxf(sum, 0);
+  }
+  for(int o = 0; o < POLICY_OUTPUTS; o++)
+  {
+    float sum = net.b3[o];
+    for(int i = 0; i < SIM_POLICY_HIDDEN; i++) sum += net.w3[o][i] * a.h2[i];
+    a.out[o] = sum;
+  }
+}
+
+static float simPolicyBackward(const SimPolicyNet& net, const SimPolicySample& sample, SimPolicyNet& gradient) // Adds to gradient, returns the squared error
+{
+  SimPolicyActivations a;
+  simPolicyForward(net, sample.features, a);
+  float dOut[POLICY_OUTPUTS], dH2[SIM_POLICY_HIDDEN] = {}, dH1[SIM_POLICY_HIDDEN] = {};
+  float loss = 0;
+  for(int o = 0; o < POLICY_OUTPUTS; o++)
+  {
+    float error = a.out[o] - sample.powers[o];
+    loss += error * error;
+    dOut[o] = 2 * error;
+    gradient.b3[o] += dOut[o];
+    for(int i = 0; i < SIM_POLICY_HIDDEN; i++)
+    {
+      gradient.w3[o][i] += dOut[o] * a.h2[i];
+      dH2[i] += dOut[o] * net.w3[o][i];
+    }
+  }
+  for(int o = 0; o < SIM_POLICY_HIDDEN; o++)
+  {
+    if(a.h2[o] <= 0) continue;
+    gradient.b2[o] += dH2[o];
+    for(int i = 0; i < SIM_POLICY_HIDDEN; i++)
+    {
+      gradient.w2[o][i] += dH2[o] * a.h1[i];
+      dH1[i] += dH2[o] * net.w2[o][i];
+    }
+  }
+  for(int o = 0; o < SIM_POLICY_HIDDEN; o++)
+  {
+    if(a.h1[o] <= 0) continue;
+    gradient.b1[o] += dH1[o];
+    for(int i = 0; i < POLICY_INPUTS; i++) gradient.w1[o][i] += dH1[o] * sample.features[i];
+  }
+  return loss;
+}
+
+static void simPolicyInit(SimPolicyNet& net, std::mt19937& random) // He initialisation, biases zero
+{
+  net = {};
+  std::normal_distribution<float> first(0, sqrtf(2.0f / POLICY_INPUTS)), rest(0, sqrtf(2.0f / SIM_POLICY_HIDDEN));
+  for(auto& row : net.w1) for(float& w : row) w = first(random);
+  for(auto& row : net.w2) for(float& w : row) w = rest(random);
+  for(auto& row : net.w3) for(float& w : row) w = rest(random) * 0.1f;
+}
+
+static float simPolicyTrain(SimPolicyNet& net, const std::vector<SimPolicySample>& data, std::mt19937& random) // Returns the last epoch's RMS error
+{
+  static SimPolicyNet m, v, gradient;
+  m = {};
+  v = {};
+  float* p = (float*)&net;
+  float* pm = (float*)&m;
+  float* pv = (float*)&v;
+  float* pg = (float*)&gradient;
+  std::vector<int> order(data.size());
+  for(size_t i = 0; i < order.size(); i++) order[i] = i;
+  float rate = SIM_POLICY_RATE;
+  long step = 0;
+  float loss = 0;
+  for(int epoch = 0; epoch < SIM_POLICY_EPOCHS; epoch++)
+  {
+    std::shuffle(order.begin(), order.end(), random);
+    loss = 0;
+    for(size_t start = 0; start < order.size(); start += SIM_POLICY_BATCH)
+    {
+      size_t end = std::min(order.size(), start + SIM_POLICY_BATCH);
+      gradient = {};
+      for(size_t i = start; i < end; i++) loss += simPolicyBackward(net, data[order[i]], gradient);
+      step++;
+      float scale = 1.0f / (end - start);
+      float correction1 = 1 - powf(0.9f, step), correction2 = 1 - powf(0.999f, step);
+      for(size_t k = 0; k < SIM_POLICY_PARAMETERS; k++)
+      {
+        float g = pg[k] * scale;
+        pm[k] = 0.9f * pm[k] + 0.1f * g;
+        pv[k] = 0.999f * pv[k] + 0.001f * g * g;
+        p[k] -= rate * (pm[k] / correction1) / (sqrtf(pv[k] / correction2) + 1e-8f);
+      }
+    }
+    if(epoch % 4 == 3) rate *= 0.5f;
+  }
+  return sqrtf(loss / (data.size() * POLICY_OUTPUTS));
+}
+
+static float simPolicyScale(float largest) // Real units per int8 step
+{
+  return fmaxf(largest, 1e-6f) / 127;
+}
+
+static void simPolicyQuantize(const SimPolicyNet& net, const std::vector<SimPolicySample>& data, MlpModel& model)
+// Symmetric per layer, with each activation's scale from the biggest it got over the training data
+{
+  float inputMax = 0, h1Max = 0, h2Max = 0;
+  for(const SimPolicySample& sample : data)
+  {
+    SimPolicyActivations a;
+    simPolicyForward(net, sample.features, a);
+    for(float f : sample.features) inputMax = fmaxf(inputMax, fabsf(f));
+    for(float h : a.h1) h1Max = fmaxf(h1Max, h);
+    for(float h : a.h2) h2Max = fmaxf(h2Max, h);
+  }
+  float inScale[3] = {simPolicyScale(inputMax), simPolicyScale(h1Max), simPolicyScale(h2Max)};
+  const float* weights[3] = {&net.w1[0][0], &net.w2[0][0], &net.w3[0][0]};
+  const float* biases[3] = {net.b1, net.b2, net.b3};
+  int shape[3][2] = {{POLICY_INPUTS, SIM_POLICY_HIDDEN}, {SIM_POLICY_HIDDEN, SIM_POLICY_HIDDEN}, {SIM_POLICY_HIDDEN, POLICY_OUTPUTS}};
+
+  model = {};
+  model.layerCount = 3;
+  model.inputs = POLICY_INPUTS;
+  model.inputScale = inScale[0];
+  uint32_t weightOffset = 0;
+  for(int l = 0; l < 3; l++)
+  {
+    int count = shape[l][0] * shape[l][1];
+    float largest = 0;
+    for(int k = 0; k < count; k++) largest = fmaxf(largest, fabsf(weights[l][k]));
+    float weightScale = simPolicyScale(largest);
+    float sumScale = inScale[l] * weightScale; // Real units per step of the int32 sum
+
+    MlpLayer& layer = model.layers[l];
+    layer.inputs = shape[l][0];
+    layer.outputs = shape[l][1];
+    layer.weightOffset = weightOffset;
+    layer.biasOffset = l * MLP_MAX_WIDTH;
+    for(int k = 0; k < count; k++) model.weights[weightOffset + k] = lroundf(weights[l][k] / weightScale);
+    for(int o = 0; o < layer.outputs; o++) model.biases[layer.biasOffset + o] = lroundf(biases[l][o] / sumScale);
+    if(l < 2)
+    {
+      layer.multiplier = lround(sumScale / inScale[l + 1] * (1 << MLP_MULTIPLIER_SHIFT));
+    }
+    else
+    {
+      layer.outputScale = sumScale;
+    }
+    weightOffset += count;
+  }
+}
+
+
+struct SimPolicyStats
+{
+  int balls;
+  double seconds;
+  double error[POLICY_OUTPUTS]; // Powers off the teacher's, summed over ticks
+  long ticks;
+};
+
+static void simPolicyBall(SimPolicyDriver driver, const SimPolicyNet* net, const MlpModel* model, uint32_t seed,
+  SimPolicyStats& stats, std::vector<SimPolicySample>* data)
+// One pickup, the same as the energy scenario's "as is" but with whoever's driving. The teacher always works out
+// what it would do, for the data and to compare against
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.3, 0.3);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+  world.armAngle = world.armMotorAngle = SIM_POLICY_CARRY;
+
+  PidGains forwardGains = forwardPidGains(controlGains);
+  PidController pid = {forwardGains, BASE_DISTANCE_WIDTH};
+  TargetEstimate estimate = {};
+  ContactEstimate contact = {};
+  PickupPlan plan;
+  pickupReset(plan);
+  ArmEstimate arm = {};
+  MotorCompensation compensation = {};
+  compensation.deadband = SIM_ARM_DEADBAND;
+  compensation.backlash = SIM_ARM_BACKLASH;
+  compensation.slop = -SIM_ARM_BACKLASH / 2;
+  Arbiter arbiter = {};
+  arbiter.compensation[MOTOR_ARM] = &compensation;
+  float lastEncoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+  float armTravel = 0;
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+  float grabAngle = pickupArmAngle(BALL_DIAMETER / 2);
+  float imageX, imageY, width;
+
+  for(int tick = 1; tick <= SIM_POLICY_TIMEOUT; tick++)
+  {
+    uint32_t now = world.time;
+    bool frame = tick % 2 == 0;
+    if(frame)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      targetEstimateUpdate(estimate, world.odometry, seen, now, controlGains);
+      if(seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        contactUpdate(contact, seen.width, seen.y_middle_coord, now);
+      }
+    }
+    pros::c::vision_object_s_t target = seen;
+    if(target.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(estimate, world.odometry, now, &target, controlGains);
+    }
+    bool visible = target.signature != VISION_OBJECT_ERR_SIG;
+
+    float encoder = simArmEncoder(world) * ARM_RADIANS_PER_MOTOR_DEGREE;
+    armTravel += compensationObserve(compensation, encoder - lastEncoder, SIM_POLICY_TICK);
+    lastEncoder = encoder;
+    armEstimateUpdate(arm, simArmPot(world) * ARM_RADIANS_PER_POT_COUNT, armTravel, SIM_POLICY_TICK);
+
+    pid.gains.outputMax = contactBrake(contact, now, target.width, BASE_DISTANCE_WIDTH, forwardGains.outputMax, controlGains);
+    float teacher[POLICY_OUTPUTS] = {visionTurnPower(visible, target.x_middle_coord), visible ? pidStep(pid, target.width, SIM_POLICY_TICK) : 0, 0};
+    bool go = visible && pickupUpdate(plan, cameraModel, contact, now, target.width, target.y_middle_coord, arm.angle, controlGains.armP);
+    teacher[2] = go ? std::clamp(armPower((plan.grabAngle - arm.angle) * 180 / M_PI), -127.0f, 127.0f) : 0;
+
+    float features[POLICY_INPUTS];
+    policyFeatures(cameraModel, visible, target.x_middle_coord, target.y_middle_coord, target.width,
+      contactTimeTo(contact, target.width, BASE_DISTANCE_WIDTH), arm.angle, features);
+    float powers[POLICY_OUTPUTS] = {teacher[0], teacher[1], teacher[2]};
+    if(driver == POLICY_FLOAT)
+    {
+      SimPolicyActivations a;
+      simPolicyForward(*net, features, a);
+      for(int o = 0; o < POLICY_OUTPUTS; o++) powers[o] = std::clamp(a.out[o] * 127, -127.0f, 127.0f);
+    }
+    else if(driver == POLICY_INT8)
+    {
+      PolicyCommand command = policyRun(*model, features);
+      powers[0] = command.turn;
+      powers[1] = command.forward;
+      powers[2] = command.arm;
+    }
+    for(int o = 0; o < POLICY_OUTPUTS; o++) stats.error[o] += fabs(powers[o] - teacher[o]);
+    stats.ticks++;
+    if(data && frame) // Only on new frames, the ticks between are nearly the same
+    {
+      SimPolicySample sample;
+      for(int i = 0; i < POLICY_INPUTS; i++) sample.features[i] = features[i];
+      for(int o = 0; o < POLICY_OUTPUTS; o++) sample.powers[o] = teacher[o] / 127;
+      data->push_back(sample);
+    }
+
+    float commands[MOTOR_COUNT] = {powers[0] + powers[1], -powers[0] + powers[1], 0, powers[2]};
+    float resolved[MOTOR_COUNT];
+    for(int motor = 0; motor < MOTOR_COUNT; motor++)
+    {
+      arbiterSubmit(arbiter, (ArbiterMotor)motor, SOURCE_ASSIST, MODE_POWER, commands[motor], false, now, ARBITER_TIMEOUT);
+      ArbiterMode mode;
+      int32_t value;
+      arbiterResolve(arbiter, (ArbiterMotor)motor, now, &mode, &value);
+      resolved[motor] = arbiter.outputs[motor].value;
+    }
+    compensation.lastCommand = resolved[MOTOR_ARM];
+    simDrive(world, resolved[MOTOR_BASE_LEFT], resolved[MOTOR_BASE_RIGHT], resolved[MOTOR_BASE_H], SIM_POLICY_TICK);
+    simDriveArm(world, resolved[MOTOR_ARM], SIM_POLICY_TICK);
+
+    simTruth(world, &imageX, &imageY, &width);
+    if(fabs(width - BASE_DISTANCE_WIDTH) <= PICKUP_ARRIVED && fabs(world.armAngle - grabAngle) <= PICKUP_ARM_CLOSE)
+    {
+      stats.balls++;
+      stats.seconds += tick * SIM_POLICY_TICK;
+      return;
+    }
+  }
+}
+
+void simPolicy()
+{
+  std::mt19937 random(1);
+  static SimPolicyNet net;
+  static MlpModel model;
+  simPolicyInit(net, random);
+  std::vector<SimPolicySample> data;
+
+  printf("training on %d pickups from 36-96in, up to 0.3 rad off to the side\n", SIM_POLICY_TRAIN_BALLS);
+  printf("round     driver   samples  RMS error (/127)  balls\n");
+  for(int round = 0; round <= SIM_POLICY_DAGGER; round++)
+  {
+    SimPolicyStats stats = {};
+    for(uint32_t seed = 1; seed <= SIM_POLICY_TRAIN_BALLS; seed++)
+    {
+      simPolicyBall(round ? POLICY_FLOAT : POLICY_TEACHER, &net, nullptr, seed + round * SIM_POLICY_TRAIN_BALLS, stats, &data);
+    }
+    float rms = simPolicyTrain(net, data, random);
+    printf("%5d  %9s  %8zu  %16.4f  %5d\n", round, round ? "float" : "teacher", data.size(), rms, stats.balls);
+  }
+
+  simPolicyQuantize(net, data, model);
+  static uint8_t file[sizeof(MlpModel)];
+  uint32_t size = mlpSave(model, file, sizeof(file));
+  FILE* out = fopen(POLICY_FILE_NAME, "wb");
+  if(out != NULL)
+  {
+    fwrite(file, 1, size, out);
+    fclose(out);
+    printf("Wrote %s (%u bytes), copy it to the robot's SD card\n", POLICY_FILE_NAME, size);
+  }
+  static MlpModel loaded;
+  if(!mlpLoad(loaded, file, size))
+  {
+    printf("%s didn't load back\n", POLICY_FILE_NAME);
+    return;
+  }
+
+  printf("\n%d held out pickups\n", SIM_POLICY_TEST_BALLS);
+  printf("driver   balls  s/ball  mean |power - teacher's|: turn  forward  arm\n");
+  for(int driver = 0; driver < POLICY_DRIVERS; driver++)
+  {
+    SimPolicyStats stats = {};
+    for(uint32_t seed = 1; seed <= SIM_POLICY_TEST_BALLS; seed++)
+    {
+      simPolicyBall((SimPolicyDriver)driver, &net, &loaded, 100000 + seed, stats, nullptr);
+    }
+    printf("%-7s  %5d  %6.2f  %30.2f  %7.2f  %3.2f\n", simPolicyNames[driver], stats.balls, stats.balls ? stats.seconds / stats.balls : 0,
+      stats.error[0] / stats.ticks, stats.error[1] / stats.ticks, stats.error[2] / stats.ticks);
+  }
+
+  // The int8 net against the float one it came from, on the training features
+  double quantError = 0;
+  for(const SimPolicySample& sample : data)
+  {
+    SimPolicyActivations a;
+    simPolicyForward(net, sample.features, a);
+    float outputs[POLICY_OUTPUTS];
+    mlpRun(loaded, sample.features, outputs);
+    for(int o = 0; o < POLICY_OUTPUTS; o++) quantError += fabs(outputs[o] - a.out[o]) * 127;
+  }
+  printf("int8 vs float outputs: %.2f power mean difference\n", quantError / (data.size() * POLICY_OUTPUTS));
+
+  int macs = 0;
+  for(int l = 0; l < loaded.layerCount; l++) macs += loaded.layers[l].inputs * loaded.layers[l].outputs;
+  float sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(int call = 0; call < SIM_POLICY_BENCH; call++)
+  {
+    float outputs[POLICY_OUTPUTS];
+    mlpRun(loaded, data[call % data.size()].features, outputs);
+    sink += outputs[0];
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  simPolicySink = sink;
+  printf("mlpRun: %d multiply-adds, %.0f ns per call on this machine, %zu bytes of model in RAM\n", macs, elapsed.count() / SIM_POLICY_BENCH,
+    sizeof(MlpModel));
+}
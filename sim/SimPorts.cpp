@@ -0,0 +1,200 @@
+#include "Driver/DriverDeviceCache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Reads per smart port, with each task reading its own devices like it used to against motorTask reading
+// everything once a tick for DriverDevices. The brain is one core, with tasks of the same priority taking turns
+// a millisecond at a time, so a task can lose the core halfway through a read and still be holding the port's
+// mutex when another task wants it. That's the busy count: PROS makes the second task wait for it (or fails with
+// EACCES, depending on the call). Each task's reads and work per wake come from the code before and after.
+
+#define SIM_PORTS_SECONDS 60
+#define SIM_PORTS_SLICE 1000 // us, the scheduler tick
+#define SIM_PORTS_READ 5 // us a port's held for a read
+#define SIM_PORTS_RUNS 5 // Different start phases
+
+struct SimPortRead
+{
+  int port;
+  int count;
+};
+
+struct SimPortTask
+{
+  const char* name;
+  uint32_t period; // us
+  uint32_t work; // us of maths, split before and after the reads
+  std::vector<SimPortRead> reads;
+};
+
+struct SimPortJob // Where a task is in its current wake
+{
+  uint32_t nextWake;
+  bool ready;
+  int step; // Reads done so far, work in the middle of them
+  uint32_t left; // us left of the current step
+  bool holding;
+  bool blocked; // Waiting on a port, counted once
+};
+
+static std::vector<int> simPortsSteps(const SimPortTask& task) // One entry per read, by port, -1 for the work
+{
+  std::vector<int> steps;
+  steps.push_back(-1);
+  for(const SimPortRead& read : task.reads)
+  {
+    for(int i = 0; i < read.count; i++) steps.push_back(read.port);
+  }
+  steps.push_back(-1);
+  return steps;
+}
+
+static void simPortsRun(const std::vector<SimPortTask>& tasks, uint32_t seed, PortStats& stats, double* waited)
+{
+  std::mt19937 random(seed);
+  int count = tasks.size();
+  std::vector<std::vector<int>> steps(count);
+  std::vector<SimPortJob> jobs(count);
+  for(int i = 0; i < count; i++)
+  {
+    steps[i] = simPortsSteps(tasks[i]);
+    jobs[i] = {};
+    jobs[i].nextWake = std::uniform_int_distribution<uint32_t>(0, tasks[i].period - 1)(random);
+  }
+  int holder[PORT_COUNT];
+  for(int& h : holder) h = -1;
+  std::vector<int> queue; // Round robin order of the ready tasks
+  int running = -1;
+
+  for(uint32_t t = 0; t < SIM_PORTS_SECONDS * 1000000u; t++)
+  {
+    for(int i = 0; i < count; i++)
+    {
+      if(!jobs[i].ready && t >= jobs[i].nextWake)
+      {
+        jobs[i].ready = true;
+        jobs[i].step = 0;
+        jobs[i].left = tasks[i].work / 2;
+        jobs[i].nextWake += tasks[i].period;
+        queue.push_back(i);
+      }
+    }
+    if(t % SIM_PORTS_SLICE == 0 && running >= 0 && queue.size() > 1) // Its turn's up, to the back
+    {
+      queue.erase(std::find(queue.begin(), queue.end(), running));
+      queue.push_back(running);
+      running = -1;
+    }
+
+    running = -1;
+    for(int i : queue) // First in line that isn't waiting on a port
+    {
+      SimPortJob& job = jobs[i];
+      int port = steps[i][job.step];
+      if(port >= 0 && !job.holding)
+      {
+        if(holder[port] >= 0 && holder[port] != i)
+        {
+          if(!job.blocked)
+          {
+            portCount(stats, port, 0, true);
+            job.blocked = true;
+          }
+          *waited += 1;
+          continue;
+        }
+        holder[port] = i;
+        job.holding = true;
+        job.blocked = false;
+        job.left = SIM_PORTS_READ;
+        portCount(stats, port, 1, false);
+      }
+      running = i;
+      break;
+    }
+    if(running < 0)
+    {
+      continue;
+    }
+
+    SimPortJob& job = jobs[running];
+    if(job.left > 0)
+    {
+      job.left--;
+    }
+    while(job.left == 0 && job.ready)
+    {
+      int port = steps[running][job.step];
+      if(port >= 0)
+      {
+        holder[port] = -1;
+        job.holding = false;
+      }
+      job.step++;
+      if(job.step >= (int)steps[running].size())
+      {
+        job.ready = false;
+        queue.erase(std::find(queue.begin(), queue.end(), running));
+        break;
+      }
+      if(steps[running][job.step] < 0)
+      {
+        job.left = tasks[running].work - tasks[running].work / 2;
+      }
+      else
+      {
+        break; // Takes the port next time round
+      }
+    }
+  }
+}
+
+void simPorts()
+{
+  // Ports: 1 left, 5 right, 2 h, 3 arm, 6 vision, 0 the controller. The pot and ultrasonic are on the ADI, not smart ports
+  std::vector<SimPortTask> before = {
+    {"motors", 10000, 60, {{1, 4}, {5, 4}, {2, 4}, {3, 4}}}, // get_power, velocity, current, faults
+    {"base", 10000, 150, {{1, 1}, {5, 1}, {2, 1}, {0, 4}}}, // Positions, three sticks and DOWN
+    {"odometry", 10000, 30, {{1, 1}, {5, 1}, {2, 1}}},
+    {"arm", 10000, 80, {{3, 1}, {0, 1}}}, // Position, LEFT
+    {"opcontrol", 100000, 5, {{0, 1}}}, // X
+    {"vision", 20000, 100, {{6, 4}}},
+    {"range", 10000, 40, {}},
+  };
+  std::vector<SimPortTask> after = {
+    {"motors", 10000, 80, {{1, 5}, {5, 5}, {2, 5}, {3, 5}, {0, 8}}}, // Positions too, four sticks and four buttons
+    {"base", 10000, 150, {}},
+    {"odometry", 10000, 30, {}},
+    {"arm", 10000, 80, {}},
+    {"opcontrol", 100000, 5, {}},
+    {"vision", 20000, 100, {{6, 4}}},
+    {"range", 10000, 40, {}},
+  };
+
+  PortStats stats[2] = {};
+  double waited[2] = {};
+  for(uint32_t run = 1; run <= SIM_PORTS_RUNS; run++)
+  {
+    simPortsRun(before, run, stats[0], &waited[0]);
+    simPortsRun(after, run, stats[1], &waited[1]);
+  }
+
+  double seconds = (double)SIM_PORTS_SECONDS * SIM_PORTS_RUNS;
+  printf("%d runs of %d s, 1ms round robin, %dus per read\n", SIM_PORTS_RUNS, SIM_PORTS_SECONDS, SIM_PORTS_READ);
+  printf("port          reads/s before  after   found busy/min before  after\n");
+  const char* names[PORT_COUNT] = {"controller", "1 left", "2 h", "3 arm", 0, "5 right", "6 vision"};
+  for(int port = 0; port < PORT_COUNT; port++)
+  {
+    if(stats[0].reads[port] == 0 && stats[1].reads[port] == 0)
+    {
+      continue;
+    }
+    printf("%-10s  %16.0f  %5.0f  %21.2f  %5.2f\n", names[port] ? names[port] : "?", stats[0].reads[port] / seconds,
+      stats[1].reads[port] / seconds, stats[0].busy[port] * 60 / seconds, stats[1].busy[port] * 60 / seconds);
+  }
+  printf("%-10s  %16.0f  %5.0f  %21.2f  %5.2f\n", "all", portTotal(stats[0], false) / seconds, portTotal(stats[1], false) / seconds,
+    portTotal(stats[0], true) * 60 / seconds, portTotal(stats[1], true) * 60 / seconds);
+  printf("time spent waiting on a port: %.1f us/s before, %.1f us/s after\n", waited[0] / seconds, waited[1] / seconds);
+}
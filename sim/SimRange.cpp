@@ -0,0 +1,162 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverRange.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include "Driver/DriverControlLaws.hpp"
+#include "Driver/DriverPid.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Ball distance on the final approach, with the ball partly hidden now and then (something in front
+// of it cuts its width down for a few frames). First how far off each way of measuring it is, then
+// where the forward assist stops when it's fed the raw width or the fused range
+
+#define SIM_RANGE_TICK 0.01
+#define SIM_RANGE_EPISODES 300
+#define SIM_RANGE_EPISODE_TICKS 1000
+#define SIM_RANGE_FINAL 36 // Inches, the part of the approach the errors are measured over
+#define SIM_OCCLUDE_START 0.03 // Chance per frame something starts covering part of the ball
+#define SIM_OCCLUDE_END 0.15
+#define SIM_BALL_SIG 2
+
+enum SimRangeSource { RANGE_WIDTH, RANGE_SIZE, RANGE_ULTRASONIC, RANGE_FUSED, RANGE_SOURCE_COUNT };
+const char* simRangeNames[RANGE_SOURCE_COUNT] = {"width", "max(w,h)", "ultrasonic", "fused"};
+
+struct SimRangeStats
+{
+  double squared[RANGE_SOURCE_COUNT];
+  long samples[RANGE_SOURCE_COUNT];
+  double stopError; // Inches from the grab distance at the end, summed
+  double holdSquared; // Inches from the grab distance over the last 2 seconds, squared
+  long holdSamples;
+};
+
+
+void simRangeEpisode(bool fused, uint32_t seed, SimRangeStats& stats)
+{
+  SimWorld world;
+  simReset(world, seed);
+  std::uniform_real_distribution<float> range(36, 96);
+  std::uniform_real_distribution<float> bearing(-0.1, 0.1);
+  std::uniform_real_distribution<float> chance(0, 1);
+  std::uniform_real_distribution<float> covered(0.4, 0.8); // How much of the width is left showing
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+
+  TargetEstimate target = {};
+  RangeEstimate estimate = {};
+  PidController pid = {{BASE_P * 5, BASE_FORWARD_I, BASE_FORWARD_D, BASE_FORWARD_D_FILTER, 1, BASE_FORWARD_ANTI_WINDUP, -127, 127}, BASE_DISTANCE_WIDTH};
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+  bool occluded = false;
+  float showing = 1;
+  float grabDepth = BALL_DIAMETER * cameraModel.focalLength / BASE_DISTANCE_WIDTH;
+  RobotPose lastOdometry = world.odometry;
+
+  for(int tick = 1; tick <= SIM_RANGE_EPISODE_TICKS; tick++)
+  {
+    float travel = (world.odometry.x - lastOdometry.x) * cos(world.odometry.heading) + (world.odometry.y - lastOdometry.y) * sin(world.odometry.heading);
+    lastOdometry = world.odometry;
+    rangePredict(estimate, travel, SIM_RANGE_TICK);
+
+    bool newFrame = tick % 2 == 0;
+    if(newFrame)
+    {
+      seen = simSee(world, SIM_BALL_SIG);
+      occluded = occluded ? chance(world.random) > SIM_OCCLUDE_END : chance(world.random) < SIM_OCCLUDE_START;
+      if(occluded && seen.signature != VISION_OBJECT_ERR_SIG)
+      {
+        showing = covered(world.random);
+        int hidden = lround(seen.width * (1 - showing));
+        seen.width -= hidden; // Covered from the left
+        seen.left_coord += hidden;
+        seen.x_middle_coord += hidden / 2;
+      }
+      targetEstimateUpdate(target, world.odometry, seen, world.time, controlGains);
+      rangeVisionUpdate(estimate, cameraModel, seen, world.time, controlGains);
+    }
+    pros::c::vision_object_s_t ball = seen;
+    if(ball.signature == VISION_OBJECT_ERR_SIG)
+    {
+      targetEstimatePredict(target, world.odometry, world.time, &ball, controlGains);
+    }
+    bool visible = ball.signature != VISION_OBJECT_ERR_SIG;
+
+    float ultrasonic = simUltrasonic(world) / 2.54;
+    if(visible)
+    {
+      rangeUltrasonicUpdate(estimate, cameraModel, ultrasonic, ball.x_middle_coord, world.time, controlGains);
+    }
+
+    float width = ball.width;
+    if(fused && rangeValid(estimate, world.time) && estimate.depth > BALL_DIAMETER)
+    {
+      width = BALL_DIAMETER * cameraModel.focalLength / estimate.depth; // Back into pixels for the same PID
+    }
+    float turn = visionTurnPower(visible, ball.x_middle_coord);
+    float forward = visible ? pidStep(pid, width, SIM_RANGE_TICK) : 0;
+    simDrive(world, turn + forward, -turn + forward, 0, SIM_RANGE_TICK);
+
+    float imageX, imageY, trueWidth;
+    if(!simTruth(world, &imageX, &imageY, &trueWidth))
+    {
+      continue;
+    }
+    float depth = BALL_DIAMETER * world.camera.focalLength / trueWidth;
+
+    if(depth < SIM_RANGE_FINAL && newFrame && seen.signature != VISION_OBJECT_ERR_SIG)
+    {
+      float measured[RANGE_SOURCE_COUNT] =
+      {
+        (float)(BALL_DIAMETER * cameraModel.focalLength / seen.width),
+        (float)(BALL_DIAMETER * cameraModel.focalLength / fmax(seen.width, seen.height)),
+        ultrasonic > 0 ? (float)(ultrasonic + BALL_DIAMETER / 2 + ULTRASONIC_MOUNT_FORWARD - cameraModel.mountForward) : NAN,
+        rangeValid(estimate, world.time) ? estimate.depth : NAN,
+      };
+      for(int source = 0; source < RANGE_SOURCE_COUNT; source++)
+      {
+        if(!std::isnan(measured[source]))
+        {
+          stats.squared[source] += (measured[source] - depth) * (measured[source] - depth);
+          stats.samples[source]++;
+        }
+      }
+    }
+
+    if(tick > SIM_RANGE_EPISODE_TICKS - 200)
+    {
+      stats.holdSquared += (depth - grabDepth) * (depth - grabDepth);
+      stats.holdSamples++;
+    }
+    if(tick == SIM_RANGE_EPISODE_TICKS)
+    {
+      stats.stopError += fabs(depth - grabDepth);
+    }
+  }
+}
+
+
+void simRange()
+{
+  SimRangeStats stats[2] = {};
+  for(int fused = 0; fused < 2; fused++)
+  {
+    for(uint32_t episode = 1; episode <= SIM_RANGE_EPISODES; episode++)
+    {
+      simRangeEpisode(fused, episode, stats[fused]);
+    }
+  }
+
+  printf("range under %d in  RMS error (in)  readings used\n", SIM_RANGE_FINAL);
+  for(int source = 0; source < RANGE_SOURCE_COUNT; source++)
+  {
+    printf("%-16s  %14.2f  %13ld\n", simRangeNames[source], sqrt(stats[1].squared[source] / stats[1].samples[source]), stats[1].samples[source]);
+  }
+  printf("forward assist on  stop error (in)  hold RMS (in)\n");
+  for(int fused = 0; fused < 2; fused++)
+  {
+    printf("%-17s  %15.2f  %13.2f\n", fused ? "fused range" : "width", stats[fused].stopError / SIM_RANGE_EPISODES,
+      sqrt(stats[fused].holdSquared / stats[fused].holdSamples));
+  }
+}
@@ -0,0 +1,162 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverTargetEstimate.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Compares three ways of handling the ball when the sensor loses it:
+//  none  - what we used to do, the assist stops as soon as the ball isn't seen
+//  image - hold the last image position for the coast time (controlGains.targetCoastTime)
+//  field - hold the ball on the field and project it with odometry (DriverTargetEstimate)
+
+#define SIM_BALL_SIG 2
+#define SIM_BASE_P 0.6 // Same as BASE_P in DriverVisionTracking
+#define SIM_FRAME 0.02 // Seconds per vision frame
+#define SIM_EPISODES 500
+
+enum SimTracker { TRACK_NONE, TRACK_IMAGE, TRACK_FIELD, TRACK_COUNT };
+const char* simTrackerNames[TRACK_COUNT] = {"none", "image", "field"};
+
+struct SimTrackerState
+{
+  pros::c::vision_object_s_t lastSeen;
+  uint32_t lastSeenTime;
+  TargetEstimate estimate;
+};
+
+pros::c::vision_object_s_t simTrack(SimTracker tracker, SimTrackerState& state, const SimWorld& world, const pros::c::vision_object_s_t& seen)
+// Same logic as calculateTarget(), for each of the trackers
+{
+  if(seen.signature != VISION_OBJECT_ERR_SIG)
+  {
+    state.lastSeen = seen;
+    state.lastSeenTime = world.time;
+    targetEstimateUpdate(state.estimate, world.odometry, seen, world.time, controlGains);
+    return seen;
+  }
+
+  pros::c::vision_object_s_t target = seen;
+  if(tracker == TRACK_IMAGE && state.lastSeenTime != 0 && world.time - state.lastSeenTime <= controlGains.targetCoastTime)
+  {
+    target = state.lastSeen;
+  }
+  else if(tracker == TRACK_FIELD)
+  {
+    targetEstimatePredict(state.estimate, world.odometry, world.time, &target, controlGains);
+  }
+  return target;
+}
+
+
+void simPlaceBall(SimWorld& world)
+{
+  std::uniform_real_distribution<float> range(24, 72);
+  std::uniform_real_distribution<float> bearing(-0.4, 0.4);
+  float distance = range(world.random);
+  float angle = bearing(world.random);
+  world.ballX = distance * cos(angle);
+  world.ballY = distance * sin(angle);
+}
+
+
+float simDropoutError(SimTracker tracker, uint32_t seed, int* framesCovered, int* framesLost)
+// The driver swings the robot left and right while driving forward. Returns the squared x error summed
+// over every frame the ball was in the FOV but not detected, and a tracker reported it anyway
+{
+  SimWorld world;
+  SimTrackerState state = {};
+  simReset(world, seed);
+  simPlaceBall(world);
+
+  std::uniform_real_distribution<float> swing(1.5, 4.0);
+  float swingSpeed = swing(world.random); // Radians/s of the swing cycle
+  float squaredError = 0;
+
+  for(int frame = 0; frame < 200; frame++)
+  {
+    float turn = 90 * sin(swingSpeed * frame * SIM_FRAME);
+    simDrive(world, 20 + turn, 20 - turn, 0, SIM_FRAME);
+
+    pros::c::vision_object_s_t seen = simSee(world, SIM_BALL_SIG);
+    pros::c::vision_object_s_t target = simTrack(tracker, state, world, seen);
+
+    float imageX, imageY, width;
+    if(seen.signature != VISION_OBJECT_ERR_SIG || !simTruth(world, &imageX, &imageY, &width) || imageX < 0 || imageX >= VISION_FOV_WIDTH)
+    {
+      continue;
+    }
+    (*framesLost)++;
+    if(target.signature != VISION_OBJECT_ERR_SIG)
+    {
+      (*framesCovered)++;
+      squaredError += (target.x_middle_coord - imageX) * (target.x_middle_coord - imageX);
+    }
+  }
+  return squaredError;
+}
+
+
+float simReacquireTime(SimTracker tracker, uint32_t seed)
+// The robot is bumped hard enough to lose the ball, then only the turn assist drives.
+// Returns the seconds after the bump until the ball is centred again, or -1 if it never is
+{
+  SimWorld world;
+  SimTrackerState state = {};
+  simReset(world, seed);
+  simPlaceBall(world);
+
+  std::uniform_int_distribution<int> side(0, 1);
+  float bump = side(world.random) ? 127 : -127;
+
+  for(int frame = 0; frame < 250; frame++)
+  {
+    pros::c::vision_object_s_t target = simTrack(tracker, state, world, simSee(world, SIM_BALL_SIG));
+
+    float turn = 0;
+    if(frame >= 10 && frame < 25)
+    {
+      turn = bump;
+    }
+    else if(target.signature != VISION_OBJECT_ERR_SIG)
+    {
+      turn = (target.x_middle_coord - VISION_FOV_WIDTH/2) * SIM_BASE_P;
+    }
+    simDrive(world, turn, -turn, 0, SIM_FRAME);
+
+    float imageX, imageY, width;
+    if(frame >= 25 && simTruth(world, &imageX, &imageY, &width) && fabs(imageX - VISION_FOV_WIDTH/2) < 15)
+    {
+      return (frame - 25) * SIM_FRAME;
+    }
+  }
+  return -1;
+}
+
+
+void simTargetTracking()
+{
+  printf("tracker  lost-frame covered  lost-frame x RMS (px)  reacquired  mean reacquire (s)\n");
+  for(int tracker = 0; tracker < TRACK_COUNT; tracker++)
+  {
+    int framesCovered = 0;
+    int framesLost = 0;
+    float squaredError = 0;
+    int reacquired = 0;
+    float reacquireTime = 0;
+
+    for(uint32_t episode = 1; episode <= SIM_EPISODES; episode++)
+    {
+      squaredError += simDropoutError((SimTracker)tracker, episode, &framesCovered, &framesLost);
+
+      float time = simReacquireTime((SimTracker)tracker, episode);
+      if(time >= 0)
+      {
+        reacquired++;
+        reacquireTime += time;
+      }
+    }
+
+    printf("%-7s  %17.1f%%  %21.1f  %9.1f%%  %18.2f\n", simTrackerNames[tracker],
+      100.0 * framesCovered / framesLost, framesCovered ? sqrt(squaredError / framesCovered) : 0.0,
+      100.0 * reacquired / SIM_EPISODES, reacquired ? reacquireTime / reacquired : 0.0);
+  }
+}
@@ -0,0 +1,309 @@
+#include "SimBatch.hpp"
+#include "Driver/DriverParams.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Tunes every parameter in DriverParams' table together with CMA-ES, instead of one gain at a time by hand.
+// Each candidate set of gains is scored on a batch of simulated approaches, a generation's candidates are
+// spread over a pool of threads, and the best set is written to params.txt for the robot's SD card.
+// The search works on each parameter scaled to 0-1 between its min and max, so one step size fits them all.
+
+#define SIM_TUNE_ROBOTS 256 // Robots per candidate
+#define SIM_TUNE_TICKS 1500 // 15 simulated seconds each
+#define SIM_TUNE_GENERATIONS 40
+#define SIM_TUNE_SIGMA 0.15 // Starting step, as a fraction of each parameter's range
+#define SIM_TUNE_ARM_WEIGHT 0.02 // Seconds of approach one degree of arm error is worth
+#define SIM_TUNE_CHECK_SEEDS 8 // Fresh batches the default and tuned gains are compared on at the end
+#define SIM_TUNE_MAX_PARAMS 16
+
+struct SimTuneScore
+{
+  double cost;
+  double arrived; // Fraction
+  double approach; // Mean seconds, failures counted as SIM_EPISODE_TIMEOUT
+  double armError; // Mean degrees off the grab angle on arrival
+};
+
+SimTuneScore simTuneScore(const ControlGains& gains, uint32_t seed, int robots)
+{
+  SimBatch batch;
+  simBatchReset(batch, robots, seed);
+  batch.gains = gains;
+  for(int tick = 0; tick < SIM_TUNE_TICKS; tick++)
+  {
+    simBatchStep(batch);
+  }
+
+  SimTuneScore score;
+  long episodes = batch.episodes > 0 ? batch.episodes : 1;
+  score.arrived = (double)batch.arrivals / episodes;
+  score.approach = (batch.arrivalTime + (batch.episodes - batch.arrivals) * SIM_EPISODE_TIMEOUT) / episodes;
+  score.armError = batch.arrivals > 0 ? batch.armError / batch.arrivals : 0;
+  score.cost = (batch.episodes > 0 ? score.approach : SIM_EPISODE_TIMEOUT) + score.armError * SIM_TUNE_ARM_WEIGHT;
+  return score;
+}
+
+static ControlGains simTuneGains(const double* unit) // From the 0-1 search space, clamped into range
+{
+  ControlGains gains = controlGains;
+  for(int p = 0; p < paramCount(); p++)
+  {
+    const TunableParam& param = paramAt(p);
+    double clamped = unit[p] < 0 ? 0 : (unit[p] > 1 ? 1 : unit[p]);
+    gains.*param.field = param.min + clamped * (param.max - param.min);
+  }
+  return gains;
+}
+
+static void simTuneEigen(int n, double matrix[][SIM_TUNE_MAX_PARAMS], double* values, double vectors[][SIM_TUNE_MAX_PARAMS])
+// Cyclic Jacobi on a symmetric matrix. Columns of vectors are the eigenvectors. Fine at this size
+{
+  double a[SIM_TUNE_MAX_PARAMS][SIM_TUNE_MAX_PARAMS];
+  for(int i = 0; i < n; i++)
+  {
+    for(int j = 0; j < n; j++)
+    {
+      a[i][j] = matrix[i][j];
+      vectors[i][j] = i == j;
+    }
+  }
+  for(int sweep = 0; sweep < 50; sweep++)
+  {
+    double off = 0;
+    for(int i = 0; i < n; i++) for(int j = i + 1; j < n; j++) off += a[i][j] * a[i][j];
+    if(off < 1e-30)
+    {
+      break;
+    }
+    for(int p = 0; p < n; p++)
+    {
+      for(int q = p + 1; q < n; q++)
+      {
+        if(fabs(a[p][q]) < 1e-300)
+        {
+          continue;
+        }
+        double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+        double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+        double c = 1 / sqrt(t * t + 1), s = t * c;
+        for(int k = 0; k < n; k++) // Rotate columns p and q, then rows
+        {
+          double kp = a[k][p], kq = a[k][q];
+          a[k][p] = c * kp - s * kq;
+          a[k][q] = s * kp + c * kq;
+        }
+        for(int k = 0; k < n; k++)
+        {
+          double pk = a[p][k], qk = a[q][k];
+          a[p][k] = c * pk - s * qk;
+          a[q][k] = s * pk + c * qk;
+        }
+        for(int k = 0; k < n; k++)
+        {
+          double kp = vectors[k][p], kq = vectors[k][q];
+          vectors[k][p] = c * kp - s * kq;
+          vectors[k][q] = s * kp + c * kq;
+        }
+      }
+    }
+  }
+  for(int i = 0; i < n; i++)
+  {
+    values[i] = a[i][i] > 1e-20 ? a[i][i] : 1e-20;
+  }
+}
+
+
+void simTune()
+{
+  using Clock = std::chrono::steady_clock;
+  const int n = paramCount();
+  const int lambda = 4 + (int)(3 * log(n)); // Candidates per generation
+  const int mu = lambda / 2; // The best half make the next mean
+
+  // Standard CMA-ES settings (Hansen's tutorial)
+  double weights[64];
+  double weightSum = 0, weightSquares = 0;
+  for(int i = 0; i < mu; i++)
+  {
+    weights[i] = log(mu + 0.5) - log(i + 1);
+    weightSum += weights[i];
+  }
+  for(int i = 0; i < mu; i++)
+  {
+    weights[i] /= weightSum;
+    weightSquares += weights[i] * weights[i];
+  }
+  const double muEff = 1 / weightSquares;
+  const double cSigma = (muEff + 2) / (n + muEff + 5);
+  const double dSigma = 1 + 2 * fmax(0, sqrt((muEff - 1) / (n + 1)) - 1) + cSigma;
+  const double cC = (4 + muEff / n) / (n + 4 + 2 * muEff / n);
+  const double c1 = 2 / ((n + 1.3) * (n + 1.3) + muEff);
+  const double cMu = fmin(1 - c1, 2 * (muEff - 2 + 1 / muEff) / ((n + 2) * (n + 2) + muEff));
+  const double chiN = sqrt(n) * (1 - 1.0 / (4 * n) + 1.0 / (21 * n * n));
+
+  double mean[SIM_TUNE_MAX_PARAMS], pathSigma[SIM_TUNE_MAX_PARAMS] = {}, pathC[SIM_TUNE_MAX_PARAMS] = {};
+  double covariance[SIM_TUNE_MAX_PARAMS][SIM_TUNE_MAX_PARAMS], basis[SIM_TUNE_MAX_PARAMS][SIM_TUNE_MAX_PARAMS];
+  double scale[SIM_TUNE_MAX_PARAMS]; // Square roots of the eigenvalues
+  double sigma = SIM_TUNE_SIGMA;
+  for(int i = 0; i < n; i++)
+  {
+    const TunableParam& param = paramAt(i);
+    mean[i] = (controlGains.*param.field - param.min) / (param.max - param.min); // Start from the defines
+    for(int j = 0; j < n; j++)
+    {
+      covariance[i][j] = i == j;
+      basis[i][j] = i == j;
+    }
+    scale[i] = 1;
+  }
+
+  std::mt19937 random(1);
+  std::normal_distribution<double> normal(0, 1);
+  std::vector<std::vector<double>> steps(lambda, std::vector<double>(n)), candidates(lambda, std::vector<double>(n));
+  std::vector<double> costs(lambda);
+
+  int workers = std::max(1u, std::thread::hardware_concurrency());
+  printf("%d parameters, %d candidates a generation, %d robots x %.0f s each, %d threads\n", n, lambda, SIM_TUNE_ROBOTS,
+    SIM_TUNE_TICKS * SIM_TICK, workers);
+  printf("generation  best cost  mean cost  step\n");
+  Clock::time_point start = Clock::now();
+
+  for(int generation = 0; generation < SIM_TUNE_GENERATIONS; generation++)
+  {
+    for(int k = 0; k < lambda; k++)
+    {
+      double z[SIM_TUNE_MAX_PARAMS];
+      for(int i = 0; i < n; i++) z[i] = scale[i] * normal(random);
+      for(int i = 0; i < n; i++)
+      {
+        double step = 0;
+        for(int j = 0; j < n; j++) step += basis[i][j] * z[j];
+        steps[k][i] = step;
+        candidates[k][i] = mean[i] + sigma * step;
+      }
+    }
+
+    // Same seed for every candidate in a generation, so they're compared on the same approaches
+    uint32_t seed = 1000 + generation;
+    std::atomic<int> next(0);
+    auto work = [&]()
+    {
+      for(int k = next++; k < lambda; k = next++)
+      {
+        double outside = 0; // Past the min/max gets scored at the edge plus a penalty, which pulls the search back in
+        for(int i = 0; i < n; i++)
+        {
+          double over = candidates[k][i] - fmin(1, fmax(0, candidates[k][i]));
+          outside += over * over;
+        }
+        costs[k] = simTuneScore(simTuneGains(candidates[k].data()), seed, SIM_TUNE_ROBOTS).cost + outside * 10;
+      }
+    };
+    std::vector<std::thread> pool;
+    for(int w = 1; w < workers; w++) pool.emplace_back(work);
+    work();
+    for(std::thread& thread : pool) thread.join();
+
+    std::vector<int> order(lambda);
+    for(int k = 0; k < lambda; k++) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return costs[a] < costs[b]; });
+    double meanCost = 0;
+    for(double cost : costs) meanCost += cost / lambda;
+
+    // New mean, and the step it took in the unscaled space
+    double meanStep[SIM_TUNE_MAX_PARAMS] = {};
+    for(int r = 0; r < mu; r++)
+    {
+      for(int i = 0; i < n; i++) meanStep[i] += weights[r] * steps[order[r]][i];
+    }
+    for(int i = 0; i < n; i++) mean[i] += sigma * meanStep[i];
+
+    // Evolution paths. The sigma one needs C^-1/2 * meanStep = B D^-1 B^T meanStep
+    double whitened[SIM_TUNE_MAX_PARAMS];
+    for(int j = 0; j < n; j++)
+    {
+      double dot = 0;
+      for(int i = 0; i < n; i++) dot += basis[i][j] * meanStep[i];
+      whitened[j] = dot / scale[j];
+    }
+    double pathLength = 0;
+    for(int i = 0; i < n; i++)
+    {
+      double rotated = 0;
+      for(int j = 0; j < n; j++) rotated += basis[i][j] * whitened[j];
+      pathSigma[i] = (1 - cSigma) * pathSigma[i] + sqrt(cSigma * (2 - cSigma) * muEff) * rotated;
+      pathLength += pathSigma[i] * pathSigma[i];
+    }
+    pathLength = sqrt(pathLength);
+    bool stalled = pathLength / sqrt(1 - pow(1 - cSigma, 2 * (generation + 1))) / chiN < 1.4 + 2.0 / (n + 1);
+    for(int i = 0; i < n; i++)
+    {
+      pathC[i] = (1 - cC) * pathC[i] + (stalled ? sqrt(cC * (2 - cC) * muEff) * meanStep[i] : 0);
+    }
+
+    // Covariance: rank one from the path, rank mu from the best steps
+    for(int i = 0; i < n; i++)
+    {
+      for(int j = 0; j < n; j++)
+      {
+        double rankMu = 0;
+        for(int r = 0; r < mu; r++) rankMu += weights[r] * steps[order[r]][i] * steps[order[r]][j];
+        covariance[i][j] = (1 - c1 - cMu) * covariance[i][j] + c1 * (pathC[i] * pathC[j] + (stalled ? 0 : cC * (2 - cC) * covariance[i][j]))
+          + cMu * rankMu;
+      }
+    }
+    sigma *= exp(cSigma / dSigma * (pathLength / chiN - 1));
+    simTuneEigen(n, covariance, scale, basis);
+    for(int i = 0; i < n; i++) scale[i] = sqrt(scale[i]);
+
+    printf("%10d  %9.3f  %9.3f  %.4f\n", generation, costs[order[0]], meanCost, sigma);
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  printf("%d candidates scored in %.1f s\n", lambda * SIM_TUNE_GENERATIONS, seconds);
+
+  // The mean is what CMA-ES trusts, the best single candidate was partly luck. Checked on approaches it never saw
+  ControlGains tuned = simTuneGains(mean);
+  SimTuneScore before = {}, after = {};
+  for(int check = 0; check < SIM_TUNE_CHECK_SEEDS; check++)
+  {
+    SimTuneScore a = simTuneScore(controlGains, 90000 + check, SIM_TUNE_ROBOTS * 4);
+    SimTuneScore b = simTuneScore(tuned, 90000 + check, SIM_TUNE_ROBOTS * 4);
+    before.cost += a.cost / SIM_TUNE_CHECK_SEEDS;
+    before.arrived += a.arrived / SIM_TUNE_CHECK_SEEDS;
+    before.approach += a.approach / SIM_TUNE_CHECK_SEEDS;
+    before.armError += a.armError / SIM_TUNE_CHECK_SEEDS;
+    after.cost += b.cost / SIM_TUNE_CHECK_SEEDS;
+    after.arrived += b.arrived / SIM_TUNE_CHECK_SEEDS;
+    after.approach += b.approach / SIM_TUNE_CHECK_SEEDS;
+    after.armError += b.armError / SIM_TUNE_CHECK_SEEDS;
+  }
+
+  printf("gains     ");
+  int widths[SIM_TUNE_MAX_PARAMS]; // Each column as wide as its name
+  for(int p = 0; p < n; p++) widths[p] = std::max(8, (int)strlen(paramAt(p).name));
+  for(int p = 0; p < n; p++) printf("  %*s", widths[p], paramAt(p).name);
+  printf("  arrived  approach (s)  arm error (deg)   cost\n");
+  printf("defines   ");
+  for(int p = 0; p < n; p++) printf("  %*.3f", widths[p], controlGains.*paramAt(p).field);
+  printf("  %6.1f%%  %12.2f  %15.1f  %5.2f\n", 100 * before.arrived, before.approach, before.armError, before.cost);
+  printf("tuned     ");
+  for(int p = 0; p < n; p++) printf("  %*.3f", widths[p], tuned.*paramAt(p).field);
+  printf("  %6.1f%%  %12.2f  %15.1f  %5.2f\n", 100 * after.arrived, after.approach, after.armError, after.cost);
+
+  char text[512];
+  paramsFormat(tuned, text, sizeof(text));
+  FILE* file = fopen(PARAMS_FILE_NAME, "w");
+  if(file != NULL)
+  {
+    fputs(text, file);
+    fclose(file);
+    printf("Wrote %s, copy it to the robot's SD card\n", PARAMS_FILE_NAME);
+  }
+}
@@ -0,0 +1,140 @@
+#include "SimWorld.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverRange.hpp"
+#include <algorithm>
+#include <cmath>
+
+void simReset(SimWorld& world, uint32_t seed)
+{
+  world.pose = {0, 0, 0};
+  world.odometry = world.pose;
+  world.leftSpeed = 0;
+  world.rightSpeed = 0;
+  world.strafeSpeed = 0;
+  world.armAngle = 0;
+  world.armSpeed = 0;
+  world.armMotorAngle = -SIM_ARM_BACKLASH/2; // Resting down on the stop
+  world.ballX = 48;
+  world.ballY = 0;
+  world.camera = cameraModel;
+  world.droppingOut = false;
+  world.time = 0;
+  world.random.seed(seed);
+}
+
+
+void simDrive(SimWorld& world, float left, float right, float strafe, float dt) // Motor commands are -127 to 127, like Motor::move
+{
+  float response = 1 - exp(-dt / SIM_MOTOR_LAG);
+  world.leftSpeed += (simDeadband(left, SIM_BASE_DEADBAND) / 127 * SIM_BASE_MAX_SPEED - world.leftSpeed) * response;
+  world.rightSpeed += (simDeadband(right, SIM_BASE_DEADBAND) / 127 * SIM_BASE_MAX_SPEED - world.rightSpeed) * response;
+  world.strafeSpeed += (simDeadband(strafe, SIM_BASE_DEADBAND) / 127 * SIM_BASE_MAX_SPEED - world.strafeSpeed) * response;
+
+  float leftTravel = world.leftSpeed * dt;
+  float rightTravel = world.rightSpeed * dt;
+  float strafeTravel = world.strafeSpeed * dt;
+  odometryStep(world.pose, leftTravel, rightTravel, strafeTravel);
+
+  std::normal_distribution<float> slip(1, SIM_ODOMETRY_SLIP);
+  odometryStep(world.odometry, leftTravel * slip(world.random), rightTravel * slip(world.random), strafeTravel * slip(world.random));
+
+  world.time += lround(dt * 1000);
+}
+
+
+void simDriveArm(SimWorld& world, float power, float dt) // Motor 3, -127 to 127
+{
+  float response = 1 - exp(-dt / SIM_ARM_LAG);
+  world.armSpeed += (simDeadband(power, SIM_ARM_DEADBAND) / 127 * SIM_ARM_MAX_SPEED - world.armSpeed) * response;
+  world.armMotorAngle += world.armSpeed * dt;
+
+  // The arm only moves once the motor has taken up the slop on one side or the other
+  world.armAngle = std::clamp(world.armAngle, world.armMotorAngle - (float)SIM_ARM_BACKLASH/2, world.armMotorAngle + (float)SIM_ARM_BACKLASH/2);
+
+  if(world.armAngle < 0 || world.armAngle > SIM_ARM_RANGE) // Hit a hard stop
+  {
+    world.armAngle = std::clamp(world.armAngle, 0.0f, (float)SIM_ARM_RANGE);
+    world.armMotorAngle = std::clamp(world.armMotorAngle, world.armAngle - (float)SIM_ARM_BACKLASH/2, world.armAngle + (float)SIM_ARM_BACKLASH/2);
+    world.armSpeed = 0;
+  }
+}
+
+
+float simArmPot(SimWorld& world) // What armPotAverage would give, ARM_POT_SAMPLES get_value_calibrated reads with the arm down as 0
+{
+  std::normal_distribution<float> noise(0, SIM_POT_NOISE);
+  float counts = world.armAngle * 180 / M_PI / potAngle * potRange;
+  long sum = 0;
+  for(int i = 0; i < ARM_POT_SAMPLES; i++) // The arm barely moves in the 10ms they're spread over
+  {
+    sum += lround(counts + noise(world.random));
+  }
+  return (float)sum / ARM_POT_SAMPLES;
+}
+
+
+double simArmEncoder(const SimWorld& world) // What motor 3's get_position would read, in degrees
+{
+  return (world.armMotorAngle + SIM_ARM_BACKLASH/2) / ARM_RADIANS_PER_MOTOR_DEGREE; // Zeroed with the arm resting down on the stop
+}
+
+
+int32_t simUltrasonic(SimWorld& world) // What ADIUltrasonic::get_value would read, in cm
+{
+  float headingSin = sin(world.pose.heading);
+  float headingCos = cos(world.pose.heading);
+  float dx = world.ballX - (world.pose.x + ULTRASONIC_MOUNT_FORWARD * headingCos);
+  float dy = world.ballY - (world.pose.y + ULTRASONIC_MOUNT_FORWARD * headingSin);
+  float forward = dx * headingCos + dy * headingSin;
+  float left = -dx * headingSin + dy * headingCos;
+  float range = sqrt(forward * forward + left * left) - BALL_DIAMETER / 2;
+
+  std::uniform_real_distribution<float> chance(0, 1);
+  if(chance(world.random) < SIM_ULTRASONIC_GHOST)
+  {
+    return lround(chance(world.random) * 150); // Off the floor, the arm, another robot
+  }
+  if(forward <= 0 || fabs(atan2(left, forward)) > ULTRASONIC_BEAM || range > ULTRASONIC_MAX_RANGE || chance(world.random) < SIM_ULTRASONIC_MISS)
+  {
+    return 0; // Nothing else on the simulated field to echo off
+  }
+  std::normal_distribution<float> noise(0, SIM_ULTRASONIC_NOISE);
+  return lround((range + noise(world.random)) * 2.54);
+}
+
+
+bool simTruth(const SimWorld& world, float* imageX, float* imageY, float* width) // Where the ball really is in the image, even outside the FOV
+{
+  return fieldToImage(world.camera, world.pose, world.ballX, world.ballY, imageX, imageY, width);
+}
+
+
+pros::c::vision_object_s_t simSee(SimWorld& world, uint16_t signature) // One frame from the sensor, as get_by_sig would return it
+{
+  pros::c::vision_object_s_t seen = {};
+  seen.signature = VISION_OBJECT_ERR_SIG;
+
+  float imageX;
+  float imageY;
+  float width;
+  bool inView = simTruth(world, &imageX, &imageY, &width)
+    && imageX >= 0 && imageX < VISION_FOV_WIDTH && imageY >= 0 && imageY < VISION_FOV_HEIGHT;
+
+  std::uniform_real_distribution<float> chance(0, 1);
+  world.droppingOut = world.droppingOut ? chance(world.random) > SIM_DROPOUT_END : chance(world.random) < SIM_DROPOUT_START;
+
+  if(!inView || world.droppingOut)
+  {
+    return seen;
+  }
+
+  std::normal_distribution<float> noise(0, SIM_PIXEL_NOISE);
+  seen.signature = signature;
+  seen.x_middle_coord = lround(imageX + noise(world.random));
+  seen.y_middle_coord = lround(imageY + noise(world.random));
+  seen.width = std::max(1L, lround(width + noise(world.random)));
+  seen.height = seen.width;
+  seen.left_coord = seen.x_middle_coord - seen.width / 2;
+  seen.top_coord = seen.y_middle_coord - seen.height / 2;
+  return seen;
+}
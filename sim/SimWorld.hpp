@@ -0,0 +1,73 @@
+#ifndef _SIM_WORLD_HPP_
+#define _SIM_WORLD_HPP_
+
+#include "Driver/DriverGeometry.hpp"
+#include <cmath>
+#include <random>
+
+#define SIM_BASE_MAX_SPEED (100 * BASE_WHEEL_DIAMETER * M_PI / 60) // Inches/s of a 100rpm (36:1) wheel at full power
+#define SIM_MOTOR_LAG 0.08 // Seconds for the wheels to get most of the way to a new speed
+#define SIM_ODOMETRY_SLIP 0.03 // How far off (fraction) each wheel's measured travel can be
+#define SIM_PIXEL_NOISE 1.5 // Pixels of noise on the ball position
+#define SIM_DROPOUT_START 0.05 // Chance per frame the sensor starts losing a visible ball
+#define SIM_DROPOUT_END 0.2 // Chance per frame it finds it again
+#define SIM_ARM_MAX_SPEED 3.0 // Radians/s of the arm at full power
+#define SIM_ARM_LAG 0.06 // Seconds for the arm to get most of the way to a new speed
+#define SIM_ARM_RANGE (270 * M_PI / 180) // Hard stop to hard stop, same as potAngle
+#define SIM_BASE_DEADBAND 8 // Power the base motors need before they turn at all
+#define SIM_ARM_DEADBAND 15 // Same for the arm, which has its weight and the gears to get going
+#define SIM_ULTRASONIC_NOISE 0.4 // Inches of noise on the ultrasonic
+#define SIM_ULTRASONIC_MISS 0.05 // Chance a ping doesn't come back off the ball
+#define SIM_ULTRASONIC_GHOST 0.03 // Chance of a reading off something else entirely
+#define SIM_POT_NOISE 10 // Counts of noise on each pot read
+#define SIM_ARM_BACKLASH (3 * M_PI / 180) // Radians the motor turns before the arm does when it changes direction
+#define SIM_BATTERY_VOLTS 12.8
+#define SIM_MOTOR_RESISTANCE 5.12 // Ohms, so flat out from stalled is 2.5A, the V5 current limit
+
+struct SimWorld
+{
+  RobotPose pose; // Where the robot really is
+  RobotPose odometry; // Where the robot's own odometry thinks it is
+  float leftSpeed; // Inches/s
+  float rightSpeed;
+  float strafeSpeed;
+  float armAngle; // Radians from the bottom hard stop
+  float armSpeed; // Radians/s of the motor side of the gearing
+  float armMotorAngle; // Radians, the motor side of the gearing, which can be up to half the backlash either side of the arm
+
+  float ballX; // Inches
+  float ballY;
+  CameraModel camera; // The real camera, which the robot's cameraModel only approximates
+
+  bool droppingOut;
+  uint32_t time; // ms
+  std::mt19937 random;
+};
+
+static inline float simDeadband(float power, float deadband) // What's left of a -127 to 127 command after the deadband
+{
+  float clamped = power > 127 ? 127 : (power < -127 ? -127 : power);
+  float left = fabsf(clamped) - deadband;
+  return left > 0 ? copysignf(left, clamped) : 0;
+}
+
+static inline float simMotorWatts(float power, float speedFraction)
+// What a motor draws from the battery for a -127 to 127 command, turning at speedFraction of its free speed
+{
+  float clamped = power > 127 ? 127 : (power < -127 ? -127 : power);
+  float volts = SIM_BATTERY_VOLTS * clamped / 127;
+  float current = (volts - SIM_BATTERY_VOLTS * speedFraction) / SIM_MOTOR_RESISTANCE;
+  float watts = volts * current;
+  return watts > 0 ? watts : current * current * SIM_MOTOR_RESISTANCE; // Braking, what it takes out of the motion heats the windings
+}
+
+void simReset(SimWorld& world, uint32_t seed);
+void simDrive(SimWorld& world, float left, float right, float strafe, float dt);
+void simDriveArm(SimWorld& world, float power, float dt);
+float simArmPot(SimWorld& world);
+double simArmEncoder(const SimWorld& world);
+int32_t simUltrasonic(SimWorld& world);
+bool simTruth(const SimWorld& world, float* imageX, float* imageY, float* width);
+pros::c::vision_object_s_t simSee(SimWorld& world, uint16_t signature);
+
+#endif // _SIM_WORLD_HPP_
@@ -0,0 +1,87 @@
+// Desktop simulator for the vision tracking and control code. It uses the same pure-math
+// files the robot does (the ones in src/ that don't include main.hpp). Build from the project root:
+//   g++ -O3 -march=native -fno-trapping-math -std=gnu++17 -pthread -iquote include -iquote include/Driver -iquote include/Util sim/*.cpp \
+//     src/Driver/DriverGeometry.cpp src/Driver/DriverTargetEstimate.cpp src/Driver/DriverControlLaws.cpp \
+//     src/Driver/DriverArmEstimate.cpp src/Driver/DriverCompensation.cpp \
+//     src/Driver/DriverPid.cpp src/Driver/DriverArbiter.cpp \
+//     src/Driver/DriverRange.cpp src/Driver/DriverCameraFit.cpp src/Driver/DriverParams.cpp \
+//     src/Driver/DriverObstacles.cpp src/Driver/DriverContact.cpp src/Driver/DriverPickup.cpp src/Driver/DriverEnergy.cpp \
+//     src/Driver/DriverPolicy.cpp src/Driver/DriverIlc.cpp \
+//     src/Driver/DriverFlightRecorder.cpp src/Driver/DriverDeviceCache.cpp src/Driver/DriverFovLimit.cpp \
+//     src/Driver/DriverArmMask.cpp src/Util/FastMath.cpp src/Util/PoolAllocator.cpp src/Util/QuantMlp.cpp -o bin/sim
+// and run with the name of a scenario, e.g. bin/sim tracking. -fno-trapping-math lets the batch loops vectorise
+// even where they pick between two results.
+
+#include <cstdio>
+#include <cstring>
+
+void simTargetTracking();
+void simFastMath();
+void simBatchThroughput();
+void simArmEstimate();
+void simCompensation();
+void simPid();
+void simArbiter();
+void simRange();
+void simCalibration();
+void simTune();
+void simDispatch();
+void simOpponents();
+void simContact();
+void simPickup();
+void simLvglMemory();
+void simEnergy();
+void simPolicy();
+void simIlc();
+void simBlackBox();
+void simPorts();
+void simFov();
+void simArmMask();
+void simConfidence();
+
+struct SimScenario
+{
+  const char* name;
+  void (*run)();
+  const char* description;
+};
+
+SimScenario simScenarios[] =
+{
+  {"tracking", simTargetTracking, "Vision dropouts during turns: image-space vs field-frame target tracking"},
+  {"fastmath", simFastMath, "FastMath error against libm, and time per call"},
+  {"batch", simBatchThroughput, "Vision-assist approaches stepped one robot at a time vs many in lock-step"},
+  {"arm", simArmEstimate, "Arm angle and speed from the pot, the encoder, and both fused"},
+  {"compensation", simCompensation, "Settling small corrections through the deadband and backlash, with and without compensation"},
+  {"pid", simPid, "Forward assist from far away: P, plain PID, and PID with anti-windup and a filtered derivative"},
+  {"arbiter", simArbiter, "Motor writes per second, every motor every loop vs through the command arbiter"},
+  {"range", simRange, "Final approach distance from vision, the ultrasonic, and both fused"},
+  {"calibration", simCalibration, "Fitting the camera mounting from the calibration stations, and how far off balls are placed before and after"},
+  {"dispatch", simDispatch, "Time per PID step: okapi's virtual controllers, a final class, pidStep, and pidStepBatch"},
+  {"opponents", simOpponents, "Scripted opponents in the way of the ball, driving straight at it vs the velocity obstacle filter"},
+  {"contact", simContact, "Time to contact from the box growing: braking a faster forward assist, and leading the arm"},
+  {"pickup", simPickup, "Setting the arm off for the ball early enough that it gets there with the base"},
+  {"lvmem", simLvglMemory, "The screen's allocations from their own pools or from the heap the control task uses"},
+  {"energy", simEnergy, "Joules per ball from the motor draw, split by motor and source"},
+  {"policy", simPolicy, "Trains an int8 approach policy on the pickup, writes policy.bin, and times it"},
+  {"ilc", simIlc, "The autonomous routine run after run, learning a feedforward table from each one's error"},
+  {"blackbox", simBlackBox, "The flight recorder on a long ball chase, what each dump holds and what an entry costs"},
+  {"ports", simPorts, "Reads and busy ports per smart port, every task reading for itself vs one owner"},
+  {"fov", simFov, "High turn gains whipping past the ball, with and without fovTurnLimit"},
+  {"armmask", simArmMask, "Replayed frames carrying a ball, biggest detection vs masking out our own claw"},
+  {"confidence", simConfidence, "Assist power at full strength vs scaled by the tracker's confidence, clean, flickering and with ghosts"},
+  {"tune", simTune, "CMA-ES over every registered parameter on batches of approaches, writes params.txt"},
+};
+
+int main(int argc, char** argv)
+{
+  for(SimScenario& scenario : simScenarios)
+  {
+    if(argc < 2 || strcmp(argv[1], scenario.name) == 0)
+    {
+      printf("== %s: %s\n", scenario.name, scenario.description);
+      scenario.run();
+    }
+  }
+  return 0;
+}
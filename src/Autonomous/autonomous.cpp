@@ -1,12 +1,75 @@
 #include "main.hpp"
+#include <cstdio>
 
-// comp. control has not been fully implemented yet, so
-// this function will never be called
+#include "autonomous.hpp"
+#include "Driver/DriverIlc.hpp"
+#include "Driver/DriverMotors.hpp"
+#include "Driver/DriverStorage.hpp"
+#include "Driver/DriverGeometry.hpp"
+#include "Driver/DriverBlackBox.hpp"
+#include "Driver/DriverDevices.hpp"
 
+#define AUTONOMOUS_TRAVEL_PER_DEGREE (BASE_WHEEL_DIAMETER * M_PI / 360) // Inches the wheel rolls per degree of motor output
+#define AUTONOMOUS_SETTLE 300 // ms holding the end of the routine before letting go
 
+IlcTable autonomousLearning; // Extra power for each part of autonomousRoutine, learnt over the runs so far
+IlcRecord autonomousRecord; // This run's error
+
+bool autonomousLoad() // The table from the last run, from /usd/ilc.bin. Starts from nothing without one, or if the routine's changed since
+{
+  uint32_t routine = ilcRoutineId(autonomousRoutine, autonomousRoutineLength);
+  ilcReset(autonomousLearning, routine);
+  FILE* file = fopen("/usd/" ILC_FILE_NAME, "rb");
+  if(file == NULL)
+  {
+    return false;
+  }
+  static IlcTable loaded;
+  bool read = fread(&loaded, sizeof(loaded), 1, file) == 1 && loaded.routine == routine;
+  fclose(file);
+  if(read)
+  {
+    autonomousLearning = loaded;
+  }
+  return read;
+}
 
 void autonomous()
 {
-  //yay
-pros::delay(10000);
+  DeviceSnapshot devices = deviceSnapshot(); // The wheel positions, read by motorTask
+  double startLeft = devices.motors[MOTOR_BASE_LEFT].position;
+  double startRight = devices.motors[MOTOR_BASE_RIGHT].position;
+
+  ilcRecordReset(autonomousRecord);
+  float travel[ILC_SIDES] = {0, 0};
+  uint32_t start = millis();
+  uint32_t wakeTime = start;
+  uint32_t end = start + routineDuration(autonomousRoutine, autonomousRoutineLength) * 1000 + AUTONOMOUS_SETTLE;
+  while((int32_t)(millis() - end) < 0)
+  {
+    devices = deviceSnapshot();
+    if(devices.motors[MOTOR_BASE_LEFT].valid && devices.motors[MOTOR_BASE_RIGHT].valid)
+    {
+      travel[ILC_LEFT] = (devices.motors[MOTOR_BASE_LEFT].position - startLeft) * AUTONOMOUS_TRAVEL_PER_DEGREE;
+      travel[ILC_RIGHT] = (devices.motors[MOTOR_BASE_RIGHT].position - startRight) * AUTONOMOUS_TRAVEL_PER_DEGREE;
+    }
+    float power[ILC_SIDES];
+    ilcStep(autonomousLearning, autonomousRecord, autonomousRoutine, autonomousRoutineLength, (millis() - start) / 1000.0, travel, power);
+    motorCommand(MOTOR_BASE_LEFT, SOURCE_AUTONOMOUS, power[ILC_LEFT]);
+    motorCommand(MOTOR_BASE_RIGHT, SOURCE_AUTONOMOUS, power[ILC_RIGHT]);
+    blackBoxControl(BLACKBOX_AUTONOMOUS, power[ILC_LEFT], power[ILC_RIGHT], 0);
+    c::task_delay_until(&wakeTime, 10);
+    blackBoxDeadline(BLACKBOX_AUTONOMOUS, wakeTime, 10);
+  }
+  motorRelease(MOTOR_BASE_LEFT, SOURCE_AUTONOMOUS);
+  motorRelease(MOTOR_BASE_RIGHT, SOURCE_AUTONOMOUS);
+
+  // Only a run that got to the end gets learnt from. It goes to the SD card on the next flush, in disabled()
+  for(int segment = 0; segment < autonomousRoutineLength; segment++)
+  {
+    storageLog("autonomous run %lu segment %d: %.3f in RMS\n", (unsigned long)autonomousLearning.runs + 1, segment,
+      ilcSegmentError(autonomousRecord, segment));
+  }
+  ilcUpdate(autonomousLearning, autonomousRecord, autonomousRoutineLength);
+  storageWriteFile(ILC_FILE_NAME, &autonomousLearning, sizeof(autonomousLearning));
 }
@@ -0,0 +1,94 @@
+#include "DriverArbiter.hpp"
+#include <cmath>
+
+void arbiterSubmit(Arbiter& arbiter, ArbiterMotor motor, ArbiterSource source, ArbiterMode mode, float value, bool additive, uint32_t now, uint32_t timeout)
+{
+  ArbiterCommand& command = arbiter.commands[motor][source];
+  command.additive = additive;
+  command.mode = mode;
+  command.value = value;
+  command.expires = now + timeout;
+  command.active = true;
+}
+
+
+void arbiterRelease(Arbiter& arbiter, ArbiterMotor motor, ArbiterSource source) // Drops the source's command now instead of waiting out the timeout
+{
+  arbiter.commands[motor][source].active = false;
+}
+
+
+bool arbiterResolve(Arbiter& arbiter, ArbiterMotor motor, uint32_t now, ArbiterMode* mode, int32_t* value)
+// Works out what the motor should get this tick. Returns true if that needs writing to the motor
+{
+  ArbiterMode resolvedMode = MODE_POWER;
+  float resolved = 0;
+  float contribution[SOURCE_COUNT] = {};
+  float contributionTotal = 0;
+
+  for(int source = 0; source < SOURCE_COUNT; source++)
+  {
+    ArbiterCommand& command = arbiter.commands[motor][source];
+    if(command.active && (int32_t)(command.expires - now) < 0) // Still right when millis() wraps
+    {
+      command.active = false;
+    }
+    if(!command.active)
+    {
+      continue;
+    }
+
+    if(command.additive && command.mode == resolvedMode)
+    {
+      resolved += command.value;
+      contribution[source] = fabs(command.value);
+      contributionTotal += contribution[source];
+    }
+    else if(!command.additive)
+    {
+      resolved = command.value;
+      resolvedMode = command.mode;
+      for(int below = 0; below < source; below++) // Everything under it got replaced
+      {
+        contribution[below] = 0;
+      }
+      contribution[source] = fabs(command.value);
+      contributionTotal = contribution[source];
+    }
+  }
+
+  MotorCompensation* compensation = arbiter.compensation[motor];
+  if(resolvedMode == MODE_POWER)
+  {
+    resolved = fmax(fmin(resolved, 127), -127);
+    if(compensation)
+    {
+      resolved = compensationCommand(*compensation, resolved);
+    }
+  }
+  if(compensation)
+  {
+    compensation->lastCommand = resolvedMode == MODE_POWER ? resolved : 0;
+  }
+
+  *mode = resolvedMode;
+  *value = lround(resolved);
+
+  ArbiterOutput& output = arbiter.outputs[motor];
+  for(int source = 0; source < SOURCE_COUNT; source++)
+  {
+    output.share[source] = contributionTotal > 0 ? contribution[source] / contributionTotal : 0;
+  }
+  if(output.written && output.mode == *mode && output.value == *value && now - output.lastWrite < ARBITER_REFRESH)
+  {
+    arbiter.skipped++;
+    return false;
+  }
+
+  output.written = true;
+  output.mode = *mode;
+  output.value = *value;
+  output.lastWrite = now;
+  arbiter.writes++;
+  return true;
+}
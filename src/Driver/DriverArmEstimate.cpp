@@ -0,0 +1,35 @@
+#include "DriverArmEstimate.hpp"
+
+// The blends are per 10ms loop, scaled for the real dt so a late loop doesn't throw the filter off
+#define ARM_ESTIMATE_PERIOD 0.01
+
+void armEstimateUpdate(ArmEstimate& estimate, float potRadians, float encoderRadians, float dt)
+{
+  if(!estimate.valid) // Nothing to go on but the pot the first time
+  {
+    estimate.angle = potRadians;
+    estimate.velocity = 0;
+    estimate.lastEncoder = encoderRadians;
+    estimate.valid = true;
+    return;
+  }
+
+  float step = encoderRadians - estimate.lastEncoder;
+  estimate.lastEncoder = encoderRadians;
+
+  float loops = dt / ARM_ESTIMATE_PERIOD;
+  float potBlend = ARM_POT_BLEND * loops;
+  float velocityBlend = ARM_VELOCITY_BLEND * loops;
+  if(potBlend > 1) potBlend = 1;
+  if(velocityBlend > 1) velocityBlend = 1;
+
+  // The encoder moves the angle straight away, which is what keeps the lag down,
+  // and the pot slowly drags out whatever the encoder got wrong
+  estimate.angle += step;
+  estimate.angle += (potRadians - estimate.angle) * potBlend;
+
+  if(dt > 0)
+  {
+    estimate.velocity += (step / dt - estimate.velocity) * velocityBlend;
+  }
+}
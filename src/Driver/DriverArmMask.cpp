@@ -0,0 +1,81 @@
+#include "DriverArmMask.hpp"
+#include "DriverPickup.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define ARM_MASK_STEP (ARM_MASK_RANGE / (ARM_MASK_STEPS - 1)) // Radians between boxes
+
+void armMaskBuild(ArmMask& mask, const CameraModel& camera) // Whenever the camera model changes
+{
+  mask.camera = camera;
+  for(int step = 0; step < ARM_MASK_STEPS; step++)
+  {
+    float elevation = ARM_DOWN_ELEVATION + step * ARM_MASK_STEP;
+    float forward = ARM_PIVOT_FORWARD + ARM_LENGTH * cosf(elevation);
+    float height = ARM_PIVOT_HEIGHT + ARM_LENGTH * sinf(elevation);
+
+    ArmMaskBox& box = mask.boxes[step];
+    float imageX, imageY, width;
+    box.visible = fieldToImage(camera, {0, 0, 0}, forward, 0, &imageX, &imageY, &width, ARM_MASK_SIZE, height);
+    if(box.visible)
+    {
+      float half = width / 2 + ARM_MASK_MARGIN;
+      box.left = imageX - half;
+      box.right = imageX + half;
+      box.top = imageY - half;
+      box.bottom = imageY + half;
+      box.visible = box.right >= 0 && box.left < VISION_FOV_WIDTH && box.bottom >= 0 && box.top < VISION_FOV_HEIGHT;
+    }
+  }
+}
+
+bool armMaskCurrent(const ArmMask& mask, const CameraModel& camera) // False if it needs building for this camera
+{
+  return memcmp(&mask.camera, &camera, sizeof(camera)) == 0;
+}
+
+ArmMaskBox armMaskAt(const ArmMask& mask, float armAngle) // Everywhere the claw could be within ARM_MASK_SLACK of armAngle
+{
+  int first = std::clamp((int)floorf((armAngle - ARM_MASK_SLACK) / ARM_MASK_STEP), 0, ARM_MASK_STEPS - 1);
+  int last = std::clamp((int)ceilf((armAngle + ARM_MASK_SLACK) / ARM_MASK_STEP), 0, ARM_MASK_STEPS - 1);
+  ArmMaskBox covered = {false, 0, 0, 0, 0};
+  for(int step = first; step <= last; step++)
+  {
+    const ArmMaskBox& box = mask.boxes[step];
+    if(!box.visible)
+    {
+      continue;
+    }
+    if(!covered.visible)
+    {
+      covered = box;
+      continue;
+    }
+    covered.left = fminf(covered.left, box.left);
+    covered.top = fminf(covered.top, box.top);
+    covered.right = fmaxf(covered.right, box.right);
+    covered.bottom = fmaxf(covered.bottom, box.bottom);
+  }
+  return covered;
+}
+
+bool armMaskCovers(const ArmMaskBox& box, const pros::c::vision_object_s_t& object) // The middle of the detection is on the claw
+{
+  return box.visible && object.x_middle_coord >= box.left && object.x_middle_coord <= box.right
+    && object.y_middle_coord >= box.top && object.y_middle_coord <= box.bottom;
+}
+
+int armMaskPick(const ArmMask& mask, float armAngle, const pros::c::vision_object_s_t* objects, int count)
+// Index of the biggest detection that isn't our own claw, -1 if there isn't one. objects are biggest first, as read_by_sig gives them
+{
+  ArmMaskBox box = armMaskAt(mask, armAngle);
+  for(int i = 0; i < count; i++)
+  {
+    if(objects[i].signature != VISION_OBJECT_ERR_SIG && !armMaskCovers(box, objects[i]))
+    {
+      return i;
+    }
+  }
+  return -1;
+}
@@ -1,40 +1,128 @@
 #include "main.hpp"
+#include <atomic>
 #include "DriverArmP.hpp"
 #include "DriverVisionTracking.hpp"
+#include "DriverControlLaws.hpp"
+#include "DriverArmEstimate.hpp"
+#include "DriverCompensation.hpp"
+#include "DriverMotors.hpp"
+#include "DriverPickup.hpp"
+#include "DriverBlackBox.hpp"
+#include "DriverDevices.hpp"
 
-#define potRange 3036 //The pot value of the range of the arm
-#define potAngle 270 //The angle value of the range of the arm
-#define potOffset 0 //The offset for a certain pot value to be zero degrees
+ArmEstimate armState;
+MotorCompensation armCompensation;
 
-#define ARM_P 1.3
+static int16_t armPotSamples[ARM_POT_SAMPLES]; // Ring of the latest pot reads, from armPotTask
+static std::atomic<uint32_t> armPotWritten; // Reads ever taken, the next one goes at armPotWritten % ARM_POT_SAMPLES
 
-void armP(void*)
+float armAngle() // Radians up from the bottom hard stop
 {
-  Motor armMotor(3);
+  return armState.angle;
+}
 
-  float error;
-  //int wanted;
-  float finalArmPower;
+float armVelocity() // Radians/s, positive is up
+{
+  return armState.velocity;
+}
 
+void armPotTask(void*) // Reads the pot every millisecond, which is the only place it's read
+{
+  ADIAnalogIn armPot(ARM_POT_PORT); // Calibrated in initialize()
+  uint32_t wakeTime = millis();
   while(true)
   {
-    //wanted = (potRange / potAngle * driverArmAngle()) + potOffset;
-    // error = wanted - pot;
+    int32_t pot = armPot.get_value_calibrated();
+    if(pot != PROS_ERR)
+    {
+      uint32_t written = armPotWritten.load(std::memory_order_relaxed);
+      armPotSamples[written % ARM_POT_SAMPLES] = pot;
+      armPotWritten.store(written + 1, std::memory_order_release);
+    }
+    c::task_delay_until(&wakeTime, 1);
+  }
+}
+
+static bool armPotAverage(float* pot) // The last ARM_POT_SAMPLES reads averaged, which takes out most of the pot's noise
+{
+  uint32_t written = armPotWritten.load(std::memory_order_acquire);
+  int count = written < ARM_POT_SAMPLES ? written : ARM_POT_SAMPLES;
+  if(count == 0)
+  {
+    return false;
+  }
+  int32_t sum = 0;
+  for(int i = 0; i < count; i++)
+  {
+    sum += armPotSamples[i]; // One may get replaced by a newer read as we go, which doesn't matter
+  }
+  *pot = (float)sum / count;
+  return true;
+}
 
-    error = driverArmAngle();
+void armP(void*)
+{
+  // The pot's read by armPotTask, the motor's read by motorTask, and written by the arbiter
+  motorCompensate(MOTOR_ARM, &armCompensation);
 
-    finalArmPower = error * ARM_P;
+  float error;
+  float finalArmPower;
+  bool ballCounted = false; // Once per LEFT press
 
+  uint32_t wakeTime = millis();
+  uint32_t lastTime = wakeTime;
+  DeviceSnapshot devices = deviceSnapshot();
+  float lastEncoder = devices.motors[MOTOR_ARM].position * ARM_RADIANS_PER_MOTOR_DEGREE;
+  bool encoderRead = devices.motors[MOTOR_ARM].valid; // lastEncoder is real, not from before motorTask's first read
+  float armTravel = 0; // What the encoder says the arm itself has moved, without the backlash
+  while(true)
+  {
+    float pot;
+    bool potRead = armPotAverage(&pot);
+    devices = deviceSnapshot();
+    uint32_t now = millis();
+    float dt = (now - lastTime) / 1000.0;
+    if(potRead && devices.motors[MOTOR_ARM].valid)
+    {
+      float potRadians = (pot - potOffset) * ARM_RADIANS_PER_POT_COUNT;
+      float encoderRadians = devices.motors[MOTOR_ARM].position * ARM_RADIANS_PER_MOTOR_DEGREE;
+      armTravel += encoderRead ? compensationObserve(armCompensation, encoderRadians - lastEncoder, dt) : 0;
+      encoderRead = true;
+      armEstimateUpdate(armState, potRadians, armTravel, dt);
+      compensationLearnBacklash(armCompensation, encoderRadians, potRadians, armState.velocity);
+      lastEncoder = encoderRadians;
+    }
+    lastTime = now;
 
-    if (mainController.get_digital(E_CONTROLLER_DIGITAL_LEFT))
+    if (controllerHeld(devices.controller, E_CONTROLLER_DIGITAL_LEFT))
     {
-      armMotor.move(finalArmPower);
+      // Heads down for the ball early enough to get there with the base, and waits where it is until then
+      float grabAngle;
+      bool moving = driverArmPickup(armState.angle, &grabAngle);
+      error = moving ? (grabAngle - armState.angle) * 180 / M_PI : 0; // Degrees, like the old pixel error
+      finalArmPower = armPower(error);
+      PolicyCommand policy;
+      if(driverPolicy(armState.angle, &policy))
+      {
+        finalArmPower = policy.arm; // The learnt approach, if there's one on the card
+      }
+      motorCommand(MOTOR_ARM, SOURCE_ASSIST, finalArmPower);
+      blackBoxControl(BLACKBOX_ARM, 0, 0, finalArmPower);
+      if(moving && !ballCounted && driverBaseArrived() && fabs(grabAngle - armState.angle) < PICKUP_ARM_CLOSE)
+      {
+        motorBallCollected(); // Base and claw both on it, which is as close to knowing we've got it as we can get
+        ballCounted = true;
+      }
     }
     else
     {
-      armMotor.move(0);
+      driverArmPickupReset();
+      ballCounted = false;
+      motorRelease(MOTOR_ARM, SOURCE_ASSIST);
+      motorCommand(MOTOR_ARM, SOURCE_DRIVER, 0);
     }
 
-    delay(10);
+    c::task_delay_until(&wakeTime, 10);
+    blackBoxDeadline(BLACKBOX_ARM, wakeTime, 10);
   }
 }
@@ -1,8 +1,27 @@
 #include "main.hpp"
 #include "DriverBaseControl.hpp"
 #include "DriverVisionTracking.hpp"
+#include "DriverCompensation.hpp"
+#include "DriverMotors.hpp"
+#include "DriverOdometry.hpp"
+#include "DriverObstacles.hpp"
+#include "DriverBlackBox.hpp"
+#include "DriverDevices.hpp"
 
+#define BASE_RADIANS_PER_DEGREE (M_PI / 180) // The compensation works in radians of the wheel
 
+MotorCompensation leftBaseCompensation;
+MotorCompensation rightBaseCompensation;
+MotorCompensation hBaseCompensation;
+
+
+
+static void baseAvoidRelease()
+{
+	motorRelease(MOTOR_BASE_LEFT, SOURCE_SAFETY);
+	motorRelease(MOTOR_BASE_RIGHT, SOURCE_SAFETY);
+	motorRelease(MOTOR_BASE_H, SOURCE_SAFETY);
+}
 
 void driverBaseControl(void*)
 {
@@ -12,49 +31,91 @@ void driverBaseControl(void*)
 	float baseTurnBias;
 	float baseForwardBias;
 
+	// How far each wheel went, for the deadband learning. No pot on the base, so no backlash either
+	DeviceSnapshot last = deviceSnapshot();
+
+	leftBaseCompensation.holdPower = COMPENSATION_HOLD_POWER;
+	rightBaseCompensation.holdPower = COMPENSATION_HOLD_POWER;
+	motorCompensate(MOTOR_BASE_LEFT, &leftBaseCompensation);
+	motorCompensate(MOTOR_BASE_RIGHT, &rightBaseCompensation);
+	motorCompensate(MOTOR_BASE_H, &hBaseCompensation);
+
 	while(true)
 	{
-		controllerR_Y = mainController.get_analog(ANALOG_RIGHT_Y);
-		controllerL_X = mainController.get_analog(ANALOG_LEFT_X);
-		controllerR_X = mainController.get_analog(ANALOG_RIGHT_X);
+		DeviceSnapshot devices = deviceSnapshot();
+		const MotorReading* wheels = devices.motors;
+		if(devices.time != last.time && wheels[MOTOR_BASE_LEFT].valid && wheels[MOTOR_BASE_RIGHT].valid && wheels[MOTOR_BASE_H].valid)
+		{
+			if(last.time != 0) // Not before motorTask's first read
+			{
+				float dt = (devices.time - last.time) / 1000.0;
+				compensationObserve(leftBaseCompensation, (wheels[MOTOR_BASE_LEFT].position - last.motors[MOTOR_BASE_LEFT].position) * BASE_RADIANS_PER_DEGREE, dt);
+				compensationObserve(rightBaseCompensation, (wheels[MOTOR_BASE_RIGHT].position - last.motors[MOTOR_BASE_RIGHT].position) * BASE_RADIANS_PER_DEGREE, dt);
+				compensationObserve(hBaseCompensation, (wheels[MOTOR_BASE_H].position - last.motors[MOTOR_BASE_H].position) * BASE_RADIANS_PER_DEGREE, dt);
+			}
+			last = devices;
+		}
+
+		controllerR_Y = devices.controller.analog[ANALOG_RIGHT_Y];
+		controllerL_X = devices.controller.analog[ANALOG_LEFT_X];
+		controllerR_X = devices.controller.analog[ANALOG_RIGHT_X];
 
-		if (mainController.get_digital(E_CONTROLLER_DIGITAL_DOWN))
+		baseRightMotors(controllerR_Y - controllerL_X);
+		baseLeftMotors(controllerR_Y + controllerL_X);
+
+		baseHMotor(controllerR_X);
+
+		if (controllerHeld(devices.controller, E_CONTROLLER_DIGITAL_DOWN))
 		{
 			baseTurnBias = driverBaseAngle();
 			baseForwardBias = driverBaseForward();
+			blackBoxControl(BLACKBOX_BASE, baseTurnBias, baseForwardBias, 0);
+
+			// Added on top of the sticks by the arbiter
+			motorCommand(MOTOR_BASE_RIGHT, SOURCE_ASSIST, - baseTurnBias - baseForwardBias, true);
+			motorCommand(MOTOR_BASE_LEFT, SOURCE_ASSIST, baseTurnBias - baseForwardBias, true);
+
+			// While the assist is driving, don't let it drive into the other alliance. What the sticks and assist add up
+			// to goes through the velocity obstacle filter, and if that changes it, safety overrides both
+			float left = controllerR_Y + controllerL_X + baseTurnBias - baseForwardBias;
+			float right = controllerR_Y - controllerL_X - baseTurnBias - baseForwardBias;
+			float strafe = controllerR_X;
+			if(avoidFilter(visionOpponents(), odometryPose(), millis(), &left, &right, &strafe))
+			{
+				motorCommand(MOTOR_BASE_LEFT, SOURCE_SAFETY, left);
+				motorCommand(MOTOR_BASE_RIGHT, SOURCE_SAFETY, right);
+				motorCommand(MOTOR_BASE_H, SOURCE_SAFETY, strafe);
+			}
+			else
+			{
+				baseAvoidRelease();
+			}
 		}
 		else
 		{
-			baseTurnBias = 0;
-			baseForwardBias = 0;
+			motorRelease(MOTOR_BASE_RIGHT, SOURCE_ASSIST);
+			motorRelease(MOTOR_BASE_LEFT, SOURCE_ASSIST);
+			baseAvoidRelease();
+			driverBaseForwardReset();
 		}
 
-
-		baseRightMotors(controllerR_Y - controllerL_X - baseTurnBias - baseForwardBias);
-		baseLeftMotors(controllerR_Y + controllerL_X + baseTurnBias - baseForwardBias);
-
-		baseHMotor(controllerR_X);
-
 		pros::delay(10);
 	}
 }
 
 
 
-void baseLeftMotors(float value)
+void baseLeftMotors(float value) // The driver's share, the arbiter adds the assists and does the writing
 {
-	pros::Motor leftBaseMotor(1, pros::c::E_MOTOR_GEARSET_36, false);
-	leftBaseMotor.move(value);
+	motorCommand(MOTOR_BASE_LEFT, SOURCE_DRIVER, value);
 }
 
 void baseRightMotors(float value)
 {
-	pros::Motor rightBaseMotor(5, pros::c::E_MOTOR_GEARSET_36, true);
-	rightBaseMotor.move(value);
+	motorCommand(MOTOR_BASE_RIGHT, SOURCE_DRIVER, value);
 }
 
 void baseHMotor(float value)
 {
-	pros::Motor hBaseMotor(2, pros::c::E_MOTOR_GEARSET_36, true);
-	hBaseMotor.move(value);
+	motorCommand(MOTOR_BASE_H, SOURCE_DRIVER, value);
 }
@@ -0,0 +1,77 @@
+#include "main.hpp"
+#include <cstdio>
+#include "DriverBlackBox.hpp"
+#include "DriverFlightRecorder.hpp"
+#include "DriverStorage.hpp"
+
+#define BLACKBOX_FILES 3 // Dumps kept on the SD card for each kind, the oldest of that kind gets replaced
+#define BLACKBOX_PERIOD 50 // ms between checks for a frozen recorder
+
+// Everything recent, at full rate, for when something goes wrong. The control tasks only ever add entries to
+// the ring. This task notices when it's frozen and writes it straight to the SD card itself, it's below
+// everything that drives so they don't wait on the card. Lost track goes off far more than anything else,
+// so it gets its own files and can't replace a motor fault or a late task before anyone's looked at it
+
+FlightRecorder blackBox;
+uint32_t blackBoxDumped;
+static uint32_t blackBoxLostDumped; // Of blackBoxDumped, how many were lost track
+
+void blackBoxVision(const c::vision_object_s_t& object, int32_t objectCount) // Each new frame
+{
+  recorderVision(blackBox, millis(), object, objectCount);
+}
+
+void blackBoxControl(BlackBoxSource who, float a, float b, float c) // Turn, forward, arm for the assists, left and right for autonomous
+{
+  recorderControl(blackBox, millis(), who, a, b, c);
+}
+
+void blackBoxMotor(uint8_t motor, int32_t command, float rpm, int32_t milliamps, float watts, uint32_t faults)
+{
+  recorderMotor(blackBox, millis(), motor, command, rpm, milliamps, watts, faults);
+}
+
+void blackBoxDeadline(BlackBoxSource task, uint32_t wake, uint32_t period) // After task_delay_until, with the wake time it updated
+{
+  recorderDeadline(blackBox, millis(), task, wake, period);
+}
+
+bool blackBoxTrigger() // For anything else worth a look, false if it's already been set off
+{
+  return recorderTrigger(blackBox, millis(), TRIGGER_MANUAL);
+}
+
+uint32_t blackBoxDumps()
+{
+  return blackBoxDumped;
+}
+
+void blackBoxTask(void*)
+{
+  const char* reasons[] = {"lost track", "motor fault", "late task", "manual"};
+  blackBox.triggers = recorderDefaultTriggers; // Zeroed is otherwise the same as reset, and the other tasks may already be adding
+  while(true)
+  {
+    if(recorderFrozen(blackBox, millis()))
+    {
+      const RecorderEntry* entries;
+      uint32_t count = recorderSnapshot(blackBox, &entries);
+      bool lost = blackBox.triggerReason == TRIGGER_LOST_TRACK;
+      uint32_t slot = (lost ? blackBoxLostDumped : blackBoxDumped - blackBoxLostDumped) % BLACKBOX_FILES;
+      char name[32];
+      snprintf(name, sizeof(name), "/usd/blackbox%s%lu.bin", lost ? "lost" : "", (unsigned long)slot);
+      FILE* file = fopen(name, "wb"); // Blocks for a while, the recorder stays frozen until it's written
+      bool saved = file != NULL && fwrite(entries, sizeof(RecorderEntry), count, file) == count;
+      if(file != NULL)
+      {
+        saved = fclose(file) == 0 && saved;
+      }
+      storageLog("black box %s at %lu ms: %lu entries to %s%s\n", reasons[blackBox.triggerReason], (unsigned long)blackBox.triggerTime,
+        (unsigned long)count, name, saved ? "" : ", didn't save");
+      blackBoxDumped++;
+      blackBoxLostDumped += lost;
+      recorderRearm(blackBox);
+    }
+    delay(BLACKBOX_PERIOD);
+  }
+}
@@ -0,0 +1,182 @@
+#include "main.hpp"
+#include <atomic>
+#include <cstdio>
+#include "DriverCameraCalibration.hpp"
+#include "DriverVisionTracking.hpp"
+#include "DriverOdometry.hpp"
+#include "DriverMotors.hpp"
+#include "DriverStorage.hpp"
+#include "DriverDevices.hpp"
+
+#define CAMERA_MODEL_NAME "camera.txt"
+#define CAMERA_MODEL_FILE "/usd/" CAMERA_MODEL_NAME
+#define CALIBRATION_FRAMES 10 // Frames averaged at each station
+#define CALIBRATION_DRIVE_P 8.0 // Power per inch off the station
+#define CALIBRATION_TURN_P 150.0 // Power per radian off the station
+#define CALIBRATION_MAX_POWER 50 // Slow, so odometry doesn't slip
+#define CALIBRATION_DISTANCE_TOLERANCE 0.3 // Inches
+#define CALIBRATION_HEADING_TOLERANCE 0.01 // Radians
+#define CALIBRATION_MOVE_TIMEOUT 4000 // ms before giving up on reaching a station
+
+static std::atomic<bool> calibrating; // Set by cameraCalibrationStart, cleared when the task finishes
+
+bool cameraModelLoad() // From the SD card, if calibration has ever been run. Keeps the defaults otherwise
+{
+  FILE* file = fopen(CAMERA_MODEL_FILE, "r");
+  if(file == NULL)
+  {
+    return false;
+  }
+
+  CameraModel loaded;
+  int read = fscanf(file, "%f %f %f %f %f %f %f %f", &loaded.focalLength, &loaded.centerX, &loaded.centerY,
+    &loaded.mountForward, &loaded.mountLeft, &loaded.mountYaw, &loaded.mountHeight, &loaded.mountPitch);
+  fclose(file);
+  if(read != 8)
+  {
+    return false;
+  }
+
+  cameraModel = loaded;
+  visionAimX = cameraAimX(cameraModel);
+  return true;
+}
+
+bool cameraModelSave() // Staged in RAM, it reaches the SD card on the next storageFlush
+{
+  char text[160];
+  int length = snprintf(text, sizeof(text), "%f %f %f %f %f %f %f %f\n", cameraModel.focalLength, cameraModel.centerX,
+    cameraModel.centerY, cameraModel.mountForward, cameraModel.mountLeft, cameraModel.mountYaw, cameraModel.mountHeight,
+    cameraModel.mountPitch);
+  return length < (int)sizeof(text) && storageWriteFile(CAMERA_MODEL_NAME, text, length);
+}
+
+
+static float calibrationClamp(float power)
+{
+  if(power > CALIBRATION_MAX_POWER) return CALIBRATION_MAX_POWER;
+  if(power < -CALIBRATION_MAX_POWER) return -CALIBRATION_MAX_POWER;
+  return power;
+}
+
+static bool calibrationMove(const RobotPose& station) // Drives straight along x to the station, then turns to its heading
+{
+  uint32_t start = millis();
+  bool driving = true;
+  while(millis() - start < CALIBRATION_MOVE_TIMEOUT)
+  {
+    if(controllerHeld(deviceSnapshot().controller, E_CONTROLLER_DIGITAL_B))
+    {
+      return false; // Driver called it off
+    }
+
+    RobotPose pose = odometryPose();
+    float forward = 0;
+    float turn;
+    if(driving)
+    {
+      float distance = station.x - pose.x;
+      driving = fabs(distance) > CALIBRATION_DISTANCE_TOLERANCE;
+      forward = driving ? calibrationClamp(distance * CALIBRATION_DRIVE_P) : 0;
+      turn = calibrationClamp(-pose.heading * CALIBRATION_TURN_P); // Stay pointed down the x axis on the way
+    }
+    else
+    {
+      float heading = station.heading - pose.heading;
+      if(fabs(heading) < CALIBRATION_HEADING_TOLERANCE)
+      {
+        return true;
+      }
+      turn = calibrationClamp(heading * CALIBRATION_TURN_P);
+    }
+
+    // Positive turn is counter-clockwise, so the right side goes forward
+    motorCommand(MOTOR_BASE_LEFT, SOURCE_AUTONOMOUS, forward - turn);
+    motorCommand(MOTOR_BASE_RIGHT, SOURCE_AUTONOMOUS, forward + turn);
+    delay(10);
+  }
+  return false;
+}
+
+
+void cameraCalibrationTask(void*)
+// Put the robot on the field facing a ball CALIBRATION_BALL_DISTANCE in front of its centre, then start this.
+// It visits every station, fits the camera model to what it saw, and saves it for next time. B stops it
+{
+  CalibrationSample samples[32];
+  int count = 0;
+  odometryReset({0, 0, 0});
+  delay(50);
+
+  for(int station = 0; station < calibrationStationCount() && count < 32; station++)
+  {
+    RobotPose target = calibrationStation(station);
+    bool arrived = calibrationMove(target);
+    motorCommand(MOTOR_BASE_LEFT, SOURCE_AUTONOMOUS, 0, false, 1000);
+    motorCommand(MOTOR_BASE_RIGHT, SOURCE_AUTONOMOUS, 0, false, 1000);
+    if(!arrived)
+    {
+      if(controllerHeld(deviceSnapshot().controller, E_CONTROLLER_DIGITAL_B))
+      {
+        break;
+      }
+      continue; // Couldn't get there, skip it
+    }
+    delay(300); // Let it stop rocking
+
+    CalibrationSample sample = {odometryPose(), CALIBRATION_BALL_DISTANCE, 0, 0, 0, 0};
+    int frames = 0;
+    uint32_t lastFrame = 0;
+    for(int wait = 0; wait < CALIBRATION_FRAMES * 4 && frames < CALIBRATION_FRAMES; wait++)
+    {
+      uint32_t frameTime = visionFrameTime();
+      c::vision_object_s_t seen = calculateVision();
+      if(frameTime != lastFrame && seen.signature != 255)
+      {
+        sample.imageX += seen.x_middle_coord;
+        sample.imageY += seen.y_middle_coord;
+        sample.width += seen.width;
+        frames++;
+      }
+      lastFrame = frameTime;
+      delay(20);
+    }
+    if(frames > 0)
+    {
+      sample.imageX /= frames;
+      sample.imageY /= frames;
+      sample.width /= frames;
+      samples[count++] = sample;
+    }
+  }
+
+  motorRelease(MOTOR_BASE_LEFT, SOURCE_AUTONOMOUS);
+  motorRelease(MOTOR_BASE_RIGHT, SOURCE_AUTONOMOUS);
+
+  float rmsBefore, rmsAfter;
+  CameraModel fit = cameraModel;
+  if(calibrationFit(fit, samples, count, &rmsBefore, &rmsAfter))
+  {
+    cameraModel = fit;
+    visionAimX = cameraAimX(cameraModel);
+    cameraModelSave();
+    storageLog("camera calibrated from %d stations, %.2f px -> %.2f px\n", count, rmsBefore, rmsAfter);
+  }
+  else
+  {
+    storageLog("camera calibration failed with %d stations\n", count);
+  }
+
+  storageFlush(); // The robot's sitting still, and without a competition switch disabled() never runs
+  calibrating = false;
+}
+
+bool cameraCalibrationStart() // Starts cameraCalibrationTask, unless one's already running. False if it didn't
+{
+  if(calibrating.exchange(true))
+  {
+    return false;
+  }
+  Task calibrationTask(cameraCalibrationTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "CameraCalibration");
+  return true;
+}
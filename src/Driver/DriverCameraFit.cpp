@@ -0,0 +1,190 @@
+#include "DriverCameraFit.hpp"
+#include <cmath>
+
+// Close and far, each looking straight at the ball and turned both ways, so the focal length (from the
+// width), the tilt and height (from y) and the turn and offsets (from x) all show up differently
+float calibrationDistances[] = {24, 36, 48, 60}; // Inches from the ball
+float calibrationHeadings[] = {-0.3, -0.15, 0, 0.15, 0.3}; // Radians
+
+#define CALIBRATION_HEADING_COUNT (int)(sizeof(calibrationHeadings) / sizeof(calibrationHeadings[0]))
+
+int calibrationStationCount()
+{
+  return sizeof(calibrationDistances) / sizeof(calibrationDistances[0]) * CALIBRATION_HEADING_COUNT;
+}
+
+RobotPose calibrationStation(int station) // Where the robot should be for each station. It starts at 0, 0 facing the ball
+{
+  RobotPose pose;
+  pose.x = CALIBRATION_BALL_DISTANCE - calibrationDistances[station / CALIBRATION_HEADING_COUNT];
+  pose.y = 0;
+  pose.heading = calibrationHeadings[station % CALIBRATION_HEADING_COUNT];
+  return pose;
+}
+
+
+static float* calibrationParameter(CameraModel& camera, int parameter)
+{
+  float* parameters[CALIBRATION_PARAMETERS] = {&camera.focalLength, &camera.mountForward, &camera.mountLeft,
+    &camera.mountYaw, &camera.mountHeight, &camera.mountPitch};
+  return parameters[parameter];
+}
+
+static bool calibrationResiduals(const CameraModel& camera, const CalibrationSample& sample, float residuals[3])
+{
+  float imageX, imageY, width;
+  if(!fieldToImage(camera, sample.pose, sample.ballX, sample.ballY, &imageX, &imageY, &width))
+  {
+    return false;
+  }
+  residuals[0] = imageX - sample.imageX;
+  residuals[1] = imageY - sample.imageY;
+  residuals[2] = (width - sample.width) * CALIBRATION_WIDTH_WEIGHT;
+  return true;
+}
+
+static float calibrationCost(const CameraModel& camera, const CalibrationSample* samples, int count)
+{
+  float cost = 0;
+  for(int i = 0; i < count; i++)
+  {
+    float residuals[3];
+    if(!calibrationResiduals(camera, samples[i], residuals))
+    {
+      return INFINITY;
+    }
+    cost += residuals[0] * residuals[0] + residuals[1] * residuals[1] + residuals[2] * residuals[2];
+  }
+  return cost;
+}
+
+static bool calibrationSolve(double matrix[CALIBRATION_PARAMETERS][CALIBRATION_PARAMETERS], double vector[CALIBRATION_PARAMETERS])
+// Gaussian elimination with partial pivoting, the answer ends up in vector
+{
+  const int n = CALIBRATION_PARAMETERS;
+  for(int column = 0; column < n; column++)
+  {
+    int pivot = column;
+    for(int row = column + 1; row < n; row++)
+    {
+      if(fabs(matrix[row][column]) > fabs(matrix[pivot][column])) pivot = row;
+    }
+    if(fabs(matrix[pivot][column]) < 1e-12)
+    {
+      return false;
+    }
+    for(int k = 0; k < n; k++)
+    {
+      double swap = matrix[column][k]; matrix[column][k] = matrix[pivot][k]; matrix[pivot][k] = swap;
+    }
+    double swap = vector[column]; vector[column] = vector[pivot]; vector[pivot] = swap;
+
+    for(int row = column + 1; row < n; row++)
+    {
+      double factor = matrix[row][column] / matrix[column][column];
+      for(int k = column; k < n; k++) matrix[row][k] -= factor * matrix[column][k];
+      vector[row] -= factor * vector[column];
+    }
+  }
+  for(int row = n - 1; row >= 0; row--)
+  {
+    for(int k = row + 1; k < n; k++) vector[row] -= matrix[row][k] * vector[k];
+    vector[row] /= matrix[row][row];
+  }
+  return true;
+}
+
+
+bool calibrationFit(CameraModel& camera, const CalibrationSample* samples, int count, float* rmsBefore, float* rmsAfter)
+// Levenberg-Marquardt: Gauss-Newton steps, made smaller and more like plain downhill steps whenever one makes things worse.
+// The camera is only changed if the fit worked. The RMS is per residual, in pixels
+{
+  const int n = CALIBRATION_PARAMETERS;
+  const float steps[CALIBRATION_PARAMETERS] = {1.0, 0.05, 0.05, 0.001, 0.05, 0.001}; // For the numerical derivatives
+  CameraModel fit = camera;
+  float cost = calibrationCost(fit, samples, count);
+  *rmsBefore = sqrt(cost / (count * 3));
+  if(count * 3 < n * 2 || !std::isfinite(cost))
+  {
+    return false; // Not enough to pin down six numbers
+  }
+
+  double damping = 1e-3;
+  for(int iteration = 0; iteration < CALIBRATION_ITERATIONS; iteration++)
+  {
+    double normal[CALIBRATION_PARAMETERS][CALIBRATION_PARAMETERS] = {};
+    double gradient[CALIBRATION_PARAMETERS] = {};
+    for(int i = 0; i < count; i++)
+    {
+      float residuals[3];
+      float jacobian[3][CALIBRATION_PARAMETERS];
+      calibrationResiduals(fit, samples[i], residuals);
+      for(int parameter = 0; parameter < n; parameter++)
+      {
+        CameraModel nudged = fit;
+        *calibrationParameter(nudged, parameter) += steps[parameter];
+        float moved[3];
+        if(!calibrationResiduals(nudged, samples[i], moved))
+        {
+          return false;
+        }
+        for(int r = 0; r < 3; r++) jacobian[r][parameter] = (moved[r] - residuals[r]) / steps[parameter];
+      }
+      for(int r = 0; r < 3; r++)
+      {
+        for(int a = 0; a < n; a++)
+        {
+          gradient[a] -= jacobian[r][a] * residuals[r];
+          for(int b = 0; b < n; b++) normal[a][b] += jacobian[r][a] * jacobian[r][b];
+        }
+      }
+    }
+
+    // Try steps until one helps, damping harder each time one doesn't
+    bool improved = false;
+    while(!improved && damping < 1e6)
+    {
+      double matrix[CALIBRATION_PARAMETERS][CALIBRATION_PARAMETERS];
+      double step[CALIBRATION_PARAMETERS];
+      for(int a = 0; a < n; a++)
+      {
+        for(int b = 0; b < n; b++) matrix[a][b] = normal[a][b];
+        matrix[a][a] += damping * (normal[a][a] + 1e-9);
+        step[a] = gradient[a];
+      }
+      if(!calibrationSolve(matrix, step))
+      {
+        damping *= 10;
+        continue;
+      }
+
+      CameraModel tried = fit;
+      for(int parameter = 0; parameter < n; parameter++) *calibrationParameter(tried, parameter) += step[parameter];
+      float triedCost = calibrationCost(tried, samples, count);
+      if(triedCost < cost)
+      {
+        fit = tried;
+        improved = cost - triedCost > cost * 1e-6;
+        cost = triedCost;
+        damping = fmax(damping / 10, 1e-7);
+        if(!improved) damping = 1e6; // Converged
+      }
+      else
+      {
+        damping *= 10;
+      }
+    }
+    if(!improved)
+    {
+      break;
+    }
+  }
+
+  *rmsAfter = sqrt(cost / (count * 3));
+  if(!(*rmsAfter <= *rmsBefore) || fit.focalLength <= 0)
+  {
+    return false;
+  }
+  camera = fit;
+  return true;
+}
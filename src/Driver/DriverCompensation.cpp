@@ -0,0 +1,88 @@
+#include "DriverCompensation.hpp"
+#include <cmath>
+
+float compensationCommand(const MotorCompensation& compensation, float power)
+// What to actually send the motor to get the power asked for
+{
+  bool stopped = compensation.lastCommand == 0; // Settled on the target, or never started
+  if(fabs(power) < COMPENSATION_MIN_POWER || (stopped && fabs(power) < compensation.holdPower))
+  {
+    return 0;
+  }
+
+  float direction = power > 0 ? 1 : -1;
+
+  // Squash the power into what's left above the deadband, so full stick is still 127
+  float compensated = direction * (compensation.deadband + fabs(power) * (127 - compensation.deadband) / 127);
+
+  // Still taking up the backlash from going the other way, get across it quickly
+  bool crossing = direction > 0 ? compensation.slop < compensation.backlash / 2 : compensation.slop > -compensation.backlash / 2;
+  if(crossing && fabs(compensated) < COMPENSATION_KICK_POWER)
+  {
+    compensated = direction * COMPENSATION_KICK_POWER;
+  }
+  return compensated;
+}
+
+
+float compensationObserve(MotorCompensation& compensation, float encoderStep, float dt)
+// Call once a loop with the command sent last loop (lastCommand) and how far the encoder moved since.
+// Returns how far the output moved, which is the encoder step minus whatever went into the backlash
+{
+  float lastSlop = compensation.slop;
+  compensation.slop += encoderStep;
+  if(compensation.slop > compensation.backlash / 2) compensation.slop = compensation.backlash / 2;
+  if(compensation.slop < -compensation.backlash / 2) compensation.slop = -compensation.backlash / 2;
+
+  float command = fabs(compensation.lastCommand);
+  if(dt > 0 && command >= COMPENSATION_MIN_POWER && command < COMPENSATION_LEARN_POWER)
+  {
+    if(fabs(encoderStep) / dt < COMPENSATION_STALL_SPEED)
+    {
+      // Pushing and not moving, so it needs more than we gave it
+      if(++compensation.stalledTicks >= COMPENSATION_STALL_TICKS && compensation.deadband < COMPENSATION_MAX_DEADBAND)
+      {
+        compensation.deadband += COMPENSATION_DEADBAND_STEP;
+        compensation.stalledTicks = 0;
+      }
+    }
+    else
+    {
+      // Moving, so maybe we gave it more than it needed. Creeps down until it stalls again
+      compensation.stalledTicks = 0;
+      if(compensation.deadband > 0 && command < compensation.deadband + COMPENSATION_MIN_POWER * 2)
+      {
+        compensation.deadband -= COMPENSATION_DEADBAND_LEAK;
+      }
+    }
+  }
+  else
+  {
+    compensation.stalledTicks = 0;
+  }
+
+  return encoderStep - (compensation.slop - lastSlop);
+}
+
+
+void compensationLearnBacklash(MotorCompensation& compensation, float encoder, float absolute, float speed)
+// Going up the motor is ahead of the output by half the backlash, going down it's behind by half,
+// so the difference between the two offsets is the whole backlash whatever the encoder's zero is
+{
+  float offset = encoder - absolute;
+  if(speed > COMPENSATION_BACKLASH_SPEED)
+  {
+    compensation.upOffset = compensation.upSeen ? compensation.upOffset + (offset - compensation.upOffset) * COMPENSATION_BACKLASH_BLEND : offset;
+    compensation.upSeen = true;
+  }
+  else if(speed < -COMPENSATION_BACKLASH_SPEED)
+  {
+    compensation.downOffset = compensation.downSeen ? compensation.downOffset + (offset - compensation.downOffset) * COMPENSATION_BACKLASH_BLEND : offset;
+    compensation.downSeen = true;
+  }
+
+  if(compensation.upSeen && compensation.downSeen)
+  {
+    compensation.backlash = fmax(compensation.upOffset - compensation.downOffset, 0);
+  }
+}
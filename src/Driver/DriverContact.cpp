@@ -0,0 +1,105 @@
+#include "DriverContact.hpp"
+#include <algorithm>
+#include <cmath>
+
+#define CONTACT_NEVER 1e6 // Seconds, for not closing at all
+
+void contactReset(ContactEstimate& estimate)
+{
+  estimate.count = 0;
+  estimate.next = 0;
+  estimate.expansion = 0;
+  estimate.yRate = 0;
+}
+
+static float contactSlope(const float* values, const uint32_t* times, int count, int next) // Theil-Sen, per second
+// Only pairs at least half the window apart go in: next-door frames are 20ms apart, where a pixel of noise
+// swamps a pixel of growth
+{
+  float slopes[CONTACT_WINDOW * CONTACT_WINDOW / 4];
+  int n = 0;
+  int first = next + CONTACT_WINDOW - count; // Oldest frame, still in the ring once taken % CONTACT_WINDOW
+  for(int i = 0; i < count; i++)
+  {
+    for(int j = i + count / 2; j < count; j++)
+    {
+      int a = (first + i) % CONTACT_WINDOW;
+      int b = (first + j) % CONTACT_WINDOW;
+      int32_t dt = (int32_t)(times[b] - times[a]);
+      if(dt != 0)
+      {
+        slopes[n++] = (values[b] - values[a]) * 1000 / dt;
+      }
+    }
+  }
+  if(n == 0)
+  {
+    return 0;
+  }
+  std::nth_element(slopes, slopes + n / 2, slopes + n);
+  return slopes[n / 2];
+}
+
+void contactUpdate(ContactEstimate& estimate, float width, float yMiddle, uint32_t now) // Once per new frame of the ball
+{
+  if(width <= 0)
+  {
+    return;
+  }
+  if(estimate.count > 0 && now - estimate.time[(estimate.next + CONTACT_WINDOW - 1) % CONTACT_WINDOW] > CONTACT_MAX_GAP)
+  {
+    contactReset(estimate); // Lost it for a while, the old frames don't say anything about now
+  }
+
+  estimate.logWidth[estimate.next] = logf(width);
+  estimate.y[estimate.next] = yMiddle;
+  estimate.time[estimate.next] = now;
+  estimate.next = (estimate.next + 1) % CONTACT_WINDOW;
+  if(estimate.count < CONTACT_WINDOW)
+  {
+    estimate.count++;
+  }
+
+  if(estimate.count >= CONTACT_MIN_FRAMES)
+  {
+    estimate.expansion = contactSlope(estimate.logWidth, estimate.time, estimate.count, estimate.next);
+    estimate.yRate = contactSlope(estimate.y, estimate.time, estimate.count, estimate.next);
+  }
+}
+
+bool contactValid(const ContactEstimate& estimate, uint32_t now)
+{
+  return estimate.count >= CONTACT_MIN_FRAMES && now - estimate.time[(estimate.next + CONTACT_WINDOW - 1) % CONTACT_WINDOW] <= CONTACT_MAX_GAP;
+}
+
+float contactTimeTo(const ContactEstimate& estimate, float width, float targetWidth)
+// Seconds until the ball is targetWidth wide at the speed we're closing now. Width goes as 1/depth, so
+// with tau = 1/expansion to reach the camera, getting to targetWidth takes tau * (1 - width / targetWidth)
+{
+  if(width >= targetWidth)
+  {
+    return 0; // Already there, however fast we're going
+  }
+  if(estimate.expansion <= 0)
+  {
+    return CONTACT_NEVER;
+  }
+  return (1 - width / targetWidth) / estimate.expansion;
+}
+
+float contactBrake(const ContactEstimate& estimate, uint32_t now, float width, float targetWidth, float maxPower, const ControlGains& gains)
+// The most forward power (closing in) to allow, easing off from maxPower as the time to targetWidth runs out, so
+// the assist can come in fast and still not run into the ball. It's meant as the PID's outputMax rather than a
+// scale on its output, so the anti-windup sees it and the integral doesn't wind up against the brake
+{
+  if(!contactValid(estimate, now))
+  {
+    return maxPower;
+  }
+  float time = contactTimeTo(estimate, width, targetWidth);
+  if(time >= gains.contactBrakeTime)
+  {
+    return maxPower;
+  }
+  return maxPower * time / gains.contactBrakeTime;
+}
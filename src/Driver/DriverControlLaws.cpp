@@ -0,0 +1,63 @@
+#include "DriverControlLaws.hpp"
+#include "DriverGeometry.hpp"
+#include "DriverTargetEstimate.hpp"
+#include "DriverRange.hpp"
+#include "DriverContact.hpp"
+
+ControlGains controlGains = {BASE_P, BASE_P * 5, ARM_P, BASE_FORWARD_D_FILTER, TARGET_COAST_TIME, TARGET_BLEND, RANGE_GATE, CONTACT_BRAKE_TIME};
+
+PidGains forwardPidGains(const ControlGains& gains) // Shared with the simulator, so the tuner scores forwardP in the PID it'll really run in
+{
+  return {gains.forwardP, BASE_FORWARD_I, BASE_FORWARD_D, gains.forwardDFilter, 1, BASE_FORWARD_ANTI_WINDUP, -127, 127};
+}
+
+static inline float turnPower(const ControlGains& gains, bool seen, float xMiddle)
+{
+  float x_error = xMiddle - visionAimX;
+  // Centers the vision, and any x deriviation is our error (the centre being wherever calibration found straight ahead)
+  // If the vision sensor is not centered with the arm, a trig formula needs to be here.
+  // It will then output absolute, or most likely relative angle error. P will have to be changed
+
+  float finalBasePower = x_error * gains.turnP; // For now a simple P based on X deriviation from the center of the vision
+  return seen ? finalBasePower : 0; // Worked out either way and then picked, which keeps the Batch loops branch free
+}
+
+static inline float forwardPower(const ControlGains& gains, bool seen, float width)
+{
+  float distance_error = width - BASE_DISTANCE_WIDTH;
+  float finalBasePower = distance_error * gains.forwardP;
+  return seen ? finalBasePower : 0;
+}
+
+float visionTurnPower(bool seen, float xMiddle) // Power to be sent to the base for turning
+{
+  return turnPower(controlGains, seen, xMiddle);
+}
+
+float visionForwardPower(bool seen, float width) // Power to be sent to the base for moving forward
+{
+  return forwardPower(controlGains, seen, width);
+}
+
+float armPower(float error)
+{
+  return error * controlGains.armP;
+}
+
+
+// Plain loops over the scalar versions. They get inlined and vectorised, so the simulator steps 4-8 robots per instruction
+void visionTurnPowerBatch(const ControlGains& gains, const float* seen, const float* xMiddle, float* power, int count)
+{
+  for(int i = 0; i < count; i++)
+  {
+    power[i] = turnPower(gains, seen[i] != 0, xMiddle[i]);
+  }
+}
+
+void armPowerBatch(const ControlGains& gains, const float* error, float* power, int count)
+{
+  for(int i = 0; i < count; i++)
+  {
+    power[i] = error[i] * gains.armP;
+  }
+}
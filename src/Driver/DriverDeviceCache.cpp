@@ -0,0 +1,64 @@
+#include "DriverDeviceCache.hpp"
+
+DeviceSnapshot& deviceNextFrame(DeviceCache& cache) // The frame the owner fills in, once a tick before devicePublish
+{
+  cache.sequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release); // Readers see the count move before any of the writes
+  return cache.frames[1 - cache.current.load(std::memory_order_relaxed)];
+}
+
+void devicePublish(DeviceCache& cache) // Once deviceNextFrame is filled in. Catches the buttons newly down since the last one
+{
+  int next = 1 - cache.current.load(std::memory_order_relaxed);
+  uint16_t was = cache.frames[1 - next].controller.held;
+  uint16_t now = cache.frames[next].controller.held;
+  cache.pressed.fetch_or(now & ~was, std::memory_order_relaxed);
+  cache.current.store(next, std::memory_order_release);
+  cache.sequence.fetch_add(1, std::memory_order_release);
+}
+
+void deviceRead(const DeviceCache& cache, DeviceSnapshot* snapshot)
+{
+  uint32_t before, after;
+  do
+  {
+    before = cache.sequence.load(std::memory_order_acquire);
+    *snapshot = cache.frames[cache.current.load(std::memory_order_acquire)];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = cache.sequence.load(std::memory_order_relaxed);
+  } while(before != after); // The owner wrote something meanwhile, which might have been this frame
+}
+
+bool controllerHeld(const ControllerReading& controller, int button)
+{
+  return controller.held & (1 << (button - CONTROLLER_DIGITAL_FIRST));
+}
+
+bool controllerNewPress(DeviceCache& cache, int button)
+// Like get_digital_new_press, true once per press. Only one task should ask about each button. A press that
+// was let go before anyone asked (in disabled or autonomous, say) is dropped rather than going off late
+{
+  uint16_t bit = 1 << (button - CONTROLLER_DIGITAL_FIRST);
+  bool pressed = cache.pressed.fetch_and(~bit, std::memory_order_relaxed) & bit;
+  return pressed && controllerHeld(cache.frames[cache.current.load(std::memory_order_acquire)].controller, button);
+}
+
+void portCount(PortStats& stats, int port, int reads, bool busy)
+{
+  if(port < 0 || port >= PORT_COUNT)
+  {
+    return;
+  }
+  stats.reads[port] += reads;
+  stats.busy[port] += busy;
+}
+
+uint32_t portTotal(const PortStats& stats, bool busy)
+{
+  uint32_t total = 0;
+  for(int port = 0; port < PORT_COUNT; port++)
+  {
+    total += busy ? stats.busy[port] : stats.reads[port];
+  }
+  return total;
+}
@@ -0,0 +1,91 @@
+#include "main.hpp"
+#include <cerrno>
+#include "DriverDevices.hpp"
+#include "DriverStorage.hpp"
+
+// The motors and the controller are only read here, once a tick from motorTask, which already owns writing
+// them. Everything else takes a deviceSnapshot. The vision sensor has its own owner, monitorVisionTask, which
+// counts its reads in here so the log has every port
+
+DeviceCache deviceCache;
+PortStats devicePorts;
+
+static const controller_digital_e_t deviceButtons[] = // The ones something uses. A new one has to go in here to be read
+{
+  E_CONTROLLER_DIGITAL_DOWN, // Vision assist, DriverBaseControl
+  E_CONTROLLER_DIGITAL_LEFT, // Arm assist, armP
+  E_CONTROLLER_DIGITAL_X, // Camera calibration, opcontrol
+  E_CONTROLLER_DIGITAL_B, // Calling calibration off
+};
+
+DeviceSnapshot deviceSnapshot() // What the motors and controller were at the start of this tick
+{
+  DeviceSnapshot snapshot;
+  deviceRead(deviceCache, &snapshot);
+  return snapshot;
+}
+
+bool deviceNewPress(controller_digital_e_t button) // Like get_digital_new_press. Only one task should ask about each button
+{
+  return controllerNewPress(deviceCache, button);
+}
+
+void devicePoll(pros::Motor* motors, const uint8_t* ports) // Once a tick, from motorTask
+{
+  DeviceSnapshot& frame = deviceNextFrame(deviceCache);
+  frame.time = millis();
+  for(int motor = 0; motor < MOTOR_COUNT; motor++)
+  {
+    MotorReading& reading = frame.motors[motor];
+    errno = 0;
+    double position = motors[motor].get_position();
+    double rpm = motors[motor].get_actual_velocity();
+    double watts = motors[motor].get_power();
+    int32_t milliamps = motors[motor].get_current_draw();
+    uint32_t faults = motors[motor].get_faults();
+    reading.valid = position != PROS_ERR_F && rpm != PROS_ERR_F && watts != PROS_ERR_F && milliamps != PROS_ERR && faults != (uint32_t)PROS_ERR;
+    if(reading.valid)
+    {
+      reading.position = position;
+      reading.rpm = rpm;
+      reading.watts = watts;
+      reading.milliamps = milliamps;
+      reading.faults = faults;
+    }
+    portCount(devicePorts, ports[motor], 5, errno == EACCES);
+  }
+
+  ControllerReading& controller = frame.controller;
+  errno = 0;
+  for(int channel = 0; channel < CONTROLLER_ANALOGS; channel++)
+  {
+    controller.analog[channel] = mainController.get_analog((controller_analog_e_t)channel);
+  }
+  controller.held = 0;
+  for(controller_digital_e_t button : deviceButtons)
+  {
+    controller.held |= (mainController.get_digital(button) == 1) << (button - CONTROLLER_DIGITAL_FIRST);
+  }
+  portCount(devicePorts, PORT_CONTROLLER, CONTROLLER_ANALOGS + sizeof(deviceButtons) / sizeof(deviceButtons[0]), errno == EACCES);
+  devicePublish(deviceCache);
+}
+
+void devicePortRead(uint8_t port, int reads, bool failed) // For the other owners, failed being PROS_ERR with EACCES
+{
+  portCount(devicePorts, port, reads, failed);
+}
+
+void deviceLog() // Reads by port, into the storage log
+{
+  char line[128];
+  int length = snprintf(line, sizeof(line), "ports:");
+  for(int port = 0; port < PORT_COUNT; port++)
+  {
+    if(devicePorts.reads[port] && length < (int)sizeof(line))
+    {
+      length += snprintf(line + length, sizeof(line) - length, " %d %lu/%lu", port, (unsigned long)devicePorts.reads[port],
+        (unsigned long)devicePorts.busy[port]);
+    }
+  }
+  storageLog("%s reads/busy, %lu busy in all\n", line, (unsigned long)portTotal(devicePorts, true));
+}
@@ -0,0 +1,59 @@
+#include "DriverEnergy.hpp"
+
+void energyAdd(EnergyMeter& meter, ArbiterMotor motor, const float* share, float watts, float dt)
+// Once a tick per motor, with what the motor drew over dt and the arbiter's share from the command it was running then
+{
+  if(watts <= 0 || dt <= 0)
+  {
+    return;
+  }
+  float joules = watts * dt;
+  float attributed = 0;
+  for(int source = 0; source < SOURCE_COUNT; source++)
+  {
+    meter.joules[motor][source] += joules * share[source];
+    attributed += share[source];
+  }
+  meter.joules[motor][ENERGY_IDLE] += joules * (1 - attributed); // All of it when nothing was commanding the motor
+}
+
+void energyBall(EnergyMeter& meter) // A ball got picked up
+{
+  meter.balls++;
+  meter.ballJoules = energyTotal(meter);
+}
+
+float energyTotal(const EnergyMeter& meter)
+{
+  float total = 0;
+  for(int motor = 0; motor < MOTOR_COUNT; motor++)
+  {
+    total += energyOfMotor(meter, (ArbiterMotor)motor);
+  }
+  return total;
+}
+
+float energyOfMotor(const EnergyMeter& meter, ArbiterMotor motor)
+{
+  float total = 0;
+  for(int bucket = 0; bucket < ENERGY_BUCKETS; bucket++)
+  {
+    total += meter.joules[motor][bucket];
+  }
+  return total;
+}
+
+float energyOfSource(const EnergyMeter& meter, int bucket) // A source, or ENERGY_IDLE
+{
+  float total = 0;
+  for(int motor = 0; motor < MOTOR_COUNT; motor++)
+  {
+    total += meter.joules[motor][bucket];
+  }
+  return total;
+}
+
+float energyPerBall(const EnergyMeter& meter) // Joules up to the last ball, over the balls. 0 before the first
+{
+  return meter.balls ? meter.ballJoules / meter.balls : 0;
+}
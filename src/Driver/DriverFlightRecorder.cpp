@@ -0,0 +1,143 @@
+#include "DriverFlightRecorder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const RecorderTriggers recorderDefaultTriggers = {
+  10, // 200ms of frames
+  0xFFFFFFFF, // PROS doesn't say what the bits are yet, so any of them
+  5, // Half a control tick
+};
+
+static inline int16_t recorderClamp(float value)
+{
+  return std::clamp(lroundf(value), -32768L, 32767L);
+}
+
+void recorderReset(FlightRecorder& recorder, const RecorderTriggers& triggers)
+{
+  memset(recorder.entries, 0, sizeof(recorder.entries));
+  recorder.written = 0;
+  recorder.state = RECORDER_ARMED;
+  recorder.triggers = triggers;
+  recorder.triggerTime = 0;
+  recorder.triggerReason = 0;
+  recorder.triggerCount = 0;
+  recorder.lostFrames = 0;
+  recorder.hadBall = false;
+}
+
+void recorderAdd(FlightRecorder& recorder, uint32_t now, RecorderKind kind, uint8_t flags, int16_t a, int16_t b, int16_t c, int16_t d,
+  int16_t e, int16_t f)
+{
+  if(recorderFrozen(recorder, now))
+  {
+    return;
+  }
+  RecorderEntry& entry = recorder.entries[recorder.written.fetch_add(1, std::memory_order_relaxed) % RECORDER_ENTRIES];
+  entry.time = now;
+  entry.kind = kind;
+  entry.flags = flags;
+  entry.values[0] = a;
+  entry.values[1] = b;
+  entry.values[2] = c;
+  entry.values[3] = d;
+  entry.values[4] = e;
+  entry.values[5] = f;
+}
+
+bool recorderTrigger(FlightRecorder& recorder, uint32_t now, RecorderReason reason, int16_t detail)
+// Only the first trigger counts until it's been dumped and rearmed, anything in the aftermath is just recorded
+{
+  int armed = RECORDER_ARMED;
+  if(!recorder.state.compare_exchange_strong(armed, RECORDER_TRIGGERED))
+  {
+    return false;
+  }
+  recorder.triggerTime = now;
+  recorder.triggerReason = reason;
+  recorder.triggerCount++;
+  recorderAdd(recorder, now, RECORD_TRIGGER, reason, detail);
+  return true;
+}
+
+void recorderVision(FlightRecorder& recorder, uint32_t now, const pros::c::vision_object_s_t& object, int32_t objectCount)
+// Every new frame. Losing a ball we had for triggers.lostFrames in a row sets it off
+{
+  recorderAdd(recorder, now, RECORD_VISION, 0, object.signature, object.x_middle_coord, object.y_middle_coord, object.width,
+    object.height, recorderClamp(objectCount));
+  if(object.signature != VISION_OBJECT_ERR_SIG)
+  {
+    recorder.hadBall = true;
+    recorder.lostFrames = 0;
+    return;
+  }
+  if(recorder.hadBall && ++recorder.lostFrames == recorder.triggers.lostFrames)
+  {
+    recorderTrigger(recorder, now, TRIGGER_LOST_TRACK, recorder.lostFrames);
+    recorder.hadBall = false;
+  }
+}
+
+void recorderControl(FlightRecorder& recorder, uint32_t now, uint8_t who, float turn, float forward, float arm)
+{
+  recorderAdd(recorder, now, RECORD_CONTROL, who, recorderClamp(turn), recorderClamp(forward), recorderClamp(arm));
+}
+
+void recorderMotor(FlightRecorder& recorder, uint32_t now, uint8_t motor, int32_t command, float rpm, int32_t milliamps, float watts,
+  uint32_t faults)
+{
+  recorderAdd(recorder, now, RECORD_MOTOR, motor, recorderClamp(command), recorderClamp(rpm), recorderClamp(milliamps),
+    recorderClamp(watts * 100), (int16_t)(faults & 0xFFFF));
+  if(faults & recorder.triggers.faultMask)
+  {
+    recorderTrigger(recorder, now, TRIGGER_MOTOR_FAULT, motor);
+  }
+}
+
+void recorderDeadline(FlightRecorder& recorder, uint32_t now, uint8_t task, uint32_t wake, uint32_t period)
+// Right after a task_delay_until, with the wake time it was meant to have. Only late ones get an entry
+{
+  int32_t late = now - wake;
+  if(late <= 0)
+  {
+    return;
+  }
+  recorderAdd(recorder, now, RECORD_LATE, task, recorderClamp(late), recorderClamp(period));
+  if(recorder.triggers.lateMs && (uint32_t)late >= recorder.triggers.lateMs)
+  {
+    recorderTrigger(recorder, now, TRIGGER_LATE, task);
+  }
+}
+
+bool recorderFrozen(FlightRecorder& recorder, uint32_t now) // The aftermath's been recorded, it's ready to dump
+{
+  int state = recorder.state.load(std::memory_order_relaxed);
+  if(state == RECORDER_TRIGGERED && now - recorder.triggerTime >= RECORDER_POST_TRIGGER)
+  {
+    recorder.state.compare_exchange_strong(state, RECORDER_FROZEN);
+    state = RECORDER_FROZEN;
+  }
+  return state == RECORDER_FROZEN;
+}
+
+uint32_t recorderSnapshot(FlightRecorder& recorder, const RecorderEntry** first)
+// Once frozen. Turns the ring round in place so it's oldest first, and returns how many entries there are
+{
+  uint32_t written = recorder.written.load();
+  uint32_t count = std::min(written, (uint32_t)RECORDER_ENTRIES);
+  *first = recorder.entries;
+  if(count == 0)
+  {
+    return 0;
+  }
+  std::rotate(recorder.entries, recorder.entries + written % count, recorder.entries + count);
+  recorder.written = count; // Carries on from the end of the rotated ring after rearming
+  return count;
+}
+
+void recorderRearm(FlightRecorder& recorder)
+{
+  recorder.lostFrames = 0;
+  recorder.state = RECORDER_ARMED;
+}
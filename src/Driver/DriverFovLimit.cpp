@@ -0,0 +1,26 @@
+#include "DriverFovLimit.hpp"
+#include "DriverObstacles.hpp"
+#include <algorithm>
+#include <cmath>
+
+#define FOV_POWER_PER_YAW (127 * BASE_TRACK_WIDTH / 2 / BASE_MAX_SPEED) // Turn power for 1 rad/s, with the turn on both sides
+
+float fovYawRate(float leftSpeed, float rightSpeed)
+{
+  return (leftSpeed - rightSpeed) / BASE_TRACK_WIDTH; // A positive turn is left forward, right back, which is clockwise
+}
+
+float fovTurnLimit(const CameraModel& camera, float imageX, float turn, float yawRate, float latency)
+// A positive turn moves the ball left in the image. How far it can go either way is the angle to each
+// margin, less what the base will turn anyway from how fast it's spinning now. That can ask for the turn
+// to go the other way, which is the point: it's braking before the ball gets there, not once it's gone
+{
+  float bearing = atanf((imageX - camera.centerX) / camera.focalLength); // Right of the optical axis
+  float leftEdge = atanf((FOV_MARGIN - camera.centerX) / camera.focalLength);
+  float rightEdge = atanf((VISION_FOV_WIDTH - FOV_MARGIN - camera.centerX) / camera.focalLength);
+  float coasting = yawRate * (latency + FOV_LAG); // Already turned since the frame, and still to turn stopping
+
+  float mostPositive = (bearing - leftEdge - coasting) / (FOV_FRAME_TIME + latency) * FOV_POWER_PER_YAW;
+  float mostNegative = (bearing - rightEdge - coasting) / (FOV_FRAME_TIME + latency) * FOV_POWER_PER_YAW;
+  return std::clamp(turn, std::clamp(mostNegative, -127.0f, 127.0f), std::clamp(mostPositive, -127.0f, 127.0f));
+}
@@ -0,0 +1,93 @@
+#include "DriverGeometry.hpp"
+#include "Util/FastMath.hpp"
+#include <cmath>
+
+#define VISION_HFOV 61.0 // Horizontal field of view of the sensor in degrees
+
+CameraModel cameraModel =
+{
+  (VISION_FOV_WIDTH / 2) / (float)tan(VISION_HFOV / 2 * M_PI / 180), // focalLength
+  VISION_FOV_WIDTH / 2, // centerX
+  VISION_FOV_HEIGHT / 2, // centerY
+  6.0, // mountForward
+  0.0, // mountLeft
+  0.0, // mountYaw
+  10.0, // mountHeight
+  0.35, // mountPitch
+};
+
+float visionAimX = VISION_FOV_WIDTH / 2; // Set from cameraAimX(cameraModel) whenever the model changes
+
+
+void odometryStep(RobotPose& pose, float leftTravel, float rightTravel, float strafeTravel) // Moves the pose by one set of wheel travels
+{
+  float turn = (rightTravel - leftTravel) / BASE_TRACK_WIDTH;
+  float forward = (leftTravel + rightTravel) / 2;
+  float midHeading = pose.heading + turn / 2; // Using the heading halfway through the step keeps arcs accurate
+
+  // Positive strafe is to the right, which is -90 degrees from the heading
+  float headingSin = fastSin(midHeading);
+  float headingCos = fastCos(midHeading);
+  pose.x += forward * headingCos + strafeTravel * headingSin;
+  pose.y += forward * headingSin - strafeTravel * headingCos;
+  pose.heading += turn;
+}
+
+
+bool imageToField(const CameraModel& camera, const RobotPose& pose, float imageX, float width, float* fieldX, float* fieldY, float objectWidth)
+{
+  if(width <= 0)
+  {
+    return false;
+  }
+
+  // Pinhole camera: the ball's apparent width gives its depth, and its x offset scaled by depth gives how far left it is
+  float depth = objectWidth * camera.focalLength / width;
+  float left = -(imageX - camera.centerX) * depth / camera.focalLength;
+
+  float headingSin = fastSin(pose.heading);
+  float headingCos = fastCos(pose.heading);
+  float cameraSin = fastSin(pose.heading + camera.mountYaw);
+  float cameraCos = fastCos(pose.heading + camera.mountYaw);
+  float cameraX = pose.x + camera.mountForward * headingCos - camera.mountLeft * headingSin;
+  float cameraY = pose.y + camera.mountForward * headingSin + camera.mountLeft * headingCos;
+
+  *fieldX = cameraX + depth * cameraCos - left * cameraSin;
+  *fieldY = cameraY + depth * cameraSin + left * cameraCos;
+  return true;
+}
+
+
+bool fieldToImage(const CameraModel& camera, const RobotPose& pose, float fieldX, float fieldY, float* imageX, float* imageY, float* width,
+  float objectWidth, float objectHeight)
+{
+  float headingSin = fastSin(pose.heading);
+  float headingCos = fastCos(pose.heading);
+  float cameraSin = fastSin(pose.heading + camera.mountYaw);
+  float cameraCos = fastCos(pose.heading + camera.mountYaw);
+  float cameraX = pose.x + camera.mountForward * headingCos - camera.mountLeft * headingSin;
+  float cameraY = pose.y + camera.mountForward * headingSin + camera.mountLeft * headingCos;
+
+  float dx = fieldX - cameraX;
+  float dy = fieldY - cameraY;
+  float depth = dx * cameraCos + dy * cameraSin;
+  float left = -dx * cameraSin + dy * cameraCos;
+
+  if(depth < objectWidth) // Behind or right against the lens, there's no sensible image position
+  {
+    return false;
+  }
+
+  float below = fastAtan2(camera.mountHeight - objectHeight, depth) - camera.mountPitch; // Angle down from the optical axis to the ball
+
+  *imageX = camera.centerX - left * camera.focalLength / depth;
+  *imageY = camera.centerY + camera.focalLength * fastSin(below) / fastCos(below); // Positive y is down in the image
+  *width = objectWidth * camera.focalLength / depth;
+  return true;
+}
+
+
+float cameraAimX(const CameraModel& camera) // A camera turned left sees straight ahead off to the right
+{
+  return camera.centerX + camera.focalLength * fastSin(camera.mountYaw) / fastCos(camera.mountYaw);
+}
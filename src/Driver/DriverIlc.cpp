@@ -0,0 +1,157 @@
+#include "DriverIlc.hpp"
+#include "DriverGeometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define ILC_TURN (M_PI / 2 * BASE_TRACK_WIDTH / 2) // Inches each wheel goes for a quarter turn on the spot
+
+const RoutineSegment autonomousRoutine[] = { // Peak speed on a minimum jerk move is 1.9x the average, kept under 3/4 of flat out
+  {{24, 24}, 3.0}, // Out to the first ball
+  {{-ILC_TURN, ILC_TURN}, 1.5}, // Left, on the spot
+  {{18, 18}, 2.4},
+  {{20, 12}, 2.6}, // Curving round to the right
+  {{ILC_TURN / 2, -ILC_TURN / 2}, 1.0},
+  {{-24, -24}, 3.0}, // Back to the start of driver control
+};
+const int autonomousRoutineLength = sizeof(autonomousRoutine) / sizeof(autonomousRoutine[0]);
+
+uint32_t ilcRoutineId(const RoutineSegment* routine, int segments) // FNV-1a over the segments, so a changed routine starts learning fresh
+{
+  uint32_t hash = 2166136261u;
+  const uint8_t* bytes = (const uint8_t*)routine;
+  for(size_t i = 0; i < segments * sizeof(RoutineSegment); i++)
+  {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+void ilcReset(IlcTable& table, uint32_t routine)
+{
+  memset(&table, 0, sizeof(table));
+  table.routine = routine;
+}
+
+void ilcRecordReset(IlcRecord& record)
+{
+  memset(&record, 0, sizeof(record));
+}
+
+float routineDuration(const RoutineSegment* routine, int segments)
+{
+  float duration = 0;
+  for(int i = 0; i < segments; i++)
+  {
+    duration += routine[i].duration;
+  }
+  return duration;
+}
+
+static inline float routineProfile(float fraction, float* rate) // Minimum jerk, 0 to 1 with no speed or acceleration at either end
+{
+  float f = std::clamp(fraction, 0.0f, 1.0f);
+  float f2 = f * f;
+  *rate = 30 * f2 * (f - 1) * (f - 1);
+  return f2 * f * (10 - 15 * f + 6 * f2);
+}
+
+bool ilcStep(const IlcTable& table, IlcRecord& record, const RoutineSegment* routine, int segments, float time, const float* travel,
+  float* power)
+// Every control tick. time is seconds since the routine started, travel the inches each wheel has gone since.
+// Fills in power for each side, and returns false once the routine's over, when power just holds the end
+{
+  float start[ILC_SIDES] = {0, 0};
+  int segment = 0;
+  while(segment < segments && time >= routine[segment].duration)
+  {
+    time -= routine[segment].duration;
+    for(int side = 0; side < ILC_SIDES; side++)
+    {
+      start[side] += routine[segment].travel[side];
+    }
+    segment++;
+  }
+
+  if(segment >= segments)
+  {
+    for(int side = 0; side < ILC_SIDES; side++)
+    {
+      power[side] = (start[side] - travel[side]) * ILC_TRACK_P;
+    }
+    return false;
+  }
+
+  const RoutineSegment& move = routine[segment];
+  float rate;
+  float done = routineProfile(time / move.duration, &rate);
+  int sample = std::min((int)(time / ILC_SAMPLE_TIME), ILC_SAMPLES - 1);
+  for(int side = 0; side < ILC_SIDES; side++)
+  {
+    float error = start[side] + move.travel[side] * done - travel[side];
+    float speed = move.travel[side] * rate / move.duration;
+    power[side] = error * ILC_TRACK_P + speed * ILC_VELOCITY_POWER + table.power[segment][sample][side];
+    record.error[segment][sample][side] += error;
+  }
+  if(record.count[segment][sample] < 255)
+  {
+    record.count[segment][sample]++;
+  }
+  return true;
+}
+
+void ilcUpdate(IlcTable& table, const IlcRecord& record, int segments)
+// Between runs. Each entry gets the error from ILC_LEAD later on, as that's where its power shows up, then the
+// table's smoothed so it only keeps what's repeatable
+{
+  float error[ILC_SAMPLES];
+  float learnt[ILC_SAMPLES];
+  for(int segment = 0; segment < std::min(segments, ILC_SEGMENTS); segment++)
+  {
+    for(int side = 0; side < ILC_SIDES; side++)
+    {
+      int last = -1; // Entries past the end of the move never get a tick, they stay at 0
+      for(int sample = 0; sample < ILC_SAMPLES; sample++)
+      {
+        uint8_t count = record.count[segment][sample];
+        error[sample] = count ? record.error[segment][sample][side] / count : 0;
+        last = count ? sample : last;
+      }
+      for(int sample = 0; sample <= last; sample++)
+      {
+        int ahead = std::min(sample + ILC_LEAD, last);
+        float growth = ahead > 0 ? (error[ahead] - error[ahead - 1]) / ILC_SAMPLE_TIME : 0;
+        learnt[sample] = table.power[segment][sample][side] + ILC_LEARN_P * error[ahead] + ILC_LEARN_D * growth;
+      }
+      for(int sample = 0; sample <= last; sample++)
+      {
+        float before = learnt[std::max(sample - 1, 0)];
+        float after = learnt[std::min(sample + 1, last)];
+        float smoothed = (1 - 2 * ILC_SMOOTH) * learnt[sample] + ILC_SMOOTH * (before + after);
+        table.power[segment][sample][side] = std::clamp(smoothed, (float)-ILC_LIMIT, (float)ILC_LIMIT);
+      }
+    }
+  }
+  table.runs++;
+}
+
+float ilcSegmentError(const IlcRecord& record, int segment) // RMS inches over both wheels, for the log
+{
+  double sum = 0;
+  int count = 0;
+  for(int sample = 0; sample < ILC_SAMPLES; sample++)
+  {
+    uint8_t ticks = record.count[segment][sample];
+    if(ticks == 0)
+    {
+      continue;
+    }
+    for(int side = 0; side < ILC_SIDES; side++)
+    {
+      float error = record.error[segment][sample][side] / ticks;
+      sum += error * error;
+      count++;
+    }
+  }
+  return count ? sqrt(sum / count) : 0;
+}
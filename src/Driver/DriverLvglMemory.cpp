@@ -0,0 +1,137 @@
+#include "main.hpp"
+#include <atomic>
+#include <cstring>
+#include "display/lv_misc/lv_mem.h"
+#include "Util/PoolAllocator.hpp"
+#include "DriverStorage.hpp"
+#include "DriverLvglMemory.hpp"
+
+// LVGL's allocator, swapped for PoolAllocator. libpros.a has LVGL already built with LV_MEM_CUSTOM_ALLOC as
+// kmalloc, so changing lv_conf.h wouldn't reach it. Instead this file defines every function lv_mem.c does,
+// and the linker takes ours and never pulls lv_mem.c out of the library. Anything too big for the pools, or
+// asked for when they're full, still goes to kmalloc with its size in front of it.
+
+#define LVGL_HEAP_HEADER 8 // Bytes in front of a kmalloc'd block, holding its size. 8 keeps the alignment
+
+extern "C" void* kmalloc(size_t size);
+extern "C" void kfree(void* pointer);
+
+static uint32_t zeroBlock; // What asking for 0 bytes gets, like lv_mem.c
+static std::atomic<uint32_t> heapBlocks; // Live blocks that had to go to kmalloc
+
+extern "C" void lv_mem_init(void)
+{
+  poolInit();
+}
+
+extern "C" void* lv_mem_alloc(uint32_t size)
+{
+  if(size == 0)
+  {
+    return &zeroBlock;
+  }
+  void* block = poolAlloc(size);
+  if(block != NULL)
+  {
+    return block;
+  }
+  uint8_t* heap = (uint8_t*)kmalloc(size + LVGL_HEAP_HEADER);
+  if(heap == NULL)
+  {
+    return NULL;
+  }
+  memcpy(heap, &size, sizeof(size));
+  heapBlocks.fetch_add(1, std::memory_order_relaxed);
+  return heap + LVGL_HEAP_HEADER;
+}
+
+extern "C" void lv_mem_free(const void* data)
+{
+  if(data == NULL || data == &zeroBlock)
+  {
+    return;
+  }
+  if(!poolFree(data))
+  {
+    heapBlocks.fetch_sub(1, std::memory_order_relaxed);
+    kfree((uint8_t*)data - LVGL_HEAP_HEADER);
+  }
+}
+
+extern "C" uint32_t lv_mem_get_size(const void* data)
+{
+  if(data == NULL || data == &zeroBlock)
+  {
+    return 0;
+  }
+  uint32_t size = poolBlockSize(data);
+  if(size == 0)
+  {
+    memcpy(&size, (const uint8_t*)data - LVGL_HEAP_HEADER, sizeof(size));
+  }
+  return size;
+}
+
+extern "C" void* lv_mem_realloc(void* data, uint32_t newSize)
+{
+  if(newSize != 0 && newSize <= poolBlockSize(data))
+  {
+    return data; // Still fits the block it's in
+  }
+  void* fresh = lv_mem_alloc(newSize);
+  if(fresh == NULL)
+  {
+    return NULL; // The old one is still there, same as lv_mem.c
+  }
+  uint32_t oldSize = lv_mem_get_size(data);
+  if(oldSize != 0)
+  {
+    memcpy(fresh, data, oldSize < newSize ? oldSize : newSize);
+  }
+  lv_mem_free(data);
+  return fresh;
+}
+
+extern "C" void lv_mem_defrag(void) // Fixed size blocks, there's nothing to join up
+{
+}
+
+extern "C" void lv_mem_monitor(lv_mem_monitor_t* monitor) // The pools only, for the LVGL sysmon
+{
+  PoolClassStats stats[POOL_CLASSES];
+  poolStats(stats);
+  memset(monitor, 0, sizeof(*monitor));
+  monitor->total_size = poolArenaSize();
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    uint32_t free = stats[c].blocks - stats[c].inUse;
+    monitor->used_cnt += stats[c].inUse;
+    monitor->free_cnt += free;
+    monitor->free_size += free * stats[c].blockSize;
+    if(free > 0)
+    {
+      monitor->free_biggest_size = stats[c].blockSize;
+    }
+  }
+  monitor->used_pct = 100 - 100ULL * monitor->free_size / monitor->total_size;
+  monitor->frag_pct = monitor->free_size ? 100 - 100ULL * monitor->free_biggest_size / monitor->free_size : 0;
+}
+
+
+uint32_t lvglHeapBlocks() // LVGL blocks living in the shared heap right now, which should stay 0
+{
+  return heapBlocks.load(std::memory_order_relaxed);
+}
+
+void lvglMemoryLog() // Each pool class into the storage log, to check the block counts against a real match
+{
+  PoolClassStats stats[POOL_CLASSES];
+  poolStats(stats);
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    storageLog("lvgl pool %4lu B: %3lu/%3lu in use, peak %3lu, %lu allocs, %lu spilled\n", (unsigned long)stats[c].blockSize,
+      (unsigned long)stats[c].inUse, (unsigned long)stats[c].blocks, (unsigned long)stats[c].peak,
+      (unsigned long)stats[c].allocs, (unsigned long)stats[c].spills);
+  }
+  storageLog("lvgl heap blocks %lu\n", (unsigned long)lvglHeapBlocks());
+}
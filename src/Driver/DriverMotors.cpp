@@ -0,0 +1,112 @@
+#include "main.hpp"
+#include <cstring>
+#include "DriverMotors.hpp"
+#include "DriverEnergy.hpp"
+#include "DriverStorage.hpp"
+#include "DriverBlackBox.hpp"
+#include "DriverDevices.hpp"
+
+// The only place motors get written, and read (see DriverDevices). Everything else goes through motorCommand()
+
+Arbiter motorArbiter;
+EnergyMeter motorEnergy; // What each motor has drawn, by source
+
+void motorCommand(ArbiterMotor motor, ArbiterSource source, float power, bool additive, uint32_t timeout) // Power is -127 to 127, like Motor::move
+{
+  arbiterSubmit(motorArbiter, motor, source, MODE_POWER, power, additive, millis(), timeout);
+}
+
+void motorVelocityCommand(ArbiterMotor motor, ArbiterSource source, float rpm, uint32_t timeout)
+{
+  arbiterSubmit(motorArbiter, motor, source, MODE_VELOCITY, rpm, false, millis(), timeout);
+}
+
+void motorRelease(ArbiterMotor motor, ArbiterSource source)
+{
+  arbiterRelease(motorArbiter, motor, source);
+}
+
+void motorCompensate(ArbiterMotor motor, MotorCompensation* compensation) // Deadband/backlash compensation for the final power
+{
+  motorArbiter.compensation[motor] = compensation;
+}
+
+uint32_t motorWrites()
+{
+  return motorArbiter.writes;
+}
+
+uint32_t motorWritesSkipped() // Ticks a motor already had the right command, so nothing was sent
+{
+  return motorArbiter.skipped;
+}
+
+void motorBallCollected() // For joules per ball
+{
+  energyBall(motorEnergy);
+}
+
+void motorEnergyLog() // Joules by motor and source into the storage log
+{
+  const char* motors[MOTOR_COUNT] = {"left", "right", "h", "arm"};
+  for(int motor = 0; motor < MOTOR_COUNT; motor++)
+  {
+    const float* joules = motorEnergy.joules[motor];
+    storageLog("energy %-5s %7.1f J: driver %.1f assist %.1f autonomous %.1f safety %.1f idle %.1f\n", motors[motor],
+      energyOfMotor(motorEnergy, (ArbiterMotor)motor), joules[SOURCE_DRIVER], joules[SOURCE_ASSIST], joules[SOURCE_AUTONOMOUS],
+      joules[SOURCE_SAFETY], joules[ENERGY_IDLE]);
+  }
+  storageLog("energy %.1f J, %lu balls, %.1f J per ball\n", energyTotal(motorEnergy), (unsigned long)motorEnergy.balls,
+    energyPerBall(motorEnergy));
+}
+
+
+void motorTask(void*)
+{
+  const uint8_t ports[MOTOR_COUNT] = {1, 5, 2, 3};
+  pros::Motor motors[MOTOR_COUNT] =
+  {
+    pros::Motor(ports[MOTOR_BASE_LEFT], pros::c::E_MOTOR_GEARSET_36, false),
+    pros::Motor(ports[MOTOR_BASE_RIGHT], pros::c::E_MOTOR_GEARSET_36, true),
+    pros::Motor(ports[MOTOR_BASE_H], pros::c::E_MOTOR_GEARSET_36, true),
+    pros::Motor(ports[MOTOR_ARM]),
+  };
+
+  uint32_t wakeTime = millis();
+  uint32_t lastTime = wakeTime;
+  while(true)
+  {
+    uint32_t now = millis();
+    float dt = (now - lastTime) / 1000.0;
+    lastTime = now;
+    devicePoll(motors, ports); // Everything read once, for every task
+    DeviceSnapshot devices = deviceSnapshot();
+    for(int motor = 0; motor < MOTOR_COUNT; motor++)
+    {
+      float ran[SOURCE_COUNT]; // Shares of the command the motor ran over the tick that just ended
+      memcpy(ran, motorArbiter.outputs[motor].share, sizeof(ran));
+      ArbiterMode mode;
+      int32_t value;
+      if(arbiterResolve(motorArbiter, (ArbiterMotor)motor, millis(), &mode, &value))
+      {
+        if(mode == MODE_VELOCITY)
+        {
+          motors[motor].move_velocity(value);
+        }
+        else
+        {
+          motors[motor].move(value);
+        }
+      }
+      const MotorReading& reading = devices.motors[motor];
+      if(reading.valid)
+      {
+        energyAdd(motorEnergy, (ArbiterMotor)motor, ran, reading.watts, dt); // get_power covers the last tick, so it's split by who was commanding it then
+        blackBoxMotor(motor, motorArbiter.outputs[motor].value, reading.rpm, reading.milliamps, reading.watts, reading.faults);
+      }
+    }
+
+    c::task_delay_until(&wakeTime, 10);
+    blackBoxDeadline(BLACKBOX_MOTORS, wakeTime, 10);
+  }
+}
@@ -0,0 +1,225 @@
+#include "DriverObstacles.hpp"
+#include "Util/FastMath.hpp"
+#include <cmath>
+
+void opponentUpdate(OpponentTrack* tracks, const RobotPose& pose, const pros::c::vision_object_s_t* detections, int count, uint32_t now)
+// Each detection goes to the nearest live track inside the gate, or starts a new one over the stalest.
+// Call it every frame, even with nothing seen, so tracks that should be in view but aren't get dropped
+{
+  for(int d = 0; d < count; d++)
+  {
+    float x, y;
+    if(detections[d].signature == VISION_OBJECT_ERR_SIG
+      || !imageToField(cameraModel, pose, detections[d].x_middle_coord, detections[d].width, &x, &y, OPPONENT_PLATE_WIDTH))
+    {
+      continue;
+    }
+
+    int nearest = -1;
+    float nearestDistance = OPPONENT_GATE;
+    float nearestX = 0, nearestY = 0; // Where the nearest track was predicted to be
+    int stalest = 0;
+    for(int t = 0; t < OPPONENT_TRACKS; t++)
+    {
+      OpponentTrack& track = tracks[t];
+      float px, py;
+      if(!opponentPredict(track, now, &px, &py))
+      {
+        track.valid = false; // Gone stale
+      }
+      else if(track.lastSeen != now) // Not already given a detection this frame
+      {
+        float distance = sqrtf((x - px) * (x - px) + (y - py) * (y - py));
+        if(distance < nearestDistance)
+        {
+          nearest = t;
+          nearestDistance = distance;
+          nearestX = px;
+          nearestY = py;
+        }
+      }
+      if(tracks[stalest].valid && (!track.valid || track.lastSeen < tracks[stalest].lastSeen))
+      {
+        stalest = t;
+      }
+    }
+
+    if(nearest >= 0)
+    {
+      OpponentTrack& track = tracks[nearest];
+      float dt = (now - track.lastSeen) / 1000.0;
+      float newX = nearestX + (x - nearestX) * OPPONENT_POSITION_BLEND;
+      float newY = nearestY + (y - nearestY) * OPPONENT_POSITION_BLEND;
+      if(dt > 0)
+      {
+        track.velocityX += ((newX - track.x) / dt - track.velocityX) * OPPONENT_VELOCITY_BLEND;
+        track.velocityY += ((newY - track.y) / dt - track.velocityY) * OPPONENT_VELOCITY_BLEND;
+      }
+      track.x = newX;
+      track.y = newY;
+      track.lastSeen = now;
+    }
+    else
+    {
+      tracks[stalest] = {true, x, y, 0, 0, now}; // Assumed still until it's been seen move
+    }
+  }
+
+  for(int t = 0; t < OPPONENT_TRACKS; t++) // Anything the camera is looking right at but can't see has gone
+  {
+    float px, py, imageX, imageY, width;
+    if(tracks[t].valid && now - tracks[t].lastSeen > OPPONENT_MISSING_TIME && opponentPredict(tracks[t], now, &px, &py)
+      && fieldToImage(cameraModel, pose, px, py, &imageX, &imageY, &width, OPPONENT_PLATE_WIDTH, OPPONENT_PLATE_HEIGHT)
+      && imageX >= 0 && imageX < VISION_FOV_WIDTH)
+    {
+      tracks[t].valid = false;
+    }
+  }
+}
+
+bool opponentPredict(const OpponentTrack& track, uint32_t now, float* x, float* y) // Where it should be by now
+{
+  if(!track.valid || now - track.lastSeen > OPPONENT_COAST_TIME)
+  {
+    return false;
+  }
+  uint32_t coast = now - track.lastSeen;
+  float dt = (coast < OPPONENT_COAST_MOTION ? coast : OPPONENT_COAST_MOTION) / 1000.0;
+  *x = track.x + track.velocityX * dt;
+  *y = track.y + track.velocityY * dt;
+  return true;
+}
+
+
+static float avoidCollisionTime(float relativeX, float relativeY, float velocityX, float velocityY, float radius)
+// Seconds until something relativeX/Y away, closing at velocityX/Y, comes within radius. Huge if never
+{
+  float c = relativeX * relativeX + relativeY * relativeY - radius * radius;
+  float b = relativeX * velocityX + relativeY * velocityY; // Positive when closing
+  if(c <= 0)
+  {
+    return b > 0 ? 0 : 1e9; // Already touching, only backing off is safe
+  }
+  float a = velocityX * velocityX + velocityY * velocityY;
+  float discriminant = b * b - a * c;
+  if(b <= 0 || discriminant < 0)
+  {
+    return 1e9; // Moving apart, or passing clear
+  }
+  return (b - sqrtf(discriminant)) / a;
+}
+
+bool avoidFilter(const OpponentTrack* tracks, const RobotPose& pose, uint32_t now, float* left, float* right, float* strafe)
+// Takes the base powers about to go out, and if they'd hit an opponent swaps them for the nearest ones that don't.
+// Only forward and strafe get changed, turning doesn't move us anywhere. Returns true if it changed anything.
+// Tries a small grid of slower and sideways commands, and going round either edge of each opponent, which is
+// plenty at 10ms and costs well under a millisecond
+{
+  float opponentX[OPPONENT_TRACKS], opponentY[OPPONENT_TRACKS];
+  bool any = false;
+  bool live[OPPONENT_TRACKS];
+  for(int t = 0; t < OPPONENT_TRACKS; t++)
+  {
+    live[t] = opponentPredict(tracks[t], now, &opponentX[t], &opponentY[t]);
+    any = any || live[t];
+  }
+  if(!any)
+  {
+    return false;
+  }
+
+  float forward = (*left + *right) / 2;
+  float turn = (*left - *right) / 2;
+  float headingSin = fastSin(pose.heading);
+  float headingCos = fastCos(pose.heading);
+  const float radius = ROBOT_RADIUS + OPPONENT_RADIUS + AVOID_MARGIN;
+  const float speedPerPower = BASE_MAX_SPEED / 127;
+
+  auto collisionTime = [&](float forwardPower, float strafePower)
+  {
+    // Field velocity of ours, positive strafe is to the right like odometryStep
+    float velocityX = (forwardPower * headingCos + strafePower * headingSin) * speedPerPower;
+    float velocityY = (forwardPower * headingSin - strafePower * headingCos) * speedPerPower;
+    float soonest = 1e9;
+    for(int t = 0; t < OPPONENT_TRACKS; t++)
+    {
+      if(live[t])
+      {
+        float time = avoidCollisionTime(opponentX[t] - pose.x, opponentY[t] - pose.y,
+          velocityX - tracks[t].velocityX, velocityY - tracks[t].velocityY, radius);
+        soonest = time < soonest ? time : soonest;
+      }
+    }
+    return soonest;
+  };
+
+  if(collisionTime(forward, *strafe) > AVOID_HORIZON)
+  {
+    return false; // Fine as it is
+  }
+
+  // Slowing is counted on the speed, so swinging the same speed round the obstacle is cheaper than stopping for it.
+  // Stopping is always safe from one that's parked, and when slowing was counted on forward alone it won every time
+  const float speed = sqrtf(forward * forward + *strafe * *strafe);
+  float bestForward = 0, bestStrafe = *strafe;
+  float bestCost = 1e30;
+  float bestTime = -1; // If nothing is safe, put off the hit as long as possible
+  auto consider = [&](float tryForward, float tryStrafe)
+  {
+    tryForward = tryForward > 127 ? 127 : (tryForward < -127 ? -127 : tryForward);
+    tryStrafe = tryStrafe > 127 ? 127 : (tryStrafe < -127 ? -127 : tryStrafe);
+    float time = collisionTime(tryForward, tryStrafe);
+    float slowing = speed - sqrtf(tryForward * tryForward + tryStrafe * tryStrafe);
+    slowing = slowing > 0 ? slowing : 0;
+    float cost = AVOID_SLOWING_COST * slowing * slowing
+      + (tryForward - forward) * (tryForward - forward) + (tryStrafe - *strafe) * (tryStrafe - *strafe);
+    bool safe = time > AVOID_HORIZON;
+    bool better = safe ? (bestTime <= AVOID_HORIZON || cost < bestCost) : (bestTime <= AVOID_HORIZON && time > bestTime);
+    if(better)
+    {
+      bestForward = tryForward;
+      bestStrafe = tryStrafe;
+      bestCost = cost;
+      bestTime = time;
+    }
+  };
+
+  const float forwardScales[] = {1, 0.75, 0.5, 0.25, 0, -0.25, -0.5};
+  const float strafeSteps[] = {0, -40, 40, -80, 80, -127, 127};
+  for(float scale : forwardScales)
+  {
+    for(float step : strafeSteps)
+    {
+      consider(forward * scale, *strafe + step);
+    }
+  }
+
+  // The grid only ever slides sideways at the speed we were already going forward, which with something parked
+  // right in front is never enough. So also try going the same speed along either edge of each obstacle,
+  // AVOID_EDGE_MARGIN outside it. Inside the margin already, the edges are straight out to the side
+  for(int t = 0; t < OPPONENT_TRACKS && speed > 1; t++)
+  {
+    if(!live[t])
+    {
+      continue;
+    }
+    float relativeX = opponentX[t] - pose.x;
+    float relativeY = opponentY[t] - pose.y;
+    float distance = sqrtf(relativeX * relativeX + relativeY * relativeY);
+    float halfWidth = (distance > radius ? asinf(radius / distance) : M_PI / 2) + AVOID_EDGE_MARGIN;
+    float bearing = fastAtan2(relativeY, relativeX);
+    for(int side = -1; side <= 1; side += 2)
+    {
+      // Our velocity is theirs plus this one, so relative to them it runs down the edge
+      float direction = bearing + side * halfWidth;
+      float velocityX = tracks[t].velocityX / speedPerPower + speed * fastCos(direction);
+      float velocityY = tracks[t].velocityY / speedPerPower + speed * fastSin(direction);
+      consider(velocityX * headingCos + velocityY * headingSin, velocityX * headingSin - velocityY * headingCos);
+    }
+  }
+
+  *left = bestForward + turn;
+  *right = bestForward - turn;
+  *strafe = bestStrafe;
+  return true;
+}
@@ -0,0 +1,57 @@
+#include "main.hpp"
+#include "DriverOdometry.hpp"
+#include "DriverBlackBox.hpp"
+#include "DriverDevices.hpp"
+
+#define ODOMETRY_TRAVEL_PER_DEGREE (BASE_WHEEL_DIAMETER * M_PI / 360) // Inches the wheel rolls per degree of motor output
+
+RobotPose odometryCurrentPose = {0, 0, 0};
+bool odometryResetPending;
+RobotPose odometryResetPose;
+
+RobotPose odometryPose() // Where the robot thinks it is, starting from wherever it was when the task started
+{
+  return odometryCurrentPose;
+}
+
+void odometryReset(RobotPose pose) // Picked up by the task on its next loop so it never fights an update in progress
+{
+  odometryResetPose = pose;
+  odometryResetPending = true;
+}
+
+
+void odometryTask(void*)
+{
+  DeviceSnapshot last = deviceSnapshot(); // The wheel positions, read by motorTask
+
+  uint32_t wakeTime = millis();
+  while(true)
+  {
+    DeviceSnapshot devices = deviceSnapshot();
+    const MotorReading* wheels = devices.motors;
+    bool valid = wheels[MOTOR_BASE_LEFT].valid && wheels[MOTOR_BASE_RIGHT].valid && wheels[MOTOR_BASE_H].valid;
+
+    if(odometryResetPending)
+    {
+      odometryCurrentPose = odometryResetPose;
+      odometryResetPending = false;
+    }
+    else if(valid && last.time != 0)
+    {
+      RobotPose pose = odometryCurrentPose;
+      odometryStep(pose, (wheels[MOTOR_BASE_LEFT].position - last.motors[MOTOR_BASE_LEFT].position) * ODOMETRY_TRAVEL_PER_DEGREE,
+        (wheels[MOTOR_BASE_RIGHT].position - last.motors[MOTOR_BASE_RIGHT].position) * ODOMETRY_TRAVEL_PER_DEGREE,
+        (wheels[MOTOR_BASE_H].position - last.motors[MOTOR_BASE_H].position) * ODOMETRY_TRAVEL_PER_DEGREE);
+      odometryCurrentPose = pose;
+    }
+
+    if(valid)
+    {
+      last = devices;
+    }
+
+    c::task_delay_until(&wakeTime, 10);
+    blackBoxDeadline(BLACKBOX_ODOMETRY, wakeTime, 10);
+  }
+}
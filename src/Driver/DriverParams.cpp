@@ -0,0 +1,76 @@
+#include "DriverParams.hpp"
+#include <cstdio>
+#include <cstring>
+
+static const TunableParam paramTable[] =
+{
+  {"turnP", &ControlGains::turnP, 0.05, 2.0},
+  {"forwardP", &ControlGains::forwardP, 0.5, 10.0},
+  {"armP", &ControlGains::armP, 0.1, 5.0},
+  {"forwardDFilter", &ControlGains::forwardDFilter, 0.02, 0.5},
+  {"targetCoastTime", &ControlGains::targetCoastTime, 100, 3000},
+  {"targetBlend", &ControlGains::targetBlend, 0.1, 1.0},
+  {"rangeGate", &ControlGains::rangeGate, 1.5, 8.0},
+  {"contactBrakeTime", &ControlGains::contactBrakeTime, 0.05, 1.0},
+};
+
+#define PARAM_COUNT (int)(sizeof(paramTable) / sizeof(paramTable[0]))
+
+int paramCount()
+{
+  return PARAM_COUNT;
+}
+
+const TunableParam& paramAt(int index)
+{
+  return paramTable[index];
+}
+
+const TunableParam* paramFind(const char* name)
+{
+  for(int i = 0; i < PARAM_COUNT; i++)
+  {
+    if(strcmp(paramTable[i].name, name) == 0)
+    {
+      return &paramTable[i];
+    }
+  }
+  return NULL;
+}
+
+int paramsFormat(const ControlGains& gains, char* text, int size) // Returns the length, like snprintf
+{
+  int length = 0;
+  for(int i = 0; i < PARAM_COUNT; i++)
+  {
+    length += snprintf(text + length, length < size ? size - length : 0, "%s %g\n", paramTable[i].name, gains.*paramTable[i].field);
+  }
+  return length;
+}
+
+int paramsParse(ControlGains& gains, const char* text) // Returns how many were set. Unknown names are skipped, so old files still load
+{
+  int set = 0;
+  while(*text != 0)
+  {
+    char name[32];
+    float value;
+    int used = 0;
+    if(sscanf(text, " %31s %f%n", name, &value, &used) == 2)
+    {
+      const TunableParam* param = paramFind(name);
+      if(param != NULL)
+      {
+        gains.*param->field = value < param->min ? param->min : (value > param->max ? param->max : value);
+        set++;
+      }
+    }
+    const char* next = strchr(text + used, '\n'); // On to the next line, whatever was on this one
+    if(next == NULL)
+    {
+      break;
+    }
+    text = next + 1;
+  }
+  return set;
+}
@@ -0,0 +1,73 @@
+#include "DriverPickup.hpp"
+#include "DriverControlLaws.hpp"
+#include <algorithm>
+#include <cmath>
+
+#define PICKUP_ANGLE_BLEND 0.1 // How far each frame pulls the grab angle, a pixel of y is a lot of height from far out
+
+void pickupReset(PickupPlan& plan)
+{
+  plan.moving = false;
+  plan.grabAngle = pickupArmAngle(BALL_DIAMETER / 2);
+  plan.timeToContact = 0;
+}
+
+float pickupBallHeight(const CameraModel& camera, float imageY, float width) // Inches off the floor of the ball's middle
+{
+  float depth = BALL_DIAMETER * camera.focalLength / width;
+  float below = atanf((imageY - camera.centerY) / camera.focalLength) + camera.mountPitch; // Down from level
+  return camera.mountHeight - depth * tanf(below);
+}
+
+float pickupArmAngle(float height) // Radians up from the bottom stop that put the claw at height
+{
+  float sine = std::clamp((height - (float)ARM_PIVOT_HEIGHT) / (float)ARM_LENGTH, -1.0f, 1.0f);
+  return std::max(0.0f, asinf(sine) - (float)ARM_DOWN_ELEVATION);
+}
+
+bool pickupArrived(float width) // The base is close enough to grab the ball
+{
+  return width >= BASE_DISTANCE_WIDTH - PICKUP_ARRIVED;
+}
+
+float pickupTravelTime(float from, float to, float armP)
+// Seconds for armPower to get the arm from one angle to within PICKUP_ARM_CLOSE of another. Flat out while the
+// P is past full power, then it closes in exponentially, which is where most of the time goes
+{
+  float perRadian = armP * 180 / M_PI; // armPower works in degrees
+  float flatOut = 127 / perRadian; // Further off than this and armPower is maxed out
+  float distance = fabsf(to - from);
+  float time = PICKUP_ARM_DELAY;
+  if(distance > flatOut)
+  {
+    time += (distance - flatOut) / PICKUP_ARM_TOP_SPEED;
+    distance = flatOut;
+  }
+  if(distance > PICKUP_ARM_CLOSE)
+  {
+    time += 127 / (perRadian * PICKUP_ARM_TOP_SPEED) * logf(distance / PICKUP_ARM_CLOSE);
+  }
+  return time;
+}
+
+bool pickupUpdate(PickupPlan& plan, const CameraModel& camera, const ContactEstimate& contact, uint32_t now, float width,
+  float yMiddle, float armAngle, float armP)
+// Once per control loop with the ball in view. Returns true once the arm should be heading for plan.grabAngle.
+// armP is what armPower will drive it with, controlGains.armP unless the tuner is trying something
+{
+  if(width <= 0)
+  {
+    return plan.moving;
+  }
+  bool valid = contactValid(contact, now);
+  plan.timeToContact = valid ? contactTimeTo(contact, width, BASE_DISTANCE_WIDTH) : 0;
+
+  // The ball doesn't get any higher or lower as we drive up to it, so its height now is its height then
+  float grabAngle = pickupArmAngle(pickupBallHeight(camera, yMiddle, width));
+  plan.grabAngle += (grabAngle - plan.grabAngle) * PICKUP_ANGLE_BLEND;
+
+  bool due = (valid && plan.timeToContact <= pickupTravelTime(armAngle, plan.grabAngle, armP) + PICKUP_MARGIN)
+    || pickupArrived(width); // Without a rate, go once we're there, like before
+  plan.moving = plan.moving || due;
+  return plan.moving;
+}
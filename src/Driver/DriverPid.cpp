@@ -0,0 +1,23 @@
+#include "DriverPid.hpp"
+
+void pidSetTarget(PidController& pid, float target)
+{
+  pid.target = target;
+}
+
+void pidReset(PidController& pid) // Keeps the gains and target
+{
+  pid.integral = 0;
+  pid.derivative = 0;
+  pid.started = false;
+  pid.error = 0;
+  pid.output = 0;
+}
+
+float pidStep(PidController& pid, float reading, float dt)
+{
+  pid.error = pid.target - reading;
+  pid.output = pidUpdate(pid.gains, pid.target, reading, dt, pid.started, pid.integral, pid.derivative, pid.lastReading);
+  pid.started = true;
+  return pid.output;
+}
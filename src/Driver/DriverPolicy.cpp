@@ -0,0 +1,36 @@
+#include "DriverPolicy.hpp"
+#include "DriverControlLaws.hpp"
+#include "DriverPickup.hpp"
+#include <algorithm>
+#include <cmath>
+
+void policyFeatures(const CameraModel& camera, bool visible, float xMiddle, float yMiddle, float width, float timeToContact,
+  float armAngle, float* features)
+// timeToContact from contactTimeTo on BASE_DISTANCE_WIDTH, armAngle in radians up from the bottom stop
+{
+  features[0] = visible;
+  features[4] = armAngle / (M_PI / 2);
+  if(!visible || width <= 0)
+  {
+    features[1] = features[2] = features[3] = features[5] = 0;
+    return;
+  }
+  features[1] = (xMiddle - visionAimX) / (VISION_FOV_WIDTH / 2);
+  features[2] = (width - BASE_DISTANCE_WIDTH) / BASE_DISTANCE_WIDTH;
+  features[3] = std::min(timeToContact, (float)POLICY_TIME_CLIP) / POLICY_TIME_CLIP;
+  features[5] = (pickupArmAngle(pickupBallHeight(camera, yMiddle, width)) - armAngle) / (M_PI / 2); // How far the arm has to go to grab it
+}
+
+PolicyCommand policyRun(const MlpModel& model, const float* features) // All zero if there's no model
+{
+  float outputs[MLP_MAX_WIDTH] = {};
+  if(model.layerCount > 0 && model.inputs == POLICY_INPUTS && mlpOutputs(model) == POLICY_OUTPUTS)
+  {
+    mlpRun(model, features, outputs);
+  }
+  PolicyCommand command;
+  command.turn = std::clamp(outputs[0] * 127, -127.0f, 127.0f);
+  command.forward = std::clamp(outputs[1] * 127, -127.0f, 127.0f);
+  command.arm = std::clamp(outputs[2] * 127, -127.0f, 127.0f);
+  return command;
+}
@@ -0,0 +1,87 @@
+#include "DriverRange.hpp"
+#include "Util/FastMath.hpp"
+#include <cmath>
+
+static bool rangeFuse(RangeEstimate& estimate, float depth, float variance, uint32_t now, float gate) // One Kalman update. False if gated out
+{
+  float innovation = depth - estimate.depth;
+  float total = estimate.variance + variance;
+  if(innovation * innovation > gate * gate * total)
+  {
+    return false;
+  }
+
+  float gain = estimate.variance / total;
+  estimate.depth += gain * innovation;
+  estimate.variance *= 1 - gain;
+  estimate.lastUpdate = now;
+  return true;
+}
+
+
+void rangePredict(RangeEstimate& estimate, float forwardTravel, float dt) // Driving forward closes the distance
+{
+  estimate.depth -= forwardTravel;
+  estimate.variance += RANGE_PROCESS_NOISE * dt;
+}
+
+
+bool rangeVisionUpdate(RangeEstimate& estimate, const CameraModel& camera, const pros::c::vision_object_s_t& ball, uint32_t now,
+  const ControlGains& gains)
+{
+  if(ball.signature == VISION_OBJECT_ERR_SIG)
+  {
+    return false;
+  }
+
+  // Something in front of the ball, or the edge of the image, only ever makes it look smaller,
+  // and usually only in one direction. So the bigger of the two is the better size
+  float size = ball.width > ball.height ? ball.width : ball.height;
+  bool clippedX = ball.left_coord <= 0 || ball.left_coord + ball.width >= VISION_FOV_WIDTH;
+  bool clippedY = ball.top_coord <= 0 || ball.top_coord + ball.height >= VISION_FOV_HEIGHT;
+  if(size <= 0 || (clippedX && clippedY))
+  {
+    return false; // In a corner, so cut off both ways and neither is the real size
+  }
+
+  float depth = BALL_DIAMETER * camera.focalLength / size;
+  float noise = depth * depth / (BALL_DIAMETER * camera.focalLength) * VISION_SIZE_NOISE;
+
+  if(!rangeValid(estimate, now) || estimate.visionRejects >= RANGE_VISION_RESET)
+  {
+    // Nothing to go on, or vision has disagreed long enough that it's probably a different ball
+    estimate.valid = true;
+    estimate.depth = depth;
+    estimate.variance = noise * noise;
+    estimate.lastUpdate = now;
+    estimate.visionRejects = 0;
+    return true;
+  }
+
+  bool used = rangeFuse(estimate, depth, noise * noise, now, gains.rangeGate);
+  estimate.visionRejects = used ? 0 : estimate.visionRejects + 1;
+  return used;
+}
+
+
+bool rangeUltrasonicUpdate(RangeEstimate& estimate, const CameraModel& camera, float ultrasonic, float imageX, uint32_t now,
+  const ControlGains& gains)
+// ultrasonic is the reading in inches (0 is nothing heard), imageX where vision has the ball
+{
+  float bearing = fastAtan2(imageX - camera.centerX, camera.focalLength);
+  if(!rangeValid(estimate, now) || ultrasonic <= 0 || ultrasonic > ULTRASONIC_MAX_RANGE || fabs(bearing) > ULTRASONIC_BEAM)
+  {
+    return false; // Only ever corrects a ball vision has found, since it can't tell a ball from a wall
+  }
+
+  // The echo comes off the near side of the ball
+  float depth = ultrasonic + BALL_DIAMETER / 2 + ULTRASONIC_MOUNT_FORWARD - camera.mountForward;
+  float noise = ULTRASONIC_NOISE + ULTRASONIC_NOISE_SCALE * ultrasonic;
+  return rangeFuse(estimate, depth, noise * noise, now, gains.rangeGate);
+}
+
+
+bool rangeValid(const RangeEstimate& estimate, uint32_t now)
+{
+  return estimate.valid && now - estimate.lastUpdate <= RANGE_TIMEOUT;
+}
@@ -0,0 +1,235 @@
+#include "main.hpp"
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include "display/lv_misc/lv_ufs.h"
+#include "DriverStorage.hpp"
+
+// SD card writes can block for tens of ms, which is a lot of missed control loops. So everything written
+// during a match goes into LVGL's RAM filesystem instead, and storageFlush copies it out to the SD card
+// when nothing is moving (disabled, between autonomous and driver control)
+
+struct StorageChunk
+{
+  char name[16];
+  uint32_t used; // The ufs file is STORAGE_CHUNK long from the start, this is how much of it is real
+};
+
+struct StorageFile
+{
+  char name[32];
+  bool dirty;
+};
+
+static pros::Mutex storageMutex; // The ufs isn't safe to touch from two tasks at once
+static StorageChunk logChunks[STORAGE_LOG_CHUNKS]; // Ring, oldest first from logFirst
+static int logFirst = 0;
+static int logCount = 0;
+static uint32_t logNumber = 0; // Keeps chunk names unique
+static uint32_t logDropped = 0; // Bytes overwritten before they reached the SD card
+static StorageFile files[STORAGE_FILES];
+
+static bool storageNewChunk() // Caller holds the mutex
+{
+  if(logCount == STORAGE_LOG_CHUNKS) // Full, the newest data wins
+  {
+    logDropped += logChunks[logFirst].used;
+    lv_ufs_remove(logChunks[logFirst].name);
+    logFirst = (logFirst + 1) % STORAGE_LOG_CHUNKS;
+    logCount--;
+  }
+
+  StorageChunk& chunk = logChunks[(logFirst + logCount) % STORAGE_LOG_CHUNKS];
+  snprintf(chunk.name, sizeof(chunk.name), "log%lu", (unsigned long)logNumber++);
+  chunk.used = 0;
+
+  lv_ufs_file_t file;
+  if(lv_ufs_open(&file, chunk.name, LV_FS_MODE_WR) != LV_FS_RES_OK)
+  {
+    return false;
+  }
+  lv_fs_res_t grown = lv_ufs_seek(&file, STORAGE_CHUNK); // Seeking past the end grows it, one alloc per chunk
+  lv_ufs_close(&file);
+  if(grown != LV_FS_RES_OK)
+  {
+    lv_ufs_remove(chunk.name);
+    return false;
+  }
+  logCount++;
+  return true;
+}
+
+void storageLog(const char* format, ...) // printf into the log, a millisecond timestamp goes in front
+{
+  char line[160];
+  int length = snprintf(line, sizeof(line), "%lu ", (unsigned long)millis());
+  va_list args;
+  va_start(args, format);
+  length += vsnprintf(line + length, sizeof(line) - length, format, args);
+  va_end(args);
+  if(length >= (int)sizeof(line))
+  {
+    length = sizeof(line) - 1; // Cut short
+  }
+
+  if(!lv_ufs_ready() || !storageMutex.take(10))
+  {
+    logDropped += length;
+    return;
+  }
+  if(logCount == 0 || logChunks[(logFirst + logCount - 1) % STORAGE_LOG_CHUNKS].used + length > STORAGE_CHUNK)
+  {
+    if(!storageNewChunk())
+    {
+      logDropped += length;
+      storageMutex.give();
+      return;
+    }
+  }
+
+  StorageChunk& chunk = logChunks[(logFirst + logCount - 1) % STORAGE_LOG_CHUNKS];
+  lv_ufs_file_t file;
+  if(lv_ufs_open(&file, chunk.name, LV_FS_MODE_WR) == LV_FS_RES_OK)
+  {
+    uint32_t written = 0;
+    lv_ufs_seek(&file, chunk.used);
+    lv_ufs_write(&file, line, length, &written);
+    lv_ufs_close(&file);
+    chunk.used += written;
+  }
+  storageMutex.give();
+}
+
+bool storageWriteFile(const char* name, const void* data, uint32_t size)
+// Replaces the whole file, for settings and calibrations. It lands at /usd/<name> on the next flush
+{
+  if(!lv_ufs_ready() || strlen(name) >= sizeof(files[0].name) || !storageMutex.take(10))
+  {
+    return false;
+  }
+
+  int slot = -1;
+  for(int i = 0; i < STORAGE_FILES && slot < 0; i++)
+  {
+    if(strcmp(files[i].name, name) == 0)
+    {
+      slot = i;
+    }
+  }
+  for(int i = 0; i < STORAGE_FILES && slot < 0; i++)
+  {
+    if(files[i].name[0] == 0)
+    {
+      slot = i;
+    }
+  }
+
+  bool ok = false;
+  lv_ufs_file_t file;
+  if(slot >= 0 && lv_ufs_open(&file, name, LV_FS_MODE_WR) == LV_FS_RES_OK)
+  {
+    uint32_t written = 0;
+    lv_ufs_write(&file, data, size, &written);
+    lv_ufs_trunc(&file); // In case the old one was longer
+    lv_ufs_close(&file);
+    ok = written == size;
+    strcpy(files[slot].name, name);
+    files[slot].dirty = true;
+  }
+  storageMutex.give();
+  return ok;
+}
+
+static int storageCopy(const char* name, const char* path, const char* mode, uint32_t length) // Caller holds the mutex
+{
+  lv_ufs_file_t source;
+  if(lv_ufs_open(&source, name, LV_FS_MODE_RD) != LV_FS_RES_OK)
+  {
+    return -1;
+  }
+  FILE* destination = fopen(path, mode);
+  if(destination == NULL)
+  {
+    lv_ufs_close(&source);
+    return -1;
+  }
+
+  int copied = 0;
+  char buffer[256];
+  while(copied < (int)length)
+  {
+    uint32_t wanted = length - copied < sizeof(buffer) ? length - copied : sizeof(buffer);
+    uint32_t read = 0;
+    lv_ufs_read(&source, buffer, wanted, &read);
+    if(read == 0)
+    {
+      break;
+    }
+    fwrite(buffer, 1, read, destination);
+    copied += read;
+  }
+  fclose(destination);
+  lv_ufs_close(&source);
+  return copied;
+}
+
+int storageFlush() // Only call this when the robot is idle. Returns bytes that made it to the SD card, -1 if there's no card
+{
+  if(!lv_ufs_ready() || !storageMutex.take(TIMEOUT_MAX))
+  {
+    return -1;
+  }
+
+  int total = 0;
+  bool failed = false;
+  for(int i = 0; i < STORAGE_FILES && !failed; i++)
+  {
+    if(!files[i].dirty)
+    {
+      continue;
+    }
+    uint32_t size = 0;
+    lv_ufs_file_t file;
+    if(lv_ufs_open(&file, files[i].name, LV_FS_MODE_RD) == LV_FS_RES_OK)
+    {
+      lv_ufs_size(&file, &size);
+      lv_ufs_close(&file);
+    }
+    char path[40];
+    snprintf(path, sizeof(path), "/usd/%s", files[i].name);
+    int copied = storageCopy(files[i].name, path, "w", size);
+    failed = copied < 0;
+    if(!failed)
+    {
+      files[i].dirty = false; // Kept in RAM, it's small and might get rewritten
+      total += copied;
+    }
+  }
+
+  while(logCount > 0 && !failed)
+  {
+    StorageChunk& chunk = logChunks[logFirst];
+    int copied = storageCopy(chunk.name, STORAGE_LOG_FILE, "a", chunk.used);
+    failed = copied < 0;
+    if(!failed)
+    {
+      total += copied;
+      if(logCount == 1)
+      {
+        chunk.used = 0; // Reuse the one being written into rather than freeing it
+        break;
+      }
+      lv_ufs_remove(chunk.name);
+      logFirst = (logFirst + 1) % STORAGE_LOG_CHUNKS;
+      logCount--;
+    }
+  }
+
+  storageMutex.give();
+  return failed && total == 0 ? -1 : total;
+}
+
+uint32_t storageLogDropped()
+{
+  return logDropped;
+}
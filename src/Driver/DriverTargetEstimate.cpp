@@ -0,0 +1,94 @@
+#include "DriverTargetEstimate.hpp"
+#include <algorithm>
+#include <cmath>
+
+void targetEstimateUpdate(TargetEstimate& estimate, const RobotPose& pose, const pros::c::vision_object_s_t& detection, uint32_t now,
+  const ControlGains& gains)
+{
+  float fieldX;
+  float fieldY;
+
+  if(detection.signature == VISION_OBJECT_ERR_SIG || !imageToField(cameraModel, pose, detection.x_middle_coord, detection.width, &fieldX, &fieldY))
+  {
+    estimate.seenRate -= estimate.seenRate * TARGET_QUALITY_BLEND; // Nothing seen, keep the old estimate so it can be predicted through the dropout
+    return;
+  }
+
+  bool sameBall = estimate.valid && now - estimate.lastSeen <= gains.targetCoastTime
+    && sqrtf((fieldX - estimate.fieldX) * (fieldX - estimate.fieldX) + (fieldY - estimate.fieldY) * (fieldY - estimate.fieldY)) < TARGET_GATE;
+
+  // Measured in the image rather than on the field, where a pixel of width is inches of depth for a far ball
+  float expectedX, expectedY, expectedWidth;
+  if(sameBall && fieldToImage(cameraModel, pose, estimate.fieldX, estimate.fieldY, &expectedX, &expectedY, &expectedWidth))
+  {
+    estimate.innovation += (fabsf(detection.x_middle_coord - expectedX) - estimate.innovation) * TARGET_QUALITY_BLEND;
+  }
+
+  if(sameBall)
+  {
+    estimate.fieldX += (fieldX - estimate.fieldX) * gains.targetBlend;
+    estimate.fieldY += (fieldY - estimate.fieldY) * gains.targetBlend;
+    estimate.hits = estimate.hits < TARGET_STREAK_FULL ? estimate.hits + 1 : TARGET_STREAK_FULL;
+    estimate.seenRate += (1 - estimate.seenRate) * TARGET_QUALITY_BLEND;
+    estimate.widthChange += (fabsf(detection.width - estimate.lastWidth) - estimate.widthChange) * TARGET_QUALITY_BLEND;
+  }
+  else
+  {
+    estimate.fieldX = fieldX;
+    estimate.fieldY = fieldY;
+    estimate.hits = 1; // A new ball, which only the streak has anything to say about yet
+    estimate.seenRate = 1;
+    estimate.innovation = 0;
+    estimate.widthChange = 0;
+  }
+  estimate.lastWidth = detection.width;
+
+  estimate.valid = true;
+  estimate.lastSeen = now;
+  estimate.signature = detection.signature;
+}
+
+
+float targetConfidence(const TargetEstimate& estimate, uint32_t now)
+// 1 for a ball seen every frame for a while, landing where it was expected at a steady size. A new ball, one
+// that flickers, jumps about, or changes size from frame to frame, or one that's gone, gets less. It's only as
+// good as the worst of them, multiplying them together would mark a good lock down for being a bit short on each
+{
+  if(!estimate.valid)
+  {
+    return 0;
+  }
+  float streak = (float)estimate.hits / TARGET_STREAK_FULL;
+  float innovation = estimate.innovation / TARGET_INNOVATION_SCALE;
+  float widthChange = estimate.widthChange / TARGET_WIDTH_SCALE;
+  int32_t unseen = (int32_t)(now - estimate.lastSeen) - TARGET_CONFIDENCE_GRACE;
+  float coast = unseen > 0 ? fmaxf(0, 1 - (float)unseen / TARGET_CONFIDENCE_FADE) : 1;
+  return std::min({streak, estimate.seenRate, coast, 1 / (1 + innovation * innovation), 1 / (1 + widthChange * widthChange)});
+}
+
+
+bool targetEstimatePredict(const TargetEstimate& estimate, const RobotPose& pose, uint32_t now, pros::c::vision_object_s_t* predicted,
+  const ControlGains& gains)
+// Fills in where the ball would show up in the image from where the robot is now
+{
+  float imageX;
+  float imageY;
+  float width;
+
+  if(!estimate.valid || now - estimate.lastSeen > gains.targetCoastTime
+    || !fieldToImage(cameraModel, pose, estimate.fieldX, estimate.fieldY, &imageX, &imageY, &width))
+  {
+    return false;
+  }
+
+  // The image position can land outside the FOV while we're turned away, which is fine, the controllers will turn back to it
+  predicted->signature = estimate.signature;
+  predicted->x_middle_coord = lround(imageX);
+  predicted->y_middle_coord = lround(imageY);
+  predicted->width = lround(width);
+  predicted->height = lround(width);
+  predicted->left_coord = predicted->x_middle_coord - predicted->width / 2;
+  predicted->top_coord = predicted->y_middle_coord - predicted->height / 2;
+  predicted->angle = 0;
+  return true;
+}
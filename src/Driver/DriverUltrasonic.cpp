@@ -0,0 +1,55 @@
+#include "main.hpp"
+#include "DriverUltrasonic.hpp"
+#include "DriverVisionTracking.hpp"
+#include "DriverOdometry.hpp"
+#include "Util/FastMath.hpp"
+
+#define CM_PER_INCH 2.54
+
+RangeEstimate ballRange;
+
+bool ballDepthValid()
+{
+  return rangeValid(ballRange, millis());
+}
+
+float ballDepth() // Inches straight out from the camera to the middle of the ball
+{
+  return ballRange.depth;
+}
+
+
+void rangeTask(void*)
+{
+  pros::ADIUltrasonic ultrasonic(ULTRASONIC_ECHO_PORT, ULTRASONIC_PING_PORT);
+
+  RobotPose lastPose = odometryPose();
+  uint32_t lastFrame = 0;
+  uint32_t wakeTime = millis();
+  while(true)
+  {
+    uint32_t now = millis();
+
+    // Whatever odometry says we drove towards the ball since last time
+    RobotPose pose = odometryPose();
+    float travel = (pose.x - lastPose.x) * fastCos(pose.heading) + (pose.y - lastPose.y) * fastSin(pose.heading);
+    lastPose = pose;
+    rangePredict(ballRange, travel, 0.01);
+
+    uint32_t frameTime = visionFrameTime();
+    if(frameTime != lastFrame) // Only a new frame is a new reading
+    {
+      rangeVisionUpdate(ballRange, cameraModel, calculateVision(), now, controlGains);
+      lastFrame = frameTime;
+    }
+
+    c::vision_object_s_t target = calculateTarget();
+    int32_t reading = ultrasonic.get_value();
+    if(target.signature != 255 && reading != PROS_ERR)
+    {
+      rangeUltrasonicUpdate(ballRange, cameraModel, reading / CM_PER_INCH, target.x_middle_coord, now, controlGains);
+    }
+
+    c::task_delay_until(&wakeTime, 10);
+  }
+}
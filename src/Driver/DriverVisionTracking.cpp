@@ -1,95 +1,310 @@
 #include "main.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
 
 #include "DriverVisionTracking.hpp"
+#include "DriverOdometry.hpp"
+#include "DriverTargetEstimate.hpp"
+#include "DriverControlLaws.hpp"
+#include "DriverPid.hpp"
+#include "DriverParams.hpp"
+#include "DriverObstacles.hpp"
+#include "DriverContact.hpp"
+#include "DriverPickup.hpp"
+#include "DriverUltrasonic.hpp"
+#include "DriverPolicy.hpp"
+#include "DriverArmP.hpp"
+#include "DriverBlackBox.hpp"
+#include "DriverDevices.hpp"
+#include "DriverFovLimit.hpp"
+#include "DriverArmMask.hpp"
 
 #define BALL_SIG 2 // Defines the vision signature that is trained for the ball
-#define BASE_P 0.6 // The Kp for X error / base power
-#define BASE_DISTANCE_WIDTH 40
+#define VISION_PORT 6
 
 float driverBaseAngle() //Function that outputs the power to be sent to the base for turning
 {
-  int x_error = calculateVision().x_middle_coord - VISION_FOV_WIDTH/2;
-  // Centers the vision, and any x deriviation is our error
-  // If the vision sensor is not centered with the arm, a trig formula needs to be here.
-  // It will then output absolute, or most likely relative angle error. P will have to be changed
-
-  float finalBasePower;
-  if(calculateVision().signature == 255)
+  c::vision_object_s_t target = calculateTarget();
+  float turn = visionTurnPower(target.signature != 255, target.x_middle_coord);
+  PolicyCommand policy;
+  if(driverPolicy(armAngle(), &policy))
   {
-    finalBasePower = 0;
+    turn = policy.turn; // The learnt approach, if there's one on the card
   }
-  else
+  turn *= visionConfidence(); // Hard at a solid lock, gently at one that's barely there, on top of the driver's own turn
+  if(target.signature == 255)
   {
-    finalBasePower = x_error * BASE_P; // For now a simple P based on X deriviation from the center of the vision
+    return turn;
   }
-  return finalBasePower; //Returns power to be sent to the base
-}
 
+  // However hard it's turning, not so hard the ball goes out the other side of the picture
+  DeviceSnapshot devices = deviceSnapshot();
+  const MotorReading* wheels = devices.motors;
+  if(wheels[MOTOR_BASE_LEFT].valid && wheels[MOTOR_BASE_RIGHT].valid)
+  {
+    float yawRate = fovYawRate(wheels[MOTOR_BASE_LEFT].rpm * BASE_WHEEL_DIAMETER * M_PI / 60, wheels[MOTOR_BASE_RIGHT].rpm * BASE_WHEEL_DIAMETER * M_PI / 60);
+    turn = fovTurnLimit(cameraModel, target.x_middle_coord, turn, yawRate);
+  }
+  return turn; //Returns power to be sent to the base
+}
 
 
+PidController forwardPid = {forwardPidGains(controlGains), BASE_DISTANCE_WIDTH};
+ContactEstimate ballContact; // How fast the ball is growing in the image, from the frames it was really seen in
 
-float driverBaseForward() //Function that outputs the power to be sent to the base for moving forward
+float driverBaseForward() //Function that outputs the power to be sent to the base for moving forward, called every 10ms while it's wanted
 {
-  int distance_error = calculateVision().width - BASE_DISTANCE_WIDTH;
+  PolicyCommand policy;
+  if(driverPolicy(armAngle(), &policy))
+  {
+    return -policy.forward * visionConfidence();
+  }
+  c::vision_object_s_t target = calculateTarget();
+  if(target.signature == 255)
+  {
+    pidReset(forwardPid);
+    return 0;
+  }
+  float width = target.width;
+  if(ballDepthValid() && ballDepth() > BALL_DIAMETER)
+  {
+    width = BALL_DIAMETER * cameraModel.focalLength / ballDepth(); // The fused range, turned back into the width it should be so the gains stay the same
+  }
+  // The confidence goes in as the PID's limits, like the brake, so the anti-windup knows about it and the I
+  // doesn't wind up while it's held back
+  float confidence = visionConfidence();
+  // Eases off closing in as the time to contact runs out
+  forwardPid.gains.outputMax = contactBrake(ballContact, millis(), width, BASE_DISTANCE_WIDTH, 127 * confidence, controlGains);
+  forwardPid.gains.outputMin = -127 * confidence;
+  return -pidStep(forwardPid, width, 0.01); //Returns power to be sent to the base, which is subtracted, so closing in is negative
+}
 
+void driverBaseForwardReset() // For when the assist is let go, so it starts fresh next time
+{
+  pidReset(forwardPid);
+}
 
-float finalBasePower;
-  if(calculateVision().signature == 255)
+bool controlGainsLoad() // From /usd/params.txt, which comes out of the simulator's tuner. Keeps the defines otherwise
+{
+  FILE* file = fopen("/usd/" PARAMS_FILE_NAME, "r");
+  if(file == NULL)
   {
-    finalBasePower = 0;
+    return false;
   }
-  else
+  char text[512];
+  size_t length = fread(text, 1, sizeof(text) - 1, file);
+  fclose(file);
+  text[length] = 0;
+
+  bool loaded = paramsParse(controlGains, text) > 0;
+  forwardPid.gains = forwardPidGains(controlGains);
+  return loaded;
+}
+
+
+PickupPlan ballPickup; // When to send the arm down for the ball, and how far
+
+bool driverArmPickup(float armAngle, float* grabAngle) // True once the arm should be heading for grabAngle (radians up from the stop)
+{
+  c::vision_object_s_t target = calculateTarget();
+  if(target.signature == 255)
   {
-    finalBasePower = distance_error * BASE_P * 5; // For now a simple P based on X deriviation from the center of the vision
+    pickupReset(ballPickup);
+    return false;
   }
-  return finalBasePower; //Returns power to be sent to the base
+  bool moving = pickupUpdate(ballPickup, cameraModel, ballContact, millis(), target.width, target.y_middle_coord, armAngle,
+    controlGains.armP);
+  *grabAngle = ballPickup.grabAngle;
+  return moving;
 }
 
+bool driverBaseArrived() // The ball's in reach of the claw
+{
+  c::vision_object_s_t target = calculateTarget();
+  return target.signature != 255 && pickupArrived(target.width);
+}
 
-
-int driverArmAngle()
+void driverArmPickupReset() // For when the assist is let go
 {
-  int y_error;
+  pickupReset(ballPickup);
+}
+
+
+MlpModel ballPolicy; // The learnt approach. No layers unless driverPolicyLoad found one
 
-  if(calculateVision().signature == 255)
+bool driverPolicyLoad() // From /usd/policy.bin, which comes out of the simulator's policy scenario
+{
+  FILE* file = fopen("/usd/" POLICY_FILE_NAME, "rb");
+  if(file == NULL)
   {
-    y_error = 0;
+    return false;
   }
-  else
+  static uint8_t bytes[sizeof(MlpModel)]; // More than any file that would fit in the model
+  size_t size = fread(bytes, 1, sizeof(bytes), file);
+  fclose(file);
+  return mlpLoad(ballPolicy, bytes, size);
+}
+
+bool driverPolicy(float armAngle, PolicyCommand* command) // What the learnt approach would do now, false if there isn't one
+{
+  if(ballPolicy.layerCount == 0)
   {
-    y_error = (calculateVision().y_middle_coord * -1) + VISION_FOV_HEIGHT - VISION_FOV_HEIGHT/2;
+    return false;
   }
-  // Appearently a positive y is down, I prefer to work with positive y being up
-  // Centers the vision, and any x deriviation is our error
-  // If the vision sensor is not centered with the arm, a trig formula needs to be here.
-  // It will then output absolute angle error, to be P'd by the arm task
-
-  int finalArmAngle = y_error; // Eventaully this will be the calculation for an absolute position, but for now it's P
-
-  return finalArmAngle; // Returns final angle the arm needs to be at (currently y error)
+  c::vision_object_s_t target = calculateTarget();
+  float features[POLICY_INPUTS];
+  policyFeatures(cameraModel, target.signature != 255, target.x_middle_coord, target.y_middle_coord, target.width,
+    contactTimeTo(ballContact, target.width, BASE_DISTANCE_WIDTH), armAngle, features);
+  *command = policyRun(ballPolicy, features);
+  return true;
 }
 
 //
 c::vision_object_s_t visionScannerData;
-bool updateVision;
+uint32_t visionScannerTime; // millis() when the current visionScannerData frame was first seen
+TargetEstimate ballEstimate; // The ball on the field, so we can still follow it when the sensor loses it
+OpponentTrack opponentTracks[OPPONENT_TRACKS]; // The other alliance's robots, from OPPONENT_SIG
+ArmMask armMask; // Where our own claw is in the image, by arm angle
 
 c::vision_object_s_t calculateVision() //Function to read vision sensor data
 {
-  updateVision = true;
   return visionScannerData;
 }
 
+c::vision_object_s_t calculateTarget() // The ball as seen, or where it should be if the sensor has lost it
+{
+  c::vision_object_s_t target = visionScannerData;
+  if(target.signature == 255)
+  {
+    targetEstimatePredict(ballEstimate, odometryPose(), millis(), &target, controlGains); // Leaves target alone if there is no estimate
+  }
+  return target;
+}
+
+float visionConfidence() // 0 to 1, how much the ball being tracked can be trusted. The assists scale their power by it
+{
+  return targetConfidence(ballEstimate, millis());
+}
+
+uint32_t visionFrameTime() // millis() when the frame in visionScannerData was first seen. A new value means a new frame
+{
+  return visionScannerTime;
+}
+
+const OpponentTrack* visionOpponents()
+{
+  return opponentTracks;
+}
+
+
+#define VISION_FRAME_PERIOD 20 // The sensor produces a new frame every 20ms (50Hz)
+#define VISION_STALE_RETRY 2 // How long to wait before reading again after catching an old frame
+#define VISION_PHASE_EARLY 0.1 // How much earlier (ms) to wake after each fresh frame
+#define VISION_PHASE_LATE 1.0 // How much later (ms) to wake when the retry found the frame we'd woken too early for
 
 void monitorVisionTask(void*)
 {
+  pros::Vision mainVision(VISION_PORT); // Only read here
+
+  c::vision_object_s_t reading;
+  c::vision_object_s_t balls[ARM_MASK_OBJECTS];
+  int32_t objectCount;
+  int32_t lastObjectCount = -1;
+
+  uint32_t wakeTime = millis();
+  uint32_t frameGrid = wakeTime; // Start of the current sensor frame period as we see it
+  float framePhase = 0; // Where in the period (ms after frameGrid) we want to wake up
+  bool retried = false;
+  bool locked = false; // The last read was a new frame, so we're waking just after them
+
+  // Phase-locks the reads to the sensor. A fresh frame means we woke after it landed, so the next wake
+  // gets pulled a little earlier. Sooner or later that wakes us just before a frame, and the read comes back
+  // the same as the last one. That breaks the lock and we read once more shortly after: if that one's new,
+  // the frame landed in between, so we push the phase later and are locked again. If it's still the same,
+  // the scene just isn't moving, so the phase stays put and there are no more retries until something changes.
+  // That sits the wake-up just after each frame with one read per frame (and an extra one every ten or so
+  // frames while it creeps), and the data is never more than a couple of ms old.
   while(true)
   {
-    pros::Vision mainVision(6);
-    if(updateVision)
+    errno = 0;
+    int32_t ballCount = mainVision.read_by_sig(0, BALL_SIG, ARM_MASK_OBJECTS, balls); // The biggest few, in the one read
+    objectCount = mainVision.get_object_count();
+    devicePortRead(VISION_PORT, 2, errno == EACCES);
+
+    // The biggest that isn't the ball in our own claw
+    if(!armMaskCurrent(armMask, cameraModel))
+    {
+      armMaskBuild(armMask, cameraModel);
+    }
+    int ball = armMaskPick(armMask, armAngle(), balls, ballCount == PROS_ERR ? 0 : ballCount);
+    if(ball >= 0)
+    {
+      reading = balls[ball];
+    }
+    else
+    {
+      memset(&reading, 0, sizeof(reading));
+      reading.signature = VISION_OBJECT_ERR_SIG;
+    }
+
+    bool frameChanged = objectCount != lastObjectCount || memcmp(&reading, &visionScannerData, sizeof(reading)) != 0;
+    bool frameKnown = reading.signature != 255 && objectCount != PROS_ERR;
+    // With nothing in view every frame looks the same, so we can't tell new from old. Just hold the phase.
+
+    if(frameChanged)
+    {
+      visionScannerData = reading;
+      visionScannerTime = millis();
+      lastObjectCount = objectCount;
+      targetEstimateUpdate(ballEstimate, odometryPose(), reading, visionScannerTime, controlGains);
+      blackBoxVision(reading, objectCount);
+      if(reading.signature != 255)
+      {
+        contactUpdate(ballContact, reading.width, reading.y_middle_coord, visionScannerTime);
+      }
+      framePhase += retried ? VISION_PHASE_LATE : -VISION_PHASE_EARLY;
+      locked = true;
+    }
+    if(frameChanged || !frameKnown) // Once per frame. With no ball we can't tell frames apart, but we're only reading once a period then anyway
+    {
+      c::vision_object_s_t opponents[OPPONENT_TRACKS]; // The biggest two, for the two robots on the other alliance
+      errno = 0;
+      for(int i = 0; i < OPPONENT_TRACKS; i++)
+      {
+        opponents[i] = mainVision.get_by_sig(i, OPPONENT_SIG);
+      }
+      devicePortRead(VISION_PORT, OPPONENT_TRACKS, errno == EACCES);
+      opponentUpdate(opponentTracks, odometryPose(), opponents, OPPONENT_TRACKS, millis());
+    }
+    else if(frameKnown && locked) // Only straight after the lock breaks, never on a still scene
+    {
+      locked = false;
+      retried = true;
+      c::task_delay_until(&wakeTime, VISION_STALE_RETRY);
+      continue;
+    }
+    retried = false;
+
+    // Keep the phase inside one period, moving the grid instead
+    if(framePhase < 0)
+    {
+      framePhase += VISION_FRAME_PERIOD;
+      frameGrid -= VISION_FRAME_PERIOD;
+    }
+    else if(framePhase >= VISION_FRAME_PERIOD)
+    {
+      framePhase -= VISION_FRAME_PERIOD;
+      frameGrid += VISION_FRAME_PERIOD;
+    }
+
+    frameGrid += VISION_FRAME_PERIOD;
+    uint32_t nextWake = frameGrid + (uint32_t)framePhase;
+    while((int32_t)(nextWake - wakeTime) <= 0) // A retry can run us past the next slot, so skip to the one after
     {
-      visionScannerData = mainVision.get_by_sig(0, BALL_SIG); // Returns info for largest object of the signature
-      updateVision = false;
+      frameGrid += VISION_FRAME_PERIOD;
+      nextWake += VISION_FRAME_PERIOD;
     }
-    delay(10);
+    c::task_delay_until(&wakeTime, nextWake - wakeTime);
   }
 }
@@ -3,6 +3,11 @@
 #include "DriverArmP.hpp"
 #include "DriverScreenDrawing.hpp"
 #include "DriverVisionTracking.hpp"
+#include "DriverOdometry.hpp"
+#include "DriverMotors.hpp"
+#include "DriverUltrasonic.hpp"
+#include "DriverCameraCalibration.hpp"
+#include "DriverDevices.hpp"
 
 
 
@@ -12,11 +17,19 @@ void opcontrol() {
 
 Task driverBaseTask(driverBaseControl, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "DriverBaseControl");
 Task driverArmPTask(armP, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "ArmP");
+Task driverArmPotTask(armPotTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "ArmPot");
 Task driverVisionDrawingTask(screenDrawTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "VisionDrawing");
 Task driverMonitorVisionTask(monitorVisionTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "VisionPolling");
+Task driverOdometryTask(odometryTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "Odometry");
+Task driverRangeTask(rangeTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "Range");
 
   while (true)
   {
+    if (deviceNewPress(E_CONTROLLER_DIGITAL_X)) // Camera calibration, see cameraCalibrationTask. Ignored while it's running
+    {
+      cameraCalibrationStart();
+    }
+
     delay(100);
 
 
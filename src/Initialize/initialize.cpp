@@ -1,12 +1,40 @@
 #include "main.hpp"
+#include "Driver/DriverArmEstimate.hpp"
+#include "Driver/DriverCameraCalibration.hpp"
+#include "Driver/DriverStorage.hpp"
+#include "Driver/DriverLvglMemory.hpp"
+#include "Driver/DriverMotors.hpp"
+#include "Driver/DriverBlackBox.hpp"
+#include "Driver/DriverDevices.hpp"
+#include "Driver/DriverVisionTracking.hpp"
+#include "Autonomous/autonomous.hpp"
 
 pros::Controller mainController(CONTROLLER_MASTER);
 void initialize()
 {
-    
+    // The arm has to be sitting on its bottom hard stop for this, that becomes 0 degrees
+    ADIAnalogIn armPot(ARM_POT_PORT);
+    armPot.calibrate();
+
+    cameraModelLoad(); // Whatever the last camera calibration found, if there was one
+    controlGainsLoad(); // Tuned gains from the simulator, if there's a params.txt on the card
+    driverPolicyLoad(); // And the learnt approach, if there's a policy.bin
+    autonomousLoad(); // What autonomous has learnt about its routine so far
+
+    Task driverBlackBoxTask(blackBoxTask, NULL, TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT, "BlackBox"); // Below anything that drives
+    Task driverMotorTask(motorTask, NULL, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "Motors"); // Started here so autonomous has it too
 }
 
 // the following functions don't work presently because comp. control
 // hasn't been fully implemented
-void disabled() {}
-void competition_initialize() {}
+void disabled()
+{
+    lvglMemoryLog();
+    motorEnergyLog();
+    deviceLog();
+    storageFlush(); // Nothing's moving, so the SD card can take its time. Also runs between autonomous and driver control
+}
+void competition_initialize()
+{
+    storageFlush();
+}
@@ -0,0 +1,399 @@
+#include "FastMath.hpp"
+#include <cmath>
+#include <cstring>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#define FAST_PI 3.14159265358979f
+#define FAST_HALF_PI 1.57079632679490f
+#define FAST_PI_HI 3.140625f // Pi split in two so x - k * pi stays exact for big k
+#define FAST_PI_LO 9.67653589793e-4f
+#define FAST_SIN_STEP_HI 0.09814453125f // 2 * pi / 64 split the same way
+#define FAST_SIN_STEP_LO 3.0239174681e-5f
+
+// atan(z) for 0 <= z <= 1, Abramowitz & Stegun 4.4.49 (|error| <= 1e-5)
+#define FAST_ATAN_A1 0.9998660f
+#define FAST_ATAN_A3 -0.3302995f
+#define FAST_ATAN_A5 0.1801410f
+#define FAST_ATAN_A7 -0.0851330f
+#define FAST_ATAN_A9 0.0208351f
+
+static const float fastSinTable[64] = // sin(2 * pi * i / 64)
+{
+  0.000000000f, 0.098017140f, 0.195090322f, 0.290284677f,
+  0.382683432f, 0.471396737f, 0.555570233f, 0.634393284f,
+  0.707106781f, 0.773010453f, 0.831469612f, 0.881921264f,
+  0.923879533f, 0.956940336f, 0.980785280f, 0.995184727f,
+  1.000000000f, 0.995184727f, 0.980785280f, 0.956940336f,
+  0.923879533f, 0.881921264f, 0.831469612f, 0.773010453f,
+  0.707106781f, 0.634393284f, 0.555570233f, 0.471396737f,
+  0.382683432f, 0.290284677f, 0.195090322f, 0.098017140f,
+  0.000000000f, -0.098017140f, -0.195090322f, -0.290284677f,
+  -0.382683432f, -0.471396737f, -0.555570233f, -0.634393284f,
+  -0.707106781f, -0.773010453f, -0.831469612f, -0.881921264f,
+  -0.923879533f, -0.956940336f, -0.980785280f, -0.995184727f,
+  -1.000000000f, -0.995184727f, -0.980785280f, -0.956940336f,
+  -0.923879533f, -0.881921264f, -0.831469612f, -0.773010453f,
+  -0.707106781f, -0.634393284f, -0.555570233f, -0.471396737f,
+  -0.382683432f, -0.290284677f, -0.195090322f, -0.098017140f,
+};
+
+static const int16_t fixedSinTable[65] = // 32767 * sin(pi / 2 * i / 64), one quarter wave
+{
+  0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+  6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+  12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+  18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+  23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+  27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+  30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+  32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+  32767,
+};
+
+
+static inline int32_t fastRound(float x)
+{
+  return (int32_t)(x + (x >= 0 ? 0.5f : -0.5f));
+}
+
+static inline void fastSinCos(float x, float* sine, float* cosine)
+// Looks up the nearest table entry, then rotates by the leftover angle d (|d| < 0.05) with short Taylor series
+{
+  int32_t index = fastRound(x * (64 / (2 * FAST_PI)));
+  float d = (x - index * FAST_SIN_STEP_HI) - index * FAST_SIN_STEP_LO;
+  float d2 = d * d;
+  float sinD = d - d * d2 * (1 / 6.0f);
+  float cosD = 1 - d2 * 0.5f + d2 * d2 * (1 / 24.0f);
+
+  float tableSin = fastSinTable[index & 63];
+  float tableCos = fastSinTable[(index + 16) & 63];
+  *sine = tableSin * cosD + tableCos * sinD;
+  *cosine = tableCos * cosD - tableSin * sinD;
+}
+
+float fastSin(float x)
+{
+  float sine, cosine;
+  fastSinCos(x, &sine, &cosine);
+  return sine;
+}
+
+float fastCos(float x)
+{
+  float sine, cosine;
+  fastSinCos(x, &sine, &cosine);
+  return cosine;
+}
+
+
+float fastAtan2(float y, float x)
+{
+  float absX = fabsf(x);
+  float absY = fabsf(y);
+  if(absX == 0 && absY == 0)
+  {
+    return 0;
+  }
+
+  // Fold everything into the first octant so the polynomial only has to cover 0 to 1
+  bool steep = absY > absX;
+  float z = steep ? absX / absY : absY / absX;
+  float z2 = z * z;
+  float angle = z * (FAST_ATAN_A1 + z2 * (FAST_ATAN_A3 + z2 * (FAST_ATAN_A5 + z2 * (FAST_ATAN_A7 + z2 * FAST_ATAN_A9))));
+
+  if(steep)
+  {
+    angle = FAST_HALF_PI - angle;
+  }
+  if(x < 0)
+  {
+    angle = FAST_PI - angle;
+  }
+  return y < 0 ? -angle : angle;
+}
+
+
+int16_t fixedSin(uint16_t angle)
+{
+  uint16_t quarter = angle & 0x3FFF;
+  if(angle & 0x4000) // Second and fourth quarters run the table backwards
+  {
+    quarter = 0x4000 - quarter;
+  }
+
+  int32_t index = quarter >> 8;
+  int32_t fraction = quarter & 0xFF;
+  int32_t sine = fixedSinTable[index];
+  if(index < 64)
+  {
+    sine += ((fixedSinTable[index + 1] - sine) * fraction + 128) >> 8;
+  }
+  return (angle & 0x8000) ? -sine : sine;
+}
+
+int16_t fixedCos(uint16_t angle)
+{
+  return fixedSin(angle + 0x4000);
+}
+
+
+int16_t fixedAtan2(int32_t y, int32_t x)
+{
+  if(x == 0 && y == 0)
+  {
+    return 0;
+  }
+
+  uint32_t absX = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+  uint32_t absY = y < 0 ? 0u - (uint32_t)y : (uint32_t)y;
+  bool steep = absY > absX;
+  int32_t z = steep ? ((uint64_t)absX << 15) / absY : ((uint64_t)absY << 15) / absX; // Q15, 0 to 1
+
+  // Same polynomial as fastAtan2 with Q15 coefficients
+  int32_t z2 = (z * z) >> 15;
+  int32_t series = 683;
+  series = -2790 + ((series * z2) >> 15);
+  series = 5903 + ((series * z2) >> 15);
+  series = -10823 + ((series * z2) >> 15);
+  series = 32764 + ((series * z2) >> 15);
+  int32_t radians = (series * z) >> 15; // Q15
+  int32_t angle = (radians * 20861) >> 16; // 20861 = 65536 / pi, turns radians into binary angle counts
+
+  if(steep)
+  {
+    angle = 0x4000 - angle;
+  }
+  if(x < 0)
+  {
+    angle = 0x8000 - angle;
+  }
+  return (int16_t)(uint16_t)(y < 0 ? -angle : angle); // +pi wraps to -pi, which is the same angle
+}
+
+
+uint16_t fixedSqrt(uint32_t x) // One result bit per step, so never more than 16 steps
+{
+  uint32_t result = 0;
+  uint32_t bit = 1u << 30;
+  while(bit > x)
+  {
+    bit >>= 2;
+  }
+
+  while(bit != 0)
+  {
+    if(x >= result + bit)
+    {
+      x -= result + bit;
+      result = (result >> 1) + bit;
+    }
+    else
+    {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return result;
+}
+
+
+#define FIXED_EXP_MAX 681391 // ln(32768) in Q16.16, anything bigger overflows
+#define FIXED_EXP_MIN -726817 // ln(1 / 65536) in Q16.16, anything smaller rounds to 0
+
+int32_t fixedExp(int32_t x)
+{
+  if(x >= FIXED_EXP_MAX)
+  {
+    return INT32_MAX;
+  }
+  if(x < FIXED_EXP_MIN)
+  {
+    return 0;
+  }
+
+  // e^x = 2^k * e^r with 0 <= r < ln(2)
+  int32_t k = ((int64_t)x * 94548) >> 32; // 94548 = 65536 / ln(2), floor of x / ln(2)
+  int64_t r = x - k * 45426; // 45426 = ln(2) in Q16.16
+
+  // Series in Q24 so the rounding at each step stays well under one Q16 count
+  int64_t series = 23302; // 1/720
+  series = 139810 + ((series * r) >> 16); // 1/120
+  series = 699051 + ((series * r) >> 16); // 1/24
+  series = 2796203 + ((series * r) >> 16); // 1/6
+  series = 8388608 + ((series * r) >> 16); // 1/2
+  series = 16777216 + ((series * r) >> 16);
+  series = 16777216 + ((series * r) >> 16);
+
+  int64_t result = k >= 8 ? series << (k - 8) : (series + ((int64_t)1 << (7 - k))) >> (8 - k); // Back to Q16, rounded
+  return result > INT32_MAX ? INT32_MAX : (int32_t)result;
+}
+
+
+#ifdef __ARM_NEON
+
+static inline int32x4_t fastRoundNeon(float32x4_t x)
+{
+  uint32x4_t negative = vcltq_f32(x, vdupq_n_f32(0));
+  return vcvtq_s32_f32(vaddq_f32(x, vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f))));
+}
+
+static inline float32x4_t fastSinNeon(float32x4_t x, bool cosine)
+// No table lookups in NEON, so this reduces to |r| <= pi/2 and uses an odd Taylor series out to r^11 instead.
+// sin(x) = (-1)^k sin(x - k * pi), and cos(x) = (-1)^(k + 1) sin(x - (k + 1/2) * pi)
+{
+  float32x4_t turns = vmulq_n_f32(x, 1 / FAST_PI);
+  if(cosine)
+  {
+    turns = vsubq_f32(turns, vdupq_n_f32(0.5f));
+  }
+  int32x4_t k = fastRoundNeon(turns);
+  float32x4_t kFloat = vcvtq_f32_s32(k);
+
+  float32x4_t r = vmlsq_f32(x, kFloat, vdupq_n_f32(FAST_PI_HI));
+  r = vmlsq_f32(r, kFloat, vdupq_n_f32(FAST_PI_LO));
+  if(cosine)
+  {
+    r = vsubq_f32(r, vdupq_n_f32(FAST_HALF_PI));
+    k = vaddq_s32(k, vdupq_n_s32(1));
+  }
+
+  float32x4_t r2 = vmulq_f32(r, r);
+  float32x4_t series = vdupq_n_f32(-1 / 39916800.0f);
+  series = vmlaq_f32(vdupq_n_f32(1 / 362880.0f), series, r2);
+  series = vmlaq_f32(vdupq_n_f32(-1 / 5040.0f), series, r2);
+  series = vmlaq_f32(vdupq_n_f32(1 / 120.0f), series, r2);
+  series = vmlaq_f32(vdupq_n_f32(-1 / 6.0f), series, r2);
+  series = vmlaq_f32(vdupq_n_f32(1), series, r2);
+  float32x4_t sine = vmulq_f32(series, r);
+
+  uint32x4_t sign = vshlq_n_u32(vreinterpretq_u32_s32(k), 31); // Odd k flips the sign bit
+  return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(sine), sign));
+}
+
+void fastSinBatch(const float* in, float* out, int count)
+{
+  int i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    vst1q_f32(out + i, fastSinNeon(vld1q_f32(in + i), false));
+  }
+  for(; i < count; i++)
+  {
+    out[i] = fastSin(in[i]);
+  }
+}
+
+void fastCosBatch(const float* in, float* out, int count)
+{
+  int i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    vst1q_f32(out + i, fastSinNeon(vld1q_f32(in + i), true));
+  }
+  for(; i < count; i++)
+  {
+    out[i] = fastCos(in[i]);
+  }
+}
+
+
+void fastAtan2Batch(const float* y, const float* x, float* out, int count)
+{
+  int i = 0;
+  for(; i + 4 <= count; i += 4)
+  {
+    float32x4_t yLane = vld1q_f32(y + i);
+    float32x4_t xLane = vld1q_f32(x + i);
+    float32x4_t zero = vdupq_n_f32(0);
+    float32x4_t absX = vabsq_f32(xLane);
+    float32x4_t absY = vabsq_f32(yLane);
+    float32x4_t smaller = vminq_f32(absX, absY);
+    float32x4_t bigger = vmaxq_f32(absX, absY);
+
+    // NEON has no divide, so z = smaller / bigger uses the reciprocal estimate and two Newton steps
+    float32x4_t inverse = vrecpeq_f32(bigger);
+    inverse = vmulq_f32(vrecpsq_f32(bigger, inverse), inverse);
+    inverse = vmulq_f32(vrecpsq_f32(bigger, inverse), inverse);
+    float32x4_t z = vmulq_f32(smaller, inverse);
+
+    float32x4_t z2 = vmulq_f32(z, z);
+    float32x4_t series = vdupq_n_f32(FAST_ATAN_A9);
+    series = vmlaq_f32(vdupq_n_f32(FAST_ATAN_A7), series, z2);
+    series = vmlaq_f32(vdupq_n_f32(FAST_ATAN_A5), series, z2);
+    series = vmlaq_f32(vdupq_n_f32(FAST_ATAN_A3), series, z2);
+    series = vmlaq_f32(vdupq_n_f32(FAST_ATAN_A1), series, z2);
+    float32x4_t angle = vmulq_f32(series, z);
+
+    angle = vbslq_f32(vcgtq_f32(absY, absX), vsubq_f32(vdupq_n_f32(FAST_HALF_PI), angle), angle);
+    angle = vbslq_f32(vcltq_f32(xLane, zero), vsubq_f32(vdupq_n_f32(FAST_PI), angle), angle);
+    angle = vbslq_f32(vcltq_f32(yLane, zero), vnegq_f32(angle), angle);
+    angle = vbslq_f32(vceqq_f32(bigger, zero), zero, angle); // Both 0 gives 0, like fastAtan2
+
+    vst1q_f32(out + i, angle);
+  }
+  for(; i < count; i++)
+  {
+    out[i] = fastAtan2(y[i], x[i]);
+  }
+}
+
+#else // No NEON. The same maths as above written one lane at a time with no branches or table lookups,
+      // so the compiler can vectorise the loops for whatever SIMD the machine has (this is what the simulator runs)
+
+static inline float fastSinLane(float x, bool cosine)
+{
+  float turns = x * (1 / FAST_PI) - (cosine ? 0.5f : 0);
+  int32_t k = fastRound(turns);
+  float r = (x - k * FAST_PI_HI) - k * FAST_PI_LO - (cosine ? FAST_HALF_PI : 0);
+  k += cosine;
+
+  float r2 = r * r;
+  float series = 1 + r2 * (-1 / 6.0f + r2 * (1 / 120.0f + r2 * (-1 / 5040.0f + r2 * (1 / 362880.0f + r2 * (-1 / 39916800.0f)))));
+  float sine = series * r;
+
+  uint32_t bits;
+  memcpy(&bits, &sine, sizeof(bits));
+  bits ^= (uint32_t)k << 31; // Odd k flips the sign bit
+  memcpy(&sine, &bits, sizeof(sine));
+  return sine;
+}
+
+void fastSinBatch(const float* in, float* out, int count)
+{
+  for(int i = 0; i < count; i++)
+  {
+    out[i] = fastSinLane(in[i], false);
+  }
+}
+
+void fastCosBatch(const float* in, float* out, int count)
+{
+  for(int i = 0; i < count; i++)
+  {
+    out[i] = fastSinLane(in[i], true);
+  }
+}
+
+
+void fastAtan2Batch(const float* y, const float* x, float* out, int count)
+{
+  for(int i = 0; i < count; i++)
+  {
+    float absX = fabsf(x[i]);
+    float absY = fabsf(y[i]);
+    float bigger = absX > absY ? absX : absY;
+    float smaller = absX > absY ? absY : absX;
+    float z = smaller / (bigger > 0 ? bigger : 1);
+
+    float z2 = z * z;
+    float angle = z * (FAST_ATAN_A1 + z2 * (FAST_ATAN_A3 + z2 * (FAST_ATAN_A5 + z2 * (FAST_ATAN_A7 + z2 * FAST_ATAN_A9))));
+    angle = absY > absX ? FAST_HALF_PI - angle : angle;
+    angle = x[i] < 0 ? FAST_PI - angle : angle;
+    out[i] = y[i] < 0 ? -angle : angle;
+  }
+}
+
+#endif // __ARM_NEON
@@ -0,0 +1,160 @@
+#include "PoolAllocator.hpp"
+#include <atomic>
+#include <cstring>
+
+// Blocks per class, sized for the brain screen plus DriverStorage's RAM files, about 184KB all together
+static constexpr uint16_t poolBlocks[POOL_CLASSES] = {512, 512, 384, 192, 64, 32, 16, 8, 12};
+
+static constexpr uint32_t poolTotal()
+{
+  uint32_t total = 0;
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    total += (uint32_t)poolBlocks[c] * (POOL_MIN_BLOCK << c);
+  }
+  return total;
+}
+
+alignas(8) static uint8_t poolArena[poolTotal()];
+static uint32_t classStart[POOL_CLASSES + 1]; // Offset into the arena of each class, and the end
+static std::atomic<uint32_t> freeHead[POOL_CLASSES]; // Tag in the top 16 bits against ABA, block index + 1 below, 0 is empty
+static std::atomic<uint32_t> inUse[POOL_CLASSES];
+static std::atomic<uint32_t> allocs[POOL_CLASSES];
+static std::atomic<uint32_t> spills[POOL_CLASSES];
+static uint32_t peak[POOL_CLASSES]; // Racy, but it's only a statistic
+
+void poolInit() // Threads every block onto its class's free list. Before anything allocates, not while it's in use
+{
+  uint32_t offset = 0;
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    classStart[c] = offset;
+    uint32_t size = POOL_MIN_BLOCK << c;
+    for(uint16_t i = 0; i < poolBlocks[c]; i++)
+    {
+      uint16_t next = i + 1 < poolBlocks[c] ? i + 2 : 0; // The index + 1 of the block after, in the block itself
+      memcpy(poolArena + offset + i * size, &next, sizeof(next));
+    }
+    freeHead[c].store(poolBlocks[c] ? 1 : 0);
+    inUse[c].store(0);
+    allocs[c].store(0);
+    spills[c].store(0);
+    peak[c] = 0;
+    offset += poolBlocks[c] * size;
+  }
+  classStart[POOL_CLASSES] = offset;
+}
+
+static inline int poolClassFor(uint32_t size) // Smallest class that fits
+{
+  if(size <= POOL_MIN_BLOCK)
+  {
+    return 0;
+  }
+  return 32 - __builtin_clz(size - 1) - 4; // log2 rounded up, less log2 of POOL_MIN_BLOCK
+}
+
+static void* poolPop(int c)
+{
+  uint32_t size = POOL_MIN_BLOCK << c;
+  uint32_t head = freeHead[c].load(std::memory_order_acquire);
+  while(head & 0xFFFF)
+  {
+    uint8_t* block = poolArena + classStart[c] + ((head & 0xFFFF) - 1) * size;
+    uint16_t next;
+    memcpy(&next, block, sizeof(next)); // Can be stale if someone else got in first, then the swap fails and we go again
+    uint32_t replacement = ((head + 0x10000) & 0xFFFF0000) | next;
+    if(freeHead[c].compare_exchange_weak(head, replacement, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+      return block;
+    }
+  }
+  return nullptr;
+}
+
+void* poolAlloc(uint32_t size) // NULL if it's too big or everything it would fit in is full
+{
+  if(size > POOL_MAX_BLOCK)
+  {
+    return nullptr;
+  }
+  for(int c = poolClassFor(size); c < POOL_CLASSES; c++)
+  {
+    void* block = poolPop(c);
+    if(block != nullptr)
+    {
+      uint32_t used = inUse[c].fetch_add(1, std::memory_order_relaxed) + 1;
+      allocs[c].fetch_add(1, std::memory_order_relaxed);
+      if(used > peak[c])
+      {
+        peak[c] = used;
+      }
+      return block;
+    }
+    spills[c].fetch_add(1, std::memory_order_relaxed);
+  }
+  return nullptr;
+}
+
+static inline int poolClassOf(const void* block) // -1 if it didn't come from the arena
+{
+  const uint8_t* pointer = (const uint8_t*)block;
+  if(pointer < poolArena || pointer >= poolArena + classStart[POOL_CLASSES])
+  {
+    return -1;
+  }
+  uint32_t offset = pointer - poolArena;
+  int c = 0;
+  while(offset >= classStart[c + 1])
+  {
+    c++;
+  }
+  return c;
+}
+
+bool poolFree(const void* block) // False if it isn't one of ours, so the caller can give it back to the heap
+{
+  int c = poolClassOf(block);
+  if(c < 0)
+  {
+    return false;
+  }
+  uint32_t size = POOL_MIN_BLOCK << c;
+  uint32_t offset = (const uint8_t*)block - poolArena - classStart[c];
+  uint8_t* pointer = poolArena + classStart[c] + offset / size * size;
+  uint16_t index = offset / size + 1;
+  uint32_t head = freeHead[c].load(std::memory_order_relaxed);
+  uint32_t replacement;
+  do
+  {
+    uint16_t next = head & 0xFFFF;
+    memcpy(pointer, &next, sizeof(next));
+    replacement = ((head + 0x10000) & 0xFFFF0000) | index;
+  } while(!freeHead[c].compare_exchange_weak(head, replacement, std::memory_order_release, std::memory_order_relaxed));
+  inUse[c].fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+uint32_t poolBlockSize(const void* block) // Bytes the block really has room for, 0 if it isn't one of ours
+{
+  int c = poolClassOf(block);
+  return c < 0 ? 0 : POOL_MIN_BLOCK << c;
+}
+
+void poolStats(PoolClassStats* stats) // POOL_CLASSES of them, smallest first
+{
+  for(int c = 0; c < POOL_CLASSES; c++)
+  {
+    stats[c].blockSize = POOL_MIN_BLOCK << c;
+    stats[c].blocks = poolBlocks[c];
+    stats[c].inUse = inUse[c].load(std::memory_order_relaxed);
+    stats[c].peak = peak[c];
+    stats[c].allocs = allocs[c].load(std::memory_order_relaxed);
+    stats[c].spills = spills[c].load(std::memory_order_relaxed);
+  }
+}
+
+uint32_t poolArenaSize()
+{
+  return sizeof(poolArena);
+}
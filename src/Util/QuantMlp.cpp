@@ -0,0 +1,167 @@
+#include "QuantMlp.hpp"
+#include <cstring>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+static inline int8_t mlpClamp(int32_t x)
+{
+  return x > 127 ? 127 : (x < -127 ? -127 : x);
+}
+
+static inline int32_t mlpDot(const int8_t* weights, const int8_t* input, int count)
+{
+  int32_t sum = 0;
+  int i = 0;
+#ifdef __ARM_NEON
+  int32x4_t lanes = vdupq_n_s32(0);
+  for(; i + 8 <= count; i += 8)
+  {
+    int16x8_t products = vmull_s8(vld1_s8(weights + i), vld1_s8(input + i)); // Can't overflow, 127 * 127 < 32767
+    lanes = vpadalq_s16(lanes, products);
+  }
+  int32x2_t pairs = vadd_s32(vget_low_s32(lanes), vget_high_s32(lanes));
+  sum = vget_lane_s32(vpadd_s32(pairs, pairs), 0);
+#endif
+  for(; i < count; i++)
+  {
+    sum += weights[i] * input[i];
+  }
+  return sum;
+}
+
+void mlpRun(const MlpModel& model, const float* input, float* output)
+{
+  alignas(8) int8_t activations[2][MLP_MAX_WIDTH];
+  float toInput = 1 / model.inputScale;
+  for(int i = 0; i < model.inputs; i++)
+  {
+    float scaled = input[i] * toInput;
+    activations[0][i] = mlpClamp((int32_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f)));
+  }
+
+  for(int l = 0; l < model.layerCount; l++)
+  {
+    const MlpLayer& layer = model.layers[l];
+    const int8_t* in = activations[l & 1];
+    int8_t* out = activations[(l + 1) & 1];
+    const int8_t* weights = model.weights + layer.weightOffset;
+    const int32_t* biases = model.biases + layer.biasOffset;
+    bool last = l == model.layerCount - 1;
+    for(int o = 0; o < layer.outputs; o++)
+    {
+      int32_t sum = mlpDot(weights + o * layer.inputs, in, layer.inputs) + biases[o];
+      if(last)
+      {
+        output[o] = sum * layer.outputScale;
+      }
+      else
+      {
+        int32_t scaled = (int32_t)(((int64_t)sum * layer.multiplier + (1 << (MLP_MULTIPLIER_SHIFT - 1))) >> MLP_MULTIPLIER_SHIFT);
+        out[o] = scaled > 0 ? mlpClamp(scaled) : 0; // ReLU
+      }
+    }
+  }
+}
+
+int mlpOutputs(const MlpModel& model)
+{
+  return model.layerCount ? model.layers[model.layerCount - 1].outputs : 0;
+}
+
+
+// Reading and writing the file, keeping track of how much is left so a short or broken file just fails
+struct MlpCursor
+{
+  uint8_t* write;
+  const uint8_t* read;
+  uint32_t left;
+};
+
+static bool mlpTake(MlpCursor& cursor, void* value, uint32_t size)
+{
+  if(cursor.left < size)
+  {
+    return false;
+  }
+  memcpy(value, cursor.read, size);
+  cursor.read += size;
+  cursor.left -= size;
+  return true;
+}
+
+static bool mlpPut(MlpCursor& cursor, const void* value, uint32_t size)
+{
+  if(cursor.left < size)
+  {
+    return false;
+  }
+  memcpy(cursor.write, value, size);
+  cursor.write += size;
+  cursor.left -= size;
+  return true;
+}
+
+bool mlpLoad(MlpModel& model, const uint8_t* data, uint32_t size) // Leaves the model with no layers if the file's no good
+{
+  model.layerCount = 0;
+  MlpCursor cursor = {nullptr, data, size};
+  uint32_t magic, version, layers, inputs;
+  if(!mlpTake(cursor, &magic, 4) || !mlpTake(cursor, &version, 4) || !mlpTake(cursor, &layers, 4) || !mlpTake(cursor, &inputs, 4)
+    || !mlpTake(cursor, &model.inputScale, 4))
+  {
+    return false;
+  }
+  if(magic != MLP_MAGIC || version != MLP_VERSION || layers == 0 || layers > MLP_MAX_LAYERS || inputs == 0 || inputs > MLP_MAX_WIDTH
+    || !(model.inputScale > 0))
+  {
+    return false;
+  }
+
+  uint32_t weightOffset = 0;
+  uint32_t expectedInputs = inputs;
+  for(uint32_t l = 0; l < layers; l++)
+  {
+    uint32_t layerInputs, layerOutputs;
+    MlpLayer& layer = model.layers[l];
+    if(!mlpTake(cursor, &layerInputs, 4) || !mlpTake(cursor, &layerOutputs, 4) || layerInputs != expectedInputs
+      || layerOutputs == 0 || layerOutputs > MLP_MAX_WIDTH || weightOffset + layerInputs * layerOutputs > MLP_MAX_WEIGHTS)
+    {
+      return false;
+    }
+    layer.inputs = layerInputs;
+    layer.outputs = layerOutputs;
+    layer.weightOffset = weightOffset;
+    layer.biasOffset = l * MLP_MAX_WIDTH;
+    bool last = l == layers - 1;
+    if(!(last ? mlpTake(cursor, &layer.outputScale, 4) : mlpTake(cursor, &layer.multiplier, 4))
+      || !mlpTake(cursor, model.weights + weightOffset, layerInputs * layerOutputs)
+      || !mlpTake(cursor, model.biases + layer.biasOffset, layerOutputs * 4))
+    {
+      return false;
+    }
+    weightOffset += layerInputs * layerOutputs;
+    expectedInputs = layerOutputs;
+  }
+  model.inputs = inputs;
+  model.layerCount = layers;
+  return true;
+}
+
+uint32_t mlpSave(const MlpModel& model, uint8_t* data, uint32_t capacity) // Bytes written, 0 if it didn't fit
+{
+  MlpCursor cursor = {data, nullptr, capacity};
+  uint32_t header[4] = {MLP_MAGIC, MLP_VERSION, (uint32_t)model.layerCount, (uint32_t)model.inputs};
+  bool fits = mlpPut(cursor, header, sizeof(header)) && mlpPut(cursor, &model.inputScale, 4);
+  for(int l = 0; fits && l < model.layerCount; l++)
+  {
+    const MlpLayer& layer = model.layers[l];
+    uint32_t shape[2] = {layer.inputs, layer.outputs};
+    bool last = l == model.layerCount - 1;
+    fits = mlpPut(cursor, shape, sizeof(shape)) && (last ? mlpPut(cursor, &layer.outputScale, 4) : mlpPut(cursor, &layer.multiplier, 4))
+      && mlpPut(cursor, model.weights + layer.weightOffset, layer.inputs * layer.outputs)
+      && mlpPut(cursor, model.biases + layer.biasOffset, layer.outputs * 4);
+  }
+  return fits ? capacity - cursor.left : 0;
+}